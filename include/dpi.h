@@ -35,6 +35,9 @@
 #include <stdint.h>
 #endif
 
+// size_t is used for memory allocation callbacks
+#include <stddef.h>
+
 // define __func__ for older versions of Microsoft Visual Studio
 #ifdef _MSC_VER
 #if _MSC_VER < 1900
@@ -77,6 +80,20 @@
 // define ping timeout (in milliseconds) used when getting connections
 #define DPI_DEFAULT_PING_TIMEOUT                5000
 
+// define the layout of the pool acquire time histogram; each power of two
+// (in microseconds) is divided into the given number of sub-buckets
+#define DPI_POOL_STATS_NUM_BUCKETS              128
+#define DPI_POOL_STATS_SUB_BUCKETS              4
+
+// define number of threads used to create the initial sessions of pools
+#define DPI_DEFAULT_POOL_WARMUP_THREADS         8
+
+// define number of LOB chunks transferred at a time by LOB readers and writers
+#define DPI_DEFAULT_LOB_STREAM_CHUNKS           16
+
+// define time (in seconds) after which idle BFILEs opened by ODPI-C are closed
+#define DPI_DEFAULT_BFILE_IDLE_TIMEOUT          60
+
 // define constants for dequeue wait (AQ)
 #define DPI_DEQ_WAIT_NO_WAIT                    0
 #define DPI_DEQ_WAIT_FOREVER                    ((uint32_t) -1)
@@ -336,6 +353,9 @@ typedef struct dpiSubscr dpiSubscr;
 typedef struct dpiDeqOptions dpiDeqOptions;
 typedef struct dpiEnqOptions dpiEnqOptions;
 typedef struct dpiMsgProps dpiMsgProps;
+typedef struct dpiExecutor dpiExecutor;
+typedef struct dpiLobReader dpiLobReader;
+typedef struct dpiLobWriter dpiLobWriter;
 
 
 //-----------------------------------------------------------------------------
@@ -383,6 +403,7 @@ typedef struct {
 //-----------------------------------------------------------------------------
 
 // forward declarations
+typedef struct dpiAllocator dpiAllocator;
 typedef struct dpiAppContext dpiAppContext;
 typedef struct dpiCommonCreateParams dpiCommonCreateParams;
 typedef struct dpiConnCreateParams dpiConnCreateParams;
@@ -390,9 +411,12 @@ typedef struct dpiContext dpiContext;
 typedef struct dpiData dpiData;
 typedef struct dpiEncodingInfo dpiEncodingInfo;
 typedef struct dpiErrorInfo dpiErrorInfo;
+typedef struct dpiExecutorRequest dpiExecutorRequest;
+typedef struct dpiMemoryStats dpiMemoryStats;
 typedef struct dpiObjectAttrInfo dpiObjectAttrInfo;
 typedef struct dpiObjectTypeInfo dpiObjectTypeInfo;
 typedef struct dpiPoolCreateParams dpiPoolCreateParams;
+typedef struct dpiPoolStats dpiPoolStats;
 typedef struct dpiQueryInfo dpiQueryInfo;
 typedef struct dpiStmtInfo dpiStmtInfo;
 typedef struct dpiSubscrCreateParams dpiSubscrCreateParams;
@@ -401,6 +425,20 @@ typedef struct dpiSubscrMessageQuery dpiSubscrMessageQuery;
 typedef struct dpiSubscrMessageRow dpiSubscrMessageRow;
 typedef struct dpiSubscrMessageTable dpiSubscrMessageTable;
 
+// callbacks used for managing memory (compatible with the OCI callbacks)
+typedef void *(*dpiAllocateCallback)(void *context, size_t size);
+typedef void *(*dpiReallocateCallback)(void *context, void *ptr,
+        size_t size);
+typedef void (*dpiFreeCallback)(void *context, void *ptr);
+
+// structure used for supplying a memory allocator
+struct dpiAllocator {
+    dpiAllocateCallback allocate;
+    dpiReallocateCallback reallocate;
+    dpiFreeCallback free;
+    void *context;
+};
+
 // structure used for application context
 struct dpiAppContext {
     const char *namespaceName;
@@ -421,6 +459,9 @@ struct dpiCommonCreateParams {
     uint32_t editionLength;
     const char *driverName;
     uint32_t driverNameLength;
+    uint32_t queryInfoCacheSize;
+    uint32_t objectTypeCacheSize;
+    const dpiAllocator *allocator;
 };
 
 // structure used for creating connections
@@ -442,6 +483,11 @@ struct dpiConnCreateParams {
     const char *outTag;
     uint32_t outTagLength;
     int outTagFound;
+    uint32_t clientStmtCacheSize;
+    uint32_t hugePageThreshold;
+    int prefaultHugePages;
+    uint32_t bfileIdleTimeout;
+    uint32_t tempLobCacheSize;
 };
 
 // structure used for transferring data to/from ODPI-C
@@ -485,6 +531,48 @@ struct dpiErrorInfo {
     int isRecoverable;
 };
 
+// callback for requests submitted to executors
+typedef void (*dpiExecutorCallback)(void *context, dpiStmt *stmt,
+        const dpiErrorInfo *errorInfo);
+
+// structure used for submitting requests to executors
+struct dpiExecutorRequest {
+    const char *sql;
+    uint32_t sqlLength;
+    dpiExecMode execMode;
+    uint32_t numBindValues;
+    dpiNativeTypeNum *bindNativeTypeNums;
+    dpiData *bindValues;
+    uint32_t fetchArraySize;
+    dpiExecutorCallback callback;
+    void *callbackContext;
+};
+
+// structure used for transferring memory statistics from ODPI-C
+struct dpiMemoryStats {
+    uint64_t numConns;
+    uint64_t numPools;
+    uint64_t numStmts;
+    uint64_t numVars;
+    uint64_t numLobs;
+    uint64_t numObjects;
+    uint64_t numObjectTypes;
+    uint64_t numObjectAttrs;
+    uint64_t numSubscrs;
+    uint64_t numDeqOptions;
+    uint64_t numEnqOptions;
+    uint64_t numMsgProps;
+    uint64_t numRowids;
+    uint64_t numExecutors;
+    uint64_t numLobReaders;
+    uint64_t numLobWriters;
+    uint64_t handleBytes;
+    uint64_t varBufferBytes;
+    uint64_t dynamicBytes;
+    uint64_t lobBufferBytes;
+    uint64_t errorBufferBytes;
+};
+
 // structure used for transferring object attribute information from ODPI-C
 struct dpiObjectAttrInfo {
     const char *name;
@@ -507,6 +595,11 @@ struct dpiObjectTypeInfo {
     uint16_t numAttributes;
 };
 
+// callback for preparing sessions acquired with a tag they do not have
+typedef int (*dpiPoolSessionFixupCallback)(void *context, dpiConn *conn,
+        const char *requestedTag, uint32_t requestedTagLength,
+        const char *actualTag, uint32_t actualTagLength);
+
 // structure used for creating pools
 struct dpiPoolCreateParams {
     uint32_t minSessions;
@@ -519,6 +612,28 @@ struct dpiPoolCreateParams {
     dpiPoolGetMode getMode;
     const char *outPoolName;
     uint32_t outPoolNameLength;
+    int managed;
+    uint32_t waitTimeout;
+    uint32_t maxWaiters;
+    uint32_t warmupThreads;
+    uint32_t warmupReadyPercent;
+    dpiPoolSessionFixupCallback sessionFixupCallback;
+    void *sessionFixupContext;
+};
+
+// structure used for transferring pool statistics from ODPI-C
+struct dpiPoolStats {
+    uint64_t numAcquires;
+    uint64_t acquireTime;
+    uint64_t numWaits;
+    uint64_t numWaitTimeouts;
+    uint64_t numSessionsCreated;
+    uint64_t sessionCreateTime;
+    uint64_t numPingDrops;
+    uint64_t numTagHits;
+    uint64_t numTagMisses;
+    uint64_t numSessionFixups;
+    uint64_t acquireTimeBuckets[DPI_POOL_STATS_NUM_BUCKETS];
 };
 
 // structure used for transferring query metadata from ODPI-C
@@ -624,6 +739,10 @@ int dpiContext_getClientVersion(const dpiContext *context, int *versionNum,
 // get error information
 void dpiContext_getError(const dpiContext *context, dpiErrorInfo *errorInfo);
 
+// return memory statistics for all handles created with the context
+int dpiContext_getMemoryStats(const dpiContext *context,
+        dpiMemoryStats *stats);
+
 // initialize context parameters to default values
 int dpiContext_initCommonCreateParams(const dpiContext *context,
         dpiCommonCreateParams *params);
@@ -669,6 +788,9 @@ int dpiConn_close(dpiConn *conn, dpiConnCloseMode mode, const char *tag,
 // commits the current active transaction
 int dpiConn_commit(dpiConn *conn);
 
+// commit the transaction without blocking; call again until complete
+int dpiConn_commitAsync(dpiConn *conn, int *isComplete);
+
 // create a connection and return a reference to it
 int dpiConn_create(const dpiContext *context, const char *userName,
         uint32_t userNameLength, const char *password, uint32_t passwordLength,
@@ -711,6 +833,9 @@ int dpiConn_getInternalName(dpiConn *conn, const char **value,
 // get logical transaction id associated with the connection
 int dpiConn_getLTXID(dpiConn *conn, const char **value, uint32_t *valueLength);
 
+// return memory statistics for the connection and the handles created from it
+int dpiConn_getMemoryStats(dpiConn *conn, dpiMemoryStats *stats);
+
 // create a new object type and return it for subsequent object creation
 int dpiConn_getObjectType(dpiConn *conn, const char *name, uint32_t nameLength,
         dpiObjectType **objType);
@@ -991,6 +1116,28 @@ int dpiEnqOptions_setTransformation(dpiEnqOptions *options, const char *value,
 int dpiEnqOptions_setVisibility(dpiEnqOptions *options, dpiVisibility value);
 
 
+//-----------------------------------------------------------------------------
+// Executor Methods (dpiExecutor)
+//-----------------------------------------------------------------------------
+
+// add a reference to the executor
+int dpiExecutor_addRef(dpiExecutor *executor);
+
+// wait for submitted requests to complete and stop the executor
+int dpiExecutor_close(dpiExecutor *executor);
+
+// create an executor which runs requests using connections from the pool
+int dpiExecutor_create(dpiPool *pool, uint32_t numWorkers, uint32_t queueSize,
+        dpiExecutor **executor);
+
+// release a reference to the executor
+int dpiExecutor_release(dpiExecutor *executor);
+
+// submit a request to the executor without waiting for it to complete
+int dpiExecutor_submit(dpiExecutor *executor,
+        const dpiExecutorRequest *request);
+
+
 //-----------------------------------------------------------------------------
 // LOB Methods (dpiLob)
 //-----------------------------------------------------------------------------
@@ -1030,6 +1177,14 @@ int dpiLob_getIsResourceOpen(dpiLob *lob, int *isOpen);
 // return the current size of the LOB
 int dpiLob_getSize(dpiLob *lob, uint64_t *size);
 
+// create a reader which streams the contents of the LOB
+int dpiLob_newReader(dpiLob *lob, uint64_t offset, uint32_t bufferSize,
+        dpiLobReader **reader);
+
+// create a writer which streams data to the LOB
+int dpiLob_newWriter(dpiLob *lob, uint64_t offset, uint32_t bufferSize,
+        dpiLobWriter **writer);
+
 // open the LOB's resources (used to improve performance of multiple
 // read/writes operations)
 int dpiLob_openResource(dpiLob *lob);
@@ -1038,6 +1193,10 @@ int dpiLob_openResource(dpiLob *lob);
 int dpiLob_readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
         char *value, uint64_t *valueLength);
 
+// read bytes from many LOBs at the specified offset in one round trip
+int dpiLob_readMany(dpiLob **lobs, uint32_t numLobs, uint64_t offset,
+        const uint64_t *amounts, char **values, uint64_t *valueLengths);
+
 // release a reference to the LOB
 int dpiLob_release(dpiLob *lob);
 
@@ -1056,6 +1215,49 @@ int dpiLob_trim(dpiLob *lob, uint64_t newSize);
 int dpiLob_writeBytes(dpiLob *lob, uint64_t offset, const char *value,
         uint64_t valueLength);
 
+// write bytes to many LOBs at the specified offset in one round trip
+int dpiLob_writeMany(dpiLob **lobs, uint32_t numLobs, uint64_t offset,
+        const char **values, const uint64_t *valueLengths);
+
+
+//-----------------------------------------------------------------------------
+// LOB Reader Methods (dpiLobReader)
+//-----------------------------------------------------------------------------
+
+// add a reference to the LOB reader
+int dpiLobReader_addRef(dpiLobReader *reader);
+
+// stop reading the LOB and release the resources held by the reader
+int dpiLobReader_close(dpiLobReader *reader);
+
+// read the next piece of the LOB
+int dpiLobReader_read(dpiLobReader *reader, const char **value,
+        uint32_t *valueLength);
+
+// release a reference to the LOB reader
+int dpiLobReader_release(dpiLobReader *reader);
+
+
+//-----------------------------------------------------------------------------
+// LOB Writer Methods (dpiLobWriter)
+//-----------------------------------------------------------------------------
+
+// add a reference to the LOB writer
+int dpiLobWriter_addRef(dpiLobWriter *writer);
+
+// stop writing to the LOB and release the resources held by the writer
+int dpiLobWriter_close(dpiLobWriter *writer);
+
+// write any buffered data to the LOB and complete the write
+int dpiLobWriter_finish(dpiLobWriter *writer);
+
+// release a reference to the LOB writer
+int dpiLobWriter_release(dpiLobWriter *writer);
+
+// write data to the LOB, buffering it as needed
+int dpiLobWriter_write(dpiLobWriter *writer, const char *value,
+        uint64_t valueLength);
+
 
 //-----------------------------------------------------------------------------
 // Message Properties Methods (dpiMsgProps)
@@ -1151,6 +1353,10 @@ int dpiObject_getElementExists(dpiObject *obj, int32_t index, int *exists);
 int dpiObject_getElementValue(dpiObject *obj, int32_t index,
         dpiNativeTypeNum nativeTypeNum, dpiData *value);
 
+// get the values of all of the elements in a collection
+int dpiObject_getElementValues(dpiObject *obj, dpiNativeTypeNum nativeTypeNum,
+        uint32_t maxElements, dpiData *data, uint32_t *numElements);
+
 // return the first index used in a collection
 int dpiObject_getFirstIndex(dpiObject *obj, int32_t *index);
 
@@ -1207,6 +1413,14 @@ int dpiObjectType_addRef(dpiObjectType *objType);
 // create an object of the specified type and return it
 int dpiObjectType_createObject(dpiObjectType *objType, dpiObject **obj);
 
+// return the attribute of the object type at the given index
+int dpiObjectType_getAttributeByIndex(dpiObjectType *objType, uint16_t index,
+        dpiObjectAttr **attr);
+
+// return the attribute of the object type with the given name
+int dpiObjectType_getAttributeByName(dpiObjectType *objType, const char *name,
+        uint32_t nameLength, dpiObjectAttr **attr);
+
 // return the attributes available on the object type
 int dpiObjectType_getAttributes(dpiObjectType *objType, uint16_t numAttributes,
         dpiObjectAttr **attributes);
@@ -1252,9 +1466,15 @@ int dpiPool_getGetMode(dpiPool *pool, dpiPoolGetMode *value);
 // get the pool's maximum lifetime session
 int dpiPool_getMaxLifetimeSession(dpiPool *pool, uint32_t *value);
 
+// return memory statistics for the environment used by the pool
+int dpiPool_getMemoryStats(dpiPool *pool, dpiMemoryStats *stats);
+
 // get the pool's open count
 int dpiPool_getOpenCount(dpiPool *pool, uint32_t *value);
 
+// return acquire time and session statistics for the pool
+int dpiPool_getStats(dpiPool *pool, dpiPoolStats *stats);
+
 // return the statement cache size
 int dpiPool_getStmtCacheSize(dpiPool *pool, uint32_t *cacheSize);
 
@@ -1313,6 +1533,10 @@ int dpiStmt_define(dpiStmt *stmt, uint32_t pos, dpiVar *var);
 int dpiStmt_execute(dpiStmt *stmt, dpiExecMode mode,
         uint32_t *numQueryColumns);
 
+// execute the statement without blocking; call again until complete
+int dpiStmt_executeAsync(dpiStmt *stmt, dpiExecMode mode,
+        uint32_t *numQueryColumns, int *isComplete);
+
 // execute the statement multiple times (queries not supported)
 int dpiStmt_executeMany(dpiStmt *stmt, dpiExecMode mode, uint32_t numIters);
 
@@ -1327,6 +1551,11 @@ int dpiStmt_fetch(dpiStmt *stmt, int *found, uint32_t *bufferRowIndex);
 int dpiStmt_fetchRows(dpiStmt *stmt, uint32_t maxRows,
         uint32_t *bufferRowIndex, uint32_t *numRowsFetched, int *moreRows);
 
+// fetch rows into buffers without blocking; call again until complete
+int dpiStmt_fetchRowsAsync(dpiStmt *stmt, uint32_t maxRows,
+        uint32_t *bufferRowIndex, uint32_t *numRowsFetched, int *moreRows,
+        int *isComplete);
+
 // get the number of batch errors that took place in the previous execution
 int dpiStmt_getBatchErrorCount(dpiStmt *stmt, uint32_t *count);
 
@@ -0,0 +1,169 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016, 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestAsync.c
+//   Tests executing, fetching and committing without blocking, including
+// closing a statement while its execution is still pending and closing or
+// releasing a pooled connection while its commit is still pending.
+//-----------------------------------------------------------------------------
+
+#include "Test.h"
+#define SQL_TEXT_1          "truncate table TestTempTable"
+#define SQL_TEXT_2          "insert into TestTempTable " \
+                            "select level, 'Async String ' || level " \
+                            "from dual connect by level <= 100"
+#define SQL_TEXT_3          "select IntCol, StringCol from TestTempTable"
+#define SQL_TEXT_4          "select count(*) " \
+                            "from all_objects a, all_objects b, " \
+                            "all_objects c"
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    uint32_t numQueryColumns, bufferRowIndex, numRowsFetched, numRows;
+    int isComplete, moreRows;
+    dpiConn *conn, *poolConn;
+    uint32_t numPolls;
+    uint64_t rowCount;
+    dpiStmt *stmt;
+    dpiPool *pool;
+
+    // connect to database
+    conn = GetConnection(0, NULL);
+    if (!conn)
+        return -1;
+
+    // truncate table
+    if (dpiConn_prepareStmt(conn, 0, SQL_TEXT_1, strlen(SQL_TEXT_1), NULL, 0,
+            &stmt) < 0)
+        return ShowError();
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return ShowError();
+    dpiStmt_release(stmt);
+
+    // populate table, polling until the execution is complete
+    if (dpiConn_prepareStmt(conn, 0, SQL_TEXT_2, strlen(SQL_TEXT_2), NULL, 0,
+            &stmt) < 0)
+        return ShowError();
+    numPolls = 0;
+    do {
+        if (dpiStmt_executeAsync(stmt, 0, &numQueryColumns, &isComplete) < 0)
+            return ShowError();
+        numPolls++;
+    } while (!isComplete);
+    if (dpiStmt_getRowCount(stmt, &rowCount) < 0)
+        return ShowError();
+    printf("Inserted %" PRIu64 " rows after %u polls\n", rowCount, numPolls);
+    dpiStmt_release(stmt);
+
+    // commit, polling until the commit is complete
+    numPolls = 0;
+    do {
+        if (dpiConn_commitAsync(conn, &isComplete) < 0)
+            return ShowError();
+        numPolls++;
+    } while (!isComplete);
+    printf("Committed after %u polls\n", numPolls);
+
+    // query the rows back, polling for each batch of rows
+    if (dpiConn_prepareStmt(conn, 0, SQL_TEXT_3, strlen(SQL_TEXT_3), NULL, 0,
+            &stmt) < 0)
+        return ShowError();
+    if (dpiStmt_setFetchArraySize(stmt, 25) < 0)
+        return ShowError();
+    do {
+        if (dpiStmt_executeAsync(stmt, 0, &numQueryColumns, &isComplete) < 0)
+            return ShowError();
+    } while (!isComplete);
+    numRows = 0;
+    numPolls = 0;
+    do {
+        if (dpiStmt_fetchRowsAsync(stmt, 25, &bufferRowIndex,
+                &numRowsFetched, &moreRows, &isComplete) < 0)
+            return ShowError();
+        numPolls++;
+        if (isComplete)
+            numRows += numRowsFetched;
+    } while (!isComplete || moreRows);
+    printf("Fetched %u rows after %u polls\n", numRows, numPolls);
+    dpiStmt_release(stmt);
+
+    // start a long running query and close the statement before it completes;
+    // the connection must remain usable afterwards
+    if (dpiConn_prepareStmt(conn, 0, SQL_TEXT_4, strlen(SQL_TEXT_4), NULL, 0,
+            &stmt) < 0)
+        return ShowError();
+    if (dpiStmt_executeAsync(stmt, 0, &numQueryColumns, &isComplete) < 0)
+        return ShowError();
+    printf("Long running query complete on first call: %d\n", isComplete);
+    dpiStmt_release(stmt);
+    if (dpiConn_ping(conn) < 0)
+        return ShowError();
+    printf("Connection usable after closing pending statement\n");
+
+    // start a commit on a pooled connection and close the connection before
+    // the commit completes; the session returned to the pool must be usable
+    if (dpiPool_create(gContext, CONN_USERNAME, strlen(CONN_USERNAME),
+            CONN_PASSWORD, strlen(CONN_PASSWORD), CONN_CONNECT_STRING,
+            strlen(CONN_CONNECT_STRING), NULL, NULL, &pool) < 0)
+        return ShowError();
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, NULL,
+            &poolConn) < 0)
+        return ShowError();
+    if (dpiConn_prepareStmt(poolConn, 0, SQL_TEXT_2, strlen(SQL_TEXT_2), NULL,
+            0, &stmt) < 0)
+        return ShowError();
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return ShowError();
+    dpiStmt_release(stmt);
+    if (dpiConn_commitAsync(poolConn, &isComplete) < 0)
+        return ShowError();
+    printf("Commit complete on first call: %d\n", isComplete);
+    if (dpiConn_close(poolConn, DPI_MODE_CONN_CLOSE_DEFAULT, NULL, 0) < 0)
+        return ShowError();
+    dpiConn_release(poolConn);
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, NULL,
+            &poolConn) < 0)
+        return ShowError();
+    if (dpiConn_ping(poolConn) < 0)
+        return ShowError();
+    printf("Session usable after closing with pending commit\n");
+
+    // do the same but release the last reference to the connection instead
+    // of closing it explicitly
+    if (dpiConn_prepareStmt(poolConn, 0, SQL_TEXT_2, strlen(SQL_TEXT_2), NULL,
+            0, &stmt) < 0)
+        return ShowError();
+    if (dpiStmt_execute(stmt, 0, &numQueryColumns) < 0)
+        return ShowError();
+    dpiStmt_release(stmt);
+    if (dpiConn_commitAsync(poolConn, &isComplete) < 0)
+        return ShowError();
+    dpiConn_release(poolConn);
+    if (dpiPool_acquireConnection(pool, NULL, 0, NULL, 0, NULL,
+            &poolConn) < 0)
+        return ShowError();
+    if (dpiConn_ping(poolConn) < 0)
+        return ShowError();
+    printf("Session usable after releasing with pending commit\n");
+    dpiConn_release(poolConn);
+    dpiPool_release(pool);
+
+    // clean up
+    dpiConn_release(conn);
+
+    printf("Done.\n");
+    return 0;
+}
+
@@ -0,0 +1,176 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016, 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// TestRefCountContention.c
+//   Measures the cost of adding and releasing references to handles from many
+// threads at the same time. Each thread works on its own statement so that
+// only the reference counting done by the library is shared. Run this sample
+// against a library built normally and one built with
+// DPI_DISABLE_ATOMIC_REF_COUNTS defined to compare the two strategies. The
+// number of threads (default 32) and the number of iterations per thread
+// (default 1000000) can be specified on the command line.
+//-----------------------------------------------------------------------------
+
+#include "Test.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sys/time.h>
+#endif
+
+#define SQL_TEXT                "select 1 from dual"
+#define DEFAULT_NUM_THREADS     32
+#define DEFAULT_NUM_ITERS       1000000
+
+typedef struct {
+    dpiStmt *stmt;
+    uint32_t numIters;
+    int status;
+} ThreadInfo;
+
+//-----------------------------------------------------------------------------
+// GetTimeMs()
+//   Return the current time in milliseconds.
+//-----------------------------------------------------------------------------
+static double GetTimeMs(void)
+{
+#ifdef _WIN32
+    return (double) GetTickCount();
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// ThreadProc()
+//   Add and release references to the thread's statement repeatedly.
+//-----------------------------------------------------------------------------
+#ifdef _WIN32
+static DWORD WINAPI ThreadProc(LPVOID arg)
+#else
+static void *ThreadProc(void *arg)
+#endif
+{
+    ThreadInfo *info = (ThreadInfo*) arg;
+    uint32_t i;
+
+    for (i = 0; i < info->numIters; i++) {
+        if (dpiStmt_addRef(info->stmt) < 0 ||
+                dpiStmt_release(info->stmt) < 0) {
+            info->status = -1;
+            break;
+        }
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// main()
+//-----------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    dpiCommonCreateParams commonParams;
+    uint32_t numThreads, numIters, i;
+    double startTime, elapsedTime;
+    ThreadInfo *infos;
+    dpiConn *conn;
+#ifdef _WIN32
+    HANDLE *threads;
+#else
+    pthread_t *threads;
+#endif
+
+    // determine the number of threads and iterations to use
+    numThreads = (argc > 1) ? (uint32_t) atoi(argv[1]) : DEFAULT_NUM_THREADS;
+    numIters = (argc > 2) ? (uint32_t) atoi(argv[2]) : DEFAULT_NUM_ITERS;
+    if (numThreads == 0 || numIters == 0) {
+        fprintf(stderr, "Usage: %s [numThreads] [numIters]\n", argv[0]);
+        return -1;
+    }
+
+    // connect to database in threaded mode
+    if (InitializeDPI() < 0)
+        return -1;
+    if (dpiContext_initCommonCreateParams(gContext, &commonParams) < 0)
+        return ShowError();
+    commonParams.createMode = DPI_MODE_CREATE_THREADED;
+    conn = GetConnection(0, &commonParams);
+    if (!conn)
+        return -1;
+
+    // prepare a statement for each thread
+    infos = calloc(numThreads, sizeof(ThreadInfo));
+#ifdef _WIN32
+    threads = calloc(numThreads, sizeof(HANDLE));
+#else
+    threads = calloc(numThreads, sizeof(pthread_t));
+#endif
+    if (!infos || !threads) {
+        fprintf(stderr, "ERROR: out of memory\n");
+        return -1;
+    }
+    for (i = 0; i < numThreads; i++) {
+        if (dpiConn_prepareStmt(conn, 0, SQL_TEXT, strlen(SQL_TEXT), NULL, 0,
+                &infos[i].stmt) < 0)
+            return ShowError();
+        infos[i].numIters = numIters;
+    }
+
+    // start the threads and wait for all of them to complete
+    startTime = GetTimeMs();
+    for (i = 0; i < numThreads; i++) {
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, ThreadProc, &infos[i], 0, NULL);
+        if (!threads[i]) {
+#else
+        if (pthread_create(&threads[i], NULL, ThreadProc, &infos[i]) != 0) {
+#endif
+            fprintf(stderr, "ERROR: unable to create thread %u\n", i);
+            return -1;
+        }
+    }
+    for (i = 0; i < numThreads; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+    elapsedTime = GetTimeMs() - startTime;
+
+    // report results
+    for (i = 0; i < numThreads; i++) {
+        if (infos[i].status < 0)
+            return ShowError();
+    }
+    printf("%u threads x %u iterations: %.0f ms (%.1f ns per iteration)\n",
+            numThreads, numIters, elapsedTime,
+            elapsedTime * 1000000.0 / ((double) numThreads * numIters));
+
+    // clean up
+    for (i = 0; i < numThreads; i++)
+        dpiStmt_release(infos[i].stmt);
+    free(infos);
+    free(threads);
+    dpiConn_release(conn);
+
+    printf("Done.\n");
+    return 0;
+}
+
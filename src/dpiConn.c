@@ -18,6 +18,10 @@
 #include <time.h>
 
 // forward declarations of internal functions only used in this file
+static void dpiConn__clearStmtCache(dpiConn *conn, dpiError *error);
+static void dpiConn__clearTempLobCache(dpiConn *conn, dpiError *error);
+static void dpiConn__detachCaches(dpiConn *conn, dpiPoolSession *session,
+        dpiError *error);
 static int dpiConn__getSession(dpiConn *conn, uint32_t mode,
         const char *connectString, uint32_t connectStringLength,
         dpiConnCreateParams *params, OCIAuthInfo *authInfo, dpiError *error);
@@ -30,6 +34,78 @@ static int dpiConn__setAttributesFromCreateParams(void *handle,
         const dpiConnCreateParams *params, dpiError *error);
 
 
+//-----------------------------------------------------------------------------
+// dpiConn__attachCaches() [INTERNAL]
+//   Attach the caches retained by a session of a pool managed by ODPI-C to the
+// connection that has just acquired it (see dpiConn__detachCaches()). The
+// variables retained by the statement cache are associated with the new
+// connection. A cache that was created with a different capacity than the
+// one requested for the connection is cleared so that it is recreated.
+//-----------------------------------------------------------------------------
+void dpiConn__attachCaches(dpiConn *conn, dpiPoolSession *session,
+        dpiError *error)
+{
+    dpiStmtCacheEntry *entry;
+    uint32_t i, j;
+
+    // attach the statement cache
+    conn->stmtCache = session->stmtCache;
+    conn->numStmtCacheEntries = session->numStmtCacheEntries;
+    for (i = 0; i < conn->numStmtCacheEntries; i++) {
+        entry = &conn->stmtCache[i];
+        for (j = 0; j < entry->numBindVars; j++)
+            dpiVar__setConnection(entry->bindVars[j].var, conn);
+        for (j = 0; j < entry->numQueryVars; j++) {
+            if (entry->queryVars[j])
+                dpiVar__setConnection(entry->queryVars[j], conn);
+        }
+    }
+    if (conn->stmtCache &&
+            session->stmtCacheCapacity != conn->stmtCacheCapacity)
+        dpiConn__clearStmtCache(conn, error);
+
+    // attach the temporary LOB cache
+    conn->tempLobCache = session->tempLobCache;
+    conn->numTempLobCacheEntries = session->numTempLobCacheEntries;
+    if (conn->tempLobCache &&
+            session->tempLobCacheCapacity != conn->tempLobCacheCapacity)
+        dpiConn__clearTempLobCache(conn, error);
+
+    // attach the object type cache
+    conn->objectTypeCache = session->objectTypeCache;
+
+    // the caches are now owned by the connection
+    session->stmtCache = NULL;
+    session->numStmtCacheEntries = 0;
+    session->tempLobCache = NULL;
+    session->numTempLobCacheEntries = 0;
+    session->objectTypeCache = NULL;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiConn__cancelAsync() [INTERNAL]
+//   Cancel the asynchronous operation pending on the connection, if any. This
+// is called when the connection, or the statement on which the operation was
+// started, is closed before the operation has completed; the operation is
+// interrupted and the connection returned to blocking mode so that it can be
+// used again or released safely.
+//-----------------------------------------------------------------------------
+void dpiConn__cancelAsync(dpiConn *conn, dpiError *error)
+{
+    int isComplete;
+
+    if (conn->asyncOp == DPI_ASYNC_OP_NONE)
+        return;
+    if (conn->handle) {
+        OCIBreak(conn->handle, error->handle);
+        conn->asyncBreak = 1;
+    }
+    dpiConn__finishAsync(conn, DPI_ASYNC_OP_NONE, NULL, OCI_SUCCESS,
+            &isComplete, error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn__checkConnected() [INTERNAL]
 //   Validate the connection handle and determine the error structure to use.
@@ -42,31 +118,121 @@ static int dpiConn__checkConnected(dpiConn *conn, const char *fnName,
         return DPI_FAILURE;
     if (!conn->handle)
         return dpiError__set(error, "check connected", DPI_ERR_NOT_CONNECTED);
+    if (conn->asyncOp != DPI_ASYNC_OP_NONE)
+        return dpiError__set(error, "check async operation",
+                DPI_ERR_ASYNC_OPERATION_PENDING);
     return DPI_SUCCESS;
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiConn__clearStmtCache() [INTERNAL]
+//   Release all of the statements retained in the connection's statement
+// cache. This must be done before the session is released or ended.
+//-----------------------------------------------------------------------------
+static void dpiConn__clearStmtCache(dpiConn *conn, dpiError *error)
+{
+    dpiStmtCacheEntry *entries;
+    uint32_t numEntries, i;
+
+    // detach the entries from the connection while the mutex is held
+    if (dpiEnv__acquireMutex(conn->env, error) < 0)
+        return;
+    entries = conn->stmtCache;
+    numEntries = conn->numStmtCacheEntries;
+    conn->stmtCache = NULL;
+    conn->numStmtCacheEntries = 0;
+    dpiEnv__releaseMutex(conn->env, error);
+
+    // release each of the entries
+    if (entries) {
+        for (i = 0; i < numEntries; i++)
+            dpiStmt__releaseCacheEntry(conn->env, &entries[i], error);
+        dpiUtils__freeMemory(conn->env, entries);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiConn__clearTempLobCache() [INTERNAL]
+//   Free all of the temporary LOBs retained in the connection's temporary LOB
+// cache. This must be done before the session is released or ended.
+//-----------------------------------------------------------------------------
+static void dpiConn__clearTempLobCache(dpiConn *conn, dpiError *error)
+{
+    dpiTempLobCacheEntry *entries;
+    uint32_t numEntries, i;
+
+    // detach the entries from the connection while the mutex is held
+    if (dpiEnv__acquireMutex(conn->env, error) < 0)
+        return;
+    entries = conn->tempLobCache;
+    numEntries = conn->numTempLobCacheEntries;
+    conn->tempLobCache = NULL;
+    conn->numTempLobCacheEntries = 0;
+    dpiEnv__releaseMutex(conn->env, error);
+
+    // free each of the temporary LOBs
+    if (entries) {
+        for (i = 0; i < numEntries; i++) {
+            OCILobFreeTemporary(conn->handle, error->handle,
+                    entries[i].locator);
+            OCIDescriptorFree(entries[i].locator, OCI_DTYPE_LOB);
+        }
+        dpiUtils__freeMemory(conn->env, entries);
+    }
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn__close() [INTERNAL]
 //   Internal method used for closing the connection. Any transaction is rolled
 // back and any handles allocated are freed. For connections acquired from a
 // pool and that aren't marked as needed to be dropped, the last time used is
-// updated. This is called from dpiConn_close() where errors are expected to be
-// propagated and from dpiConn__free() where errors are ignored.
+// updated. Sessions given a tag by the session fixup callback of the pool
+// retain it unless they are explicitly retagged. Any asynchronous operation
+// that is still pending is cancelled first so that the session is never
+// released in non-blocking mode. This is called from dpiConn_close() where
+// errors are expected to be propagated and from dpiConn__free() where errors
+// are ignored.
 //-----------------------------------------------------------------------------
 static int dpiConn__close(dpiConn *conn, dpiConnCloseMode mode,
         const char *tag, uint32_t tagLength, int propagateErrors,
         dpiError *error)
 {
+    int poolDestroyed, retainCaches;
+    dpiPoolSession session;
     uint32_t serverStatus;
     time_t *lastTimeUsed;
     sword status;
 
-    // rollback any outstanding transaction
-    status = OCITransRollback(conn->handle, error->handle, OCI_DEFAULT);
-    if (propagateErrors && dpiError__check(error, status, conn,
-            "rollback") < 0)
-        return DPI_FAILURE;
+    // cancel any asynchronous operation that is still pending
+    dpiConn__cancelAsync(conn, error);
+
+    // sessions of pools managed by ODPI-C retain the statement and temporary
+    // LOB caches when they are released back to the pool; otherwise they are
+    // cleared now since the session is about to be released or ended
+    poolDestroyed = (conn->pool && dpiPool__isDestroyed(conn->pool));
+    retainCaches = (conn->pool && conn->pool->managed && !poolDestroyed);
+    if (!retainCaches)
+        dpiConn__clearStmtCache(conn, error);
+
+    // close any files kept open for reading BFILEs
+    if (conn->openFiles)
+        dpiLob__closeFiles(conn, NULL, 0, 0, error);
+
+    // free any temporary LOBs retained for reuse
+    if (!retainCaches)
+        dpiConn__clearTempLobCache(conn, error);
+
+    // rollback any outstanding transaction; this is not possible if the
+    // session belongs to a pool managed by ODPI-C that was closed forcibly
+    if (!poolDestroyed) {
+        status = OCITransRollback(conn->handle, error->handle, OCI_DEFAULT);
+        if (propagateErrors && dpiError__check(error, status, conn,
+                "rollback") < 0)
+            return DPI_FAILURE;
+    }
 
     // handle standalone connections
     if (conn->standalone) {
@@ -91,6 +257,54 @@ static int dpiConn__close(dpiConn *conn, dpiConnCloseMode mode,
         // free service context handle
         OCIHandleFree(conn->handle, OCI_HTYPE_SVCCTX);
 
+    // handle connections acquired from pools managed by ODPI-C; the session
+    // is returned to the pool unless it needs to be dropped
+    } else if (conn->pool && conn->pool->managed) {
+
+        // check server status; if not connected, ensure session is dropped
+        if (poolDestroyed)
+            conn->dropSession = 1;
+        else {
+            status = OCIAttrGet(conn->serverHandle, OCI_HTYPE_SERVER,
+                    (void*) &serverStatus, 0, OCI_ATTR_SERVER_STATUS,
+                    error->handle);
+            if (status != OCI_SUCCESS || serverStatus != OCI_SERVER_NORMAL ||
+                    (mode & DPI_MODE_CONN_CLOSE_DROP))
+                conn->dropSession = 1;
+        }
+
+        // replace the tag of the session, if requested; if the new tag
+        // cannot be retained, the session is dropped
+        memset(&session, 0, sizeof(dpiPoolSession));
+        session.tag = conn->tag;
+        session.tagLength = conn->tagLength;
+        if (!conn->dropSession && (mode & DPI_MODE_CONN_CLOSE_RETAG)) {
+            session.tag = NULL;
+            session.tagLength = 0;
+            if (tagLength > 0) {
+                session.tag = dpiUtils__allocateMemory(conn->env, 1,
+                        tagLength, 0);
+                if (session.tag) {
+                    memcpy(session.tag, tag, tagLength);
+                    session.tagLength = tagLength;
+                } else conn->dropSession = 1;
+            }
+            if (conn->tag)
+                dpiUtils__freeMemory(conn->env, conn->tag);
+        }
+        conn->tag = NULL;
+        conn->tagLength = 0;
+
+        // release session along with the caches it retains; if the session
+        // is dropped, the pool frees the caches as well
+        session.handle = conn->handle;
+        if (retainCaches)
+            dpiConn__detachCaches(conn, &session, error);
+        if (dpiPool__releaseSession(conn->pool, &session, conn->dropSession,
+                error) < 0 && propagateErrors)
+            return DPI_FAILURE;
+        conn->sessionHandle = NULL;
+
     // handle pooled connections
     } else {
 
@@ -142,15 +356,26 @@ static int dpiConn__close(dpiConn *conn, dpiConnCloseMode mode,
         if (status != OCI_SUCCESS || serverStatus != OCI_SERVER_NORMAL)
             conn->dropSession = 1;
 
-        // release session
+        // release session; a session given a tag by the session fixup
+        // callback is retagged with it unless another tag is supplied
         if (conn->dropSession)
             mode |= OCI_SESSRLS_DROPSESS;
+        else if (conn->tag && !(mode & DPI_MODE_CONN_CLOSE_RETAG)) {
+            tag = conn->tag;
+            tagLength = conn->tagLength;
+            mode |= DPI_MODE_CONN_CLOSE_RETAG;
+        }
         status = OCISessionRelease(conn->handle, error->handle, (text*) tag,
                 tagLength, mode);
         if (propagateErrors && dpiError__check(error, status, conn,
                 "release session") < 0)
             return DPI_FAILURE;
         conn->sessionHandle = NULL;
+        if (conn->tag) {
+            dpiUtils__freeMemory(conn->env, conn->tag);
+            conn->tag = NULL;
+            conn->tagLength = 0;
+        }
 
     }
 
@@ -245,15 +470,126 @@ static int dpiConn__create(dpiConn *conn, const char *userName,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiConn__detachCaches() [INTERNAL]
+//   Detach the statement, temporary LOB and object type caches from a
+// connection acquired from a pool managed by ODPI-C and hand them to the
+// session that is being released back to the pool, so that the next
+// connection to acquire the session can continue to use them. The variables
+// retained by the statement cache are no longer associated with any
+// connection while the session is idle. The caches are freed by the pool when
+// the session is dropped.
+//-----------------------------------------------------------------------------
+static void dpiConn__detachCaches(dpiConn *conn, dpiPoolSession *session,
+        dpiError *error)
+{
+    dpiStmtCacheEntry *entry;
+    uint32_t i, j;
+
+    // detach the caches from the connection while the mutex is held
+    session->stmtCacheCapacity = conn->stmtCacheCapacity;
+    session->tempLobCacheCapacity = conn->tempLobCacheCapacity;
+    if (dpiEnv__acquireMutex(conn->env, error) < 0)
+        return;
+    session->stmtCache = conn->stmtCache;
+    session->numStmtCacheEntries = conn->numStmtCacheEntries;
+    session->tempLobCache = conn->tempLobCache;
+    session->numTempLobCacheEntries = conn->numTempLobCacheEntries;
+    conn->stmtCache = NULL;
+    conn->numStmtCacheEntries = 0;
+    conn->tempLobCache = NULL;
+    conn->numTempLobCacheEntries = 0;
+    dpiEnv__releaseMutex(conn->env, error);
+    session->objectTypeCache = conn->objectTypeCache;
+    conn->objectTypeCache = NULL;
+
+    // the variables retained by the statement cache no longer belong to the
+    // connection
+    for (i = 0; i < session->numStmtCacheEntries; i++) {
+        entry = &session->stmtCache[i];
+        for (j = 0; j < entry->numBindVars; j++)
+            dpiVar__setConnection(entry->bindVars[j].var, NULL);
+        for (j = 0; j < entry->numQueryVars; j++) {
+            if (entry->queryVars[j])
+                dpiVar__setConnection(entry->queryVars[j], NULL);
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiConn__finishAsync() [INTERNAL]
+//   Called after each call to OCI made in non-blocking mode on behalf of one
+// of the asynchronous functions. If the call is still executing, the
+// operation is recorded as pending on the connection so that the application
+// can continue it by calling the same function again; otherwise, the
+// connection is returned to blocking mode. If the operation was interrupted
+// with dpiConn_breakExecution(), the protocol is also reset as required by
+// OCI. A separate error handle is used for these calls so that the error
+// raised by the operation itself remains available to the caller; any
+// errors they raise are ignored.
+//-----------------------------------------------------------------------------
+void dpiConn__finishAsync(dpiConn *conn, dpiAsyncOpType op, dpiStmt *stmt,
+        sword status, int *isComplete, dpiError *error)
+{
+    OCIError *localErrorHandle = NULL, *errorHandle;
+
+    if (status == OCI_STILL_EXECUTING) {
+        conn->asyncOp = op;
+        conn->asyncStmt = stmt;
+        *isComplete = 0;
+        return;
+    }
+    conn->asyncOp = DPI_ASYNC_OP_NONE;
+    conn->asyncStmt = NULL;
+    *isComplete = 1;
+    if (!conn->asyncBreak && !conn->nonBlocking)
+        return;
+    if (OCIHandleAlloc(conn->env->handle, (dvoid**) &localErrorHandle,
+            OCI_HTYPE_ERROR, 0, NULL) != OCI_SUCCESS)
+        localErrorHandle = NULL;
+    errorHandle = (localErrorHandle) ? localErrorHandle : error->handle;
+    if (conn->asyncBreak) {
+        OCIReset(conn->serverHandle, errorHandle);
+        conn->asyncBreak = 0;
+    }
+    if (conn->nonBlocking) {
+        OCIAttrSet(conn->serverHandle, OCI_HTYPE_SERVER, NULL, 0,
+                OCI_ATTR_NONBLOCKING_MODE, errorHandle);
+        conn->nonBlocking = 0;
+    }
+    if (localErrorHandle)
+        OCIHandleFree(localErrorHandle, OCI_HTYPE_ERROR);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn__free() [INTERNAL]
 //   Free the memory and any resources associated with the connection.
 //-----------------------------------------------------------------------------
 void dpiConn__free(dpiConn *conn, dpiError *error)
 {
+    dpiGen__updateMemoryStats(conn, -1);
     if (conn->handle)
         dpiConn__close(conn, DPI_MODE_CONN_CLOSE_DEFAULT, NULL, 0, 0,
                 error);
+    if (conn->queryInfoCache) {
+        if (!conn->pool || conn->queryInfoCache != conn->pool->queryInfoCache)
+            dpiStmt__freeQueryInfoCache(conn->env, conn->queryInfoCache);
+        conn->queryInfoCache = NULL;
+    }
+    if (conn->objectTypeCache) {
+        dpiObjectType__freeCache(conn->env, conn->objectTypeCache, error);
+        conn->objectTypeCache = NULL;
+    }
+    if (conn->releaseString) {
+        dpiUtils__freeMemory(conn->env, (void*) conn->releaseString);
+        conn->releaseString = NULL;
+    }
+    if (conn->tag) {
+        dpiUtils__freeMemory(conn->env, conn->tag);
+        conn->tag = NULL;
+    }
     if (conn->pool) {
         dpiGen__setRefCount(conn->pool, error, -1);
         conn->pool = NULL;
@@ -263,11 +599,7 @@ void dpiConn__free(dpiConn *conn, dpiError *error)
         dpiEnv__free(conn->env, error);
         conn->env = NULL;
     }
-    if (conn->releaseString) {
-        free((void*) conn->releaseString);
-        conn->releaseString = NULL;
-    }
-    free(conn);
+    dpiGen__free(conn, error);
 }
 
 
@@ -497,6 +829,7 @@ static int dpiConn__getSession(dpiConn *conn, uint32_t mode,
         }
 
         // session is bad, need to release and drop it
+        dpiPool__updateStats(conn->pool, DPI_POOL_STAT_NUM_PING_DROPS, 1);
         OCISessionRelease(conn->handle, error->handle, NULL, 0,
                 OCI_SESSRLS_DROPSESS);
         conn->handle = NULL;
@@ -700,6 +1033,52 @@ int dpiConn__setAttributeText(dpiConn *conn, uint32_t attribute,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiConn__setNonBlocking() [INTERNAL]
+//   Place the server handle of the connection in non-blocking mode or return
+// it to blocking mode. OCI only provides a means of toggling the mode so the
+// current mode is tracked on the connection.
+//-----------------------------------------------------------------------------
+int dpiConn__setNonBlocking(dpiConn *conn, int nonBlocking, dpiError *error)
+{
+    sword status;
+
+    if (conn->nonBlocking == nonBlocking)
+        return DPI_SUCCESS;
+    if (!conn->serverHandle && dpiConn__getHandles(conn, error) < 0)
+        return DPI_FAILURE;
+    status = OCIAttrSet(conn->serverHandle, OCI_HTYPE_SERVER, NULL, 0,
+            OCI_ATTR_NONBLOCKING_MODE, error->handle);
+    if (dpiError__check(error, status, conn, "toggle non-blocking mode") < 0)
+        return DPI_FAILURE;
+    conn->nonBlocking = nonBlocking;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiConn__startAsync() [INTERNAL]
+//   Called at the start of each of the asynchronous functions. If no
+// operation is pending on the connection, a new one may be started. If the
+// same operation is pending, it is continued; any other operation is
+// rejected since OCI does not permit other calls on the connection until the
+// pending one has completed.
+//-----------------------------------------------------------------------------
+int dpiConn__startAsync(dpiConn *conn, dpiAsyncOpType op, dpiStmt *stmt,
+        int *isPending, dpiError *error)
+{
+    if (conn->asyncOp == DPI_ASYNC_OP_NONE) {
+        *isPending = 0;
+        return DPI_SUCCESS;
+    }
+    if (conn->asyncOp != op || conn->asyncStmt != stmt)
+        return dpiError__set(error, "check async operation",
+                DPI_ERR_ASYNC_OPERATION_PENDING);
+    *isPending = 1;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn_addRef() [PUBLIC]
 //   Add a reference to the connection.
@@ -790,11 +1169,17 @@ int dpiConn_breakExecution(dpiConn *conn)
     dpiError error;
     sword status;
 
-    if (dpiConn__checkConnected(conn, __func__, &error) < 0)
+    // an operation performed asynchronously may be interrupted as well, so
+    // the check for pending asynchronous operations is not performed here
+    if (dpiGen__startPublicFn(conn, DPI_HTYPE_CONN, __func__, &error) < 0)
         return DPI_FAILURE;
+    if (!conn->handle)
+        return dpiError__set(&error, "check connected", DPI_ERR_NOT_CONNECTED);
     status = OCIBreak(conn->handle, error.handle);
     if (dpiError__check(&error, status, conn, "break execution") < 0)
         return DPI_FAILURE;
+    if (conn->asyncOp != DPI_ASYNC_OP_NONE)
+        conn->asyncBreak = 1;
     return DPI_SUCCESS;
 }
 
@@ -823,7 +1208,9 @@ int dpiConn_changePassword(dpiConn *conn, const char *userName,
 
 //-----------------------------------------------------------------------------
 // dpiConn_close() [PUBLIC]
-//   Close the connection and ensure it can no longer be used.
+//   Close the connection and ensure it can no longer be used. An asynchronous
+// operation that is still pending is cancelled rather than reported as an
+// error.
 //-----------------------------------------------------------------------------
 int dpiConn_close(dpiConn *conn, dpiConnCloseMode mode, const char *tag,
         uint32_t tagLength)
@@ -831,8 +1218,10 @@ int dpiConn_close(dpiConn *conn, dpiConnCloseMode mode, const char *tag,
     int propagateErrors = !(mode & DPI_MODE_CONN_CLOSE_DROP);
     dpiError error;
 
-    if (dpiConn__checkConnected(conn, __func__, &error) < 0)
+    if (dpiGen__startPublicFn(conn, DPI_HTYPE_CONN, __func__, &error) < 0)
         return DPI_FAILURE;
+    if (!conn->handle)
+        return dpiError__set(&error, "check connected", DPI_ERR_NOT_CONNECTED);
     if (mode && !conn->pool)
         return dpiError__set(&error, "check in pool",
                 DPI_ERR_CONN_NOT_IN_POOL);
@@ -863,6 +1252,42 @@ int dpiConn_commit(dpiConn *conn)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiConn_commitAsync() [PUBLIC]
+//   Commit the current active transaction using the non-blocking mode of OCI.
+// If the commit has not completed when OCI returns control, the function
+// must be called again until it has.
+//-----------------------------------------------------------------------------
+int dpiConn_commitAsync(dpiConn *conn, int *isComplete)
+{
+    dpiError error;
+    sword status;
+    int isPending;
+
+    if (dpiGen__startPublicFn(conn, DPI_HTYPE_CONN, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (!conn->handle)
+        return dpiError__set(&error, "check connected", DPI_ERR_NOT_CONNECTED);
+    if (!isComplete)
+        return dpiError__set(&error, "check is complete pointer",
+                DPI_ERR_NULL_POINTER_PARAMETER, "isComplete");
+    if (dpiConn__startAsync(conn, DPI_ASYNC_OP_COMMIT, NULL, &isPending,
+            &error) < 0)
+        return DPI_FAILURE;
+    if (!isPending && dpiConn__setNonBlocking(conn, 1, &error) < 0)
+        return DPI_FAILURE;
+    status = OCITransCommit(conn->handle, error.handle, conn->commitMode);
+    dpiConn__finishAsync(conn, DPI_ASYNC_OP_COMMIT, NULL, status, isComplete,
+            &error);
+    if (!*isComplete)
+        return DPI_SUCCESS;
+    if (dpiError__check(&error, status, conn, "commit") < 0)
+        return DPI_FAILURE;
+    conn->commitMode = OCI_DEFAULT;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn_create() [PUBLIC]
 //   Create a standalone connection to the database using the parameters
@@ -878,6 +1303,7 @@ int dpiConn_create(const dpiContext *context, const char *userName,
     dpiConnCreateParams localCreateParams;
     dpiConn *tempConn;
     dpiError error;
+    dpiEnv *env;
     int status;
 
     // validate context
@@ -925,9 +1351,20 @@ int dpiConn_create(const dpiContext *context, const char *userName,
                 &error);
     }
 
-    // allocate connection
-    if (dpiGen__allocate(DPI_HTYPE_CONN, NULL, (void**) &tempConn, &error) < 0)
+    // allocate environment and connection
+    if (dpiEnv__allocate(commonParams->allocator, &env, &error) < 0)
         return DPI_FAILURE;
+    if (dpiGen__allocate(DPI_HTYPE_CONN, env, (void**) &tempConn,
+            &error) < 0) {
+        dpiEnv__free(env, &error);
+        return DPI_FAILURE;
+    }
+    dpiGen__setMemoryOwner(tempConn, tempConn->memoryCounters);
+    tempConn->stmtCacheCapacity = createParams->clientStmtCacheSize;
+    tempConn->hugePageThreshold = createParams->hugePageThreshold;
+    tempConn->prefaultHugePages = createParams->prefaultHugePages;
+    tempConn->bfileIdleTimeout = createParams->bfileIdleTimeout;
+    tempConn->tempLobCacheCapacity = createParams->tempLobCacheSize;
 
     // initialize environment
     if (dpiEnv__init(tempConn->env, context, commonParams, &error) < 0) {
@@ -935,6 +1372,24 @@ int dpiConn_create(const dpiContext *context, const char *userName,
         return DPI_FAILURE;
     }
 
+    // create the query information cache, if applicable
+    if (commonParams->queryInfoCacheSize > 0 &&
+            dpiStmt__createQueryInfoCache(tempConn->env,
+                    commonParams->queryInfoCacheSize,
+                    &tempConn->queryInfoCache, &error) < 0) {
+        dpiConn__free(tempConn, &error);
+        return DPI_FAILURE;
+    }
+
+    // create the object type cache, if applicable
+    if (commonParams->objectTypeCacheSize > 0 &&
+            dpiObjectType__createCache(tempConn->env,
+                    commonParams->objectTypeCacheSize,
+                    &tempConn->objectTypeCache, &error) < 0) {
+        dpiConn__free(tempConn, &error);
+        return DPI_FAILURE;
+    }
+
     // if a handle is specified, use it
     if (createParams->externalHandle) {
         tempConn->handle = createParams->externalHandle;
@@ -1146,6 +1601,24 @@ int dpiConn_getLTXID(dpiConn *conn, const char **value, uint32_t *valueLength)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiConn_getMemoryStats() [PUBLIC]
+//   Return memory statistics for the connection and the handles created from
+// it. These counters are maintained in addition to those of the environment,
+// so for connections acquired from a pool they are also included in the
+// statistics of the pool.
+//-----------------------------------------------------------------------------
+int dpiConn_getMemoryStats(dpiConn *conn, dpiMemoryStats *stats)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(conn, DPI_HTYPE_CONN, __func__, &error) < 0)
+        return DPI_FAILURE;
+    dpiUtils__getMemoryStats(conn->memoryCounters, stats);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiConn_getObjectType() [PUBLIC]
 //   Look up an object type given its name and return it.
@@ -1170,6 +1643,15 @@ int dpiConn_getObjectType(dpiConn *conn, const char *name, uint32_t nameLength,
         return dpiError__set(&error, "check object type handle",
                 DPI_ERR_NULL_POINTER_PARAMETER, "objType");
 
+    // use the object type cache, if one is available and contains the type
+    if (conn->objectTypeCache) {
+        if (dpiObjectType__lookup(conn, name, nameLength, objType,
+                &error) < 0)
+            return DPI_FAILURE;
+        if (*objType)
+            return DPI_SUCCESS;
+    }
+
     // allocate describe handle
     status = OCIHandleAlloc(conn->env->handle, (dvoid**) &describeHandle,
             OCI_HTYPE_DESCRIBE, 0, 0);
@@ -1212,6 +1694,10 @@ int dpiConn_getObjectType(dpiConn *conn, const char *name, uint32_t nameLength,
     status = dpiObjectType__allocate(conn, param, OCI_ATTR_NAME, objType,
             &error);
     OCIHandleFree(describeHandle, OCI_HTYPE_DESCRIBE);
+
+    // retain a copy of the object type in the cache for subsequent lookups
+    if (status == DPI_SUCCESS && conn->objectTypeCache)
+        dpiObjectType__cache(conn, name, nameLength, *objType, &error);
     return status;
 }
 
@@ -1238,7 +1724,8 @@ int dpiConn_getServerVersion(dpiConn *conn, const char **releaseString,
         if (dpiError__check(&error, status, conn, "get server version") < 0)
             return DPI_FAILURE;
         conn->releaseStringLength = (uint32_t) strlen(buffer);
-        conn->releaseString = malloc(conn->releaseStringLength);
+        conn->releaseString = dpiUtils__allocateMemory(conn->env, 1,
+                conn->releaseStringLength, 0);
         if (!conn->releaseString)
             return dpiError__set(&error, "allocate release string",
                     DPI_ERR_NO_MEMORY);
@@ -1295,6 +1782,7 @@ int dpiConn_newDeqOptions(dpiConn *conn, dpiDeqOptions **options)
     if (dpiGen__allocate(DPI_HTYPE_DEQ_OPTIONS, conn->env,
             (void**) &tempOptions, &error) < 0)
         return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempOptions, conn->memoryCounters);
     if (dpiDeqOptions__create(tempOptions, conn, &error) < 0) {
         dpiDeqOptions__free(tempOptions, &error);
         return DPI_FAILURE;
@@ -1322,6 +1810,7 @@ int dpiConn_newEnqOptions(dpiConn *conn, dpiEnqOptions **options)
     if (dpiGen__allocate(DPI_HTYPE_ENQ_OPTIONS, conn->env,
             (void**) &tempOptions, &error) < 0)
         return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempOptions, conn->memoryCounters);
     if (dpiEnqOptions__create(tempOptions, conn, &error) < 0) {
         dpiEnqOptions__free(tempOptions, &error);
         return DPI_FAILURE;
@@ -1357,12 +1846,8 @@ int dpiConn_newTempLob(dpiConn *conn, dpiOracleTypeNum lobType, dpiLob **lob)
             return dpiError__set(&error, "check lob type",
                     DPI_ERR_INVALID_ORACLE_TYPE, lobType);
     }
-    if (dpiLob__allocate(conn, type, &tempLob, &error) < 0)
+    if (dpiLob__allocateTemporary(conn, type, &tempLob, &error) < 0)
         return DPI_FAILURE;
-    if (dpiLob__createTemporary(tempLob, &error) < 0) {
-        dpiLob__free(tempLob, &error);
-        return DPI_FAILURE;
-    }
 
     *lob = tempLob;
     return DPI_SUCCESS;
@@ -1386,6 +1871,7 @@ int dpiConn_newMsgProps(dpiConn *conn, dpiMsgProps **props)
     if (dpiGen__allocate(DPI_HTYPE_MSG_PROPS, conn->env, (void**) &tempProps,
             &error) < 0)
         return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempProps, conn->memoryCounters);
     if (dpiMsgProps__create(tempProps, conn, &error) < 0) {
         dpiMsgProps__free(tempProps, &error);
         return DPI_FAILURE;
@@ -1414,6 +1900,7 @@ int dpiConn_newSubscription(dpiConn *conn, dpiSubscrCreateParams *params,
     if (dpiGen__allocate(DPI_HTYPE_SUBSCR, conn->env, (void**) &tempSubscr,
             &error) < 0)
         return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempSubscr, conn->memoryCounters);
     if (dpiSubscr__create(tempSubscr, conn, params, subscrId, &error) < 0) {
         dpiSubscr__free(tempSubscr, &error);
         return DPI_FAILURE;
@@ -1510,7 +1997,7 @@ int dpiConn_prepareStmt(dpiConn *conn, int scrollable, const char *sql,
                 DPI_ERR_NULL_POINTER_PARAMETER, "stmt");
     if (dpiStmt__allocate(conn, scrollable, &tempStmt, &error) < 0)
         return DPI_FAILURE;
-    if (dpiStmt__prepare(tempStmt, sql, sqlLength, tag, tagLength,
+    if (dpiStmt__prepareFromCache(tempStmt, sql, sqlLength, tag, tagLength,
             &error) < 0) {
         dpiStmt__free(tempStmt, &error);
         return DPI_FAILURE;
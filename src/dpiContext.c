@@ -69,6 +69,7 @@ int dpiContext__initConnCreateParams(const dpiContext *context,
         dpiConnCreateParams *params, dpiError *error)
 {
     memset(params, 0, sizeof(dpiConnCreateParams));
+    params->bfileIdleTimeout = DPI_DEFAULT_BFILE_IDLE_TIMEOUT;
     return DPI_SUCCESS;
 }
 
@@ -88,6 +89,8 @@ int dpiContext__initPoolCreateParams(const dpiContext *context,
     params->getMode = DPI_MODE_POOL_GET_NOWAIT;
     params->pingInterval = DPI_DEFAULT_PING_INTERVAL;
     params->pingTimeout = DPI_DEFAULT_PING_TIMEOUT;
+    params->warmupThreads = DPI_DEFAULT_POOL_WARMUP_THREADS;
+    params->warmupReadyPercent = 100;
     return DPI_SUCCESS;
 }
 
@@ -149,7 +152,7 @@ int dpiContext_create(unsigned int majorVersion, unsigned int minorVersion,
     }
 
     // allocate memory for the context
-    tempContext = calloc(1, sizeof(dpiContext));
+    tempContext = dpiUtils__allocateMemory(NULL, 1, sizeof(dpiContext), 1);
     if (!tempContext) {
         dpiError__set(&error, "allocate memory", DPI_ERR_NO_MEMORY);
         return dpiError__getInfo(&error, errorInfo);
@@ -176,7 +179,7 @@ int dpiContext_destroy(dpiContext *context)
     if (dpiContext__startPublicFn(context, __func__, &error) < 0)
         return DPI_FAILURE;
     dpiUtils__clearMemory(&context->checkInt, sizeof(context->checkInt));
-    free(context);
+    dpiUtils__freeMemory(NULL, context);
     return DPI_SUCCESS;
 }
 
@@ -215,6 +218,23 @@ void dpiContext_getError(const dpiContext *context, dpiErrorInfo *info)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiContext_getMemoryStats() [PUBLIC]
+//   Return memory statistics for all of the handles created with the context,
+// including those created by connections and pools that are still open.
+//-----------------------------------------------------------------------------
+int dpiContext_getMemoryStats(const dpiContext *context,
+        dpiMemoryStats *stats)
+{
+    dpiError error;
+
+    if (dpiContext__startPublicFn(context, __func__, &error) < 0)
+        return DPI_FAILURE;
+    dpiUtils__getMemoryStats(context->memoryCounters, stats);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiContext_initCommonCreateParams() [PUBLIC]
 //   Initialize the common connection/pool creation parameters to default
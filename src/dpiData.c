@@ -93,13 +93,40 @@ int dpiData__fromOracleNumberAsDouble(dpiData *data, dpiEnv *env,
 
 //-----------------------------------------------------------------------------
 // dpiData__fromOracleNumberAsInteger() [INTERNAL]
-//   Populate the data from an OCINumber structure as an integer.
+//   Populate the data from an OCINumber structure as an integer. Finite
+// integers with no more digits than can always be held by an int64_t are
+// decoded directly, which avoids a call to OCI for each value; all other
+// values (including the infinities) are converted by OCI.
 //-----------------------------------------------------------------------------
 int dpiData__fromOracleNumberAsInteger(dpiData *data, dpiEnv *env,
         dpiError *error, OCINumber *oracleValue)
 {
+    uint8_t numDigits, digits[DPI_NUMBER_MAX_DIGITS], *source;
+    int16_t decimalPointIndex, i;
+    int isNegative;
+    int64_t value;
     sword status;
 
+    // only finite values are decoded directly; the first byte is the length
+    // of the number and the second byte is the exponent; zero is encoded with
+    // no mantissa and the exponent byte 0x80, whereas negative and positive
+    // infinity are encoded with the exponent bytes 0x00 and 0xFF
+    source = (uint8_t*) oracleValue;
+    if (source[0] > 0 && source[1] != 0x00 && source[1] != 0xFF &&
+            (source[0] > 1 || source[1] == 0x80)) {
+        if (dpiUtils__parseOracleNumber(oracleValue, &isNegative,
+                &decimalPointIndex, &numDigits, digits, error) < 0)
+            return DPI_FAILURE;
+        if (decimalPointIndex >= (int16_t) numDigits &&
+                decimalPointIndex <= DPI_MAX_INT64_PRECISION) {
+            value = 0;
+            for (i = 0; i < decimalPointIndex; i++)
+                value = value * 10 + ((i < numDigits) ? digits[i] : 0);
+            data->value.asInt64 = (isNegative) ? -value : value;
+            return DPI_SUCCESS;
+        }
+    }
+
     status = OCINumberToInt(error->handle, oracleValue, sizeof(int64_t),
             OCI_NUMBER_SIGNED, &data->value.asInt64);
     return dpiError__check(error, status, NULL, "get integer");
@@ -121,6 +148,30 @@ int dpiData__fromOracleNumberAsUnsignedInteger(dpiData *data, dpiEnv *env,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiData__fromOracleNumbersAsDouble() [INTERNAL]
+//   Populate each of the data structures from the corresponding OCINumber
+// structure as a double. The numbers are converted by a single call to OCI;
+// no more than DPI_NUMBER_BATCH_SIZE numbers may be converted at a time.
+//-----------------------------------------------------------------------------
+int dpiData__fromOracleNumbersAsDouble(dpiData **data,
+        OCINumber **oracleValues, uint32_t numValues, dpiError *error)
+{
+    double values[DPI_NUMBER_BATCH_SIZE];
+    sword status;
+    uint32_t i;
+
+    status = OCINumberToRealArray(error->handle,
+            (const OCINumber**) oracleValues, numValues, sizeof(double),
+            values);
+    if (dpiError__check(error, status, NULL, "get doubles") < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < numValues; i++)
+        data[i]->value.asDouble = values[i];
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiData__fromOracleNumberAsText() [INTERNAL]
 //   Populate the data from an OCINumber structure as text.
@@ -45,6 +45,7 @@ int dpiDeqOptions__create(dpiDeqOptions *options, dpiConn *conn,
 //-----------------------------------------------------------------------------
 void dpiDeqOptions__free(dpiDeqOptions *options, dpiError *error)
 {
+    dpiGen__updateMemoryStats(options, -1);
     if (options->handle) {
         OCIDescriptorFree(options->handle, OCI_DTYPE_AQDEQ_OPTIONS);
         options->handle = NULL;
@@ -53,7 +54,7 @@ void dpiDeqOptions__free(dpiDeqOptions *options, dpiError *error)
         dpiGen__setRefCount(options->conn, error, -1);
         options->conn = NULL;
     }
-    free(options);
+    dpiGen__free(options, error);
 }
 
 
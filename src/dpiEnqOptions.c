@@ -45,6 +45,7 @@ int dpiEnqOptions__create(dpiEnqOptions *options, dpiConn *conn,
 //-----------------------------------------------------------------------------
 void dpiEnqOptions__free(dpiEnqOptions *options, dpiError *error)
 {
+    dpiGen__updateMemoryStats(options, -1);
     if (options->handle) {
         OCIDescriptorFree(options->handle, OCI_DTYPE_AQENQ_OPTIONS);
         options->handle = NULL;
@@ -53,7 +54,7 @@ void dpiEnqOptions__free(dpiEnqOptions *options, dpiError *error)
         dpiGen__setRefCount(options->conn, error, -1);
         options->conn = NULL;
     }
-    free(options);
+    dpiGen__free(options, error);
 }
 
 
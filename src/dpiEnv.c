@@ -16,9 +16,75 @@
 
 #include "dpiImpl.h"
 
+// when native thread local storage and atomic operations are both available,
+// each thread caches the OCI error handles it has most recently used so that
+// the OCI thread key does not need to be consulted on every call; entries are
+// identified by an identifier unique to each threaded environment instead of
+// by the environment pointer since the memory of a freed environment may be
+// reused by a new one
+#if defined(DPI_THREAD_LOCAL) && defined(DPI_ATOMIC_ADD)
+#define DPI_USE_ERROR_HANDLE_CACHE
+static unsigned dpiEnvLastId = 0;
+static DPI_THREAD_LOCAL dpiErrorHandleCacheEntry
+        dpiEnvErrorHandleCache[DPI_MAX_CACHED_ERROR_HANDLES];
+static DPI_THREAD_LOCAL uint32_t dpiEnvErrorHandleCachePos;
+#endif
+
+//-----------------------------------------------------------------------------
+// dpiEnv__acquireMutex() [INTERNAL]
+//   Acquire the mutex used to protect structures shared between threads. If
+// the environment is not threaded, nothing is done.
+//-----------------------------------------------------------------------------
+int dpiEnv__acquireMutex(dpiEnv *env, dpiError *error)
+{
+    sword status;
+
+    if (!env->threaded)
+        return DPI_SUCCESS;
+    status = OCIThreadMutexAcquire(env->handle, error->handle, env->mutex);
+    return dpiError__check(error, status, NULL, "acquire mutex");
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiEnv__allocate() [INTERNAL]
+//   Allocate memory for a new environment, using the allocator supplied by the
+// caller, if one was supplied. The allocator is retained by the environment;
+// it is used for all memory allocated by ODPI-C for this environment,
+// including the handles created for it, and is also passed through to OCI
+// when the environment is initialized (see dpiEnv__init()).
+//-----------------------------------------------------------------------------
+int dpiEnv__allocate(const dpiAllocator *allocator, dpiEnv **env,
+        dpiError *error)
+{
+    dpiEnv *tempEnv;
+
+    // the environment itself is allocated directly with the allocator since
+    // there is no environment yet from which dpiUtils__allocateMemory() could
+    // take it
+    if (allocator) {
+        if (!allocator->allocate || !allocator->reallocate ||
+                !allocator->free)
+            return dpiError__set(error, "check allocator",
+                    DPI_ERR_INVALID_ALLOCATOR);
+        tempEnv = (*allocator->allocate)(allocator->context, sizeof(dpiEnv));
+        if (tempEnv) {
+            memset(tempEnv, 0, sizeof(dpiEnv));
+            tempEnv->allocator = *allocator;
+        }
+    } else tempEnv = dpiUtils__allocateMemory(NULL, 1, sizeof(dpiEnv), 1);
+    if (!tempEnv)
+        return dpiError__set(error, "allocate env memory", DPI_ERR_NO_MEMORY);
+
+    *env = tempEnv;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiEnv__free() [INTERNAL]
-//   Free the memory associated with the environment.
+//   Free the memory associated with the environment. The structure itself is
+// returned to the allocator it was allocated with.
 //-----------------------------------------------------------------------------
 void dpiEnv__free(dpiEnv *env, dpiError *error)
 {
@@ -34,7 +100,7 @@ void dpiEnv__free(dpiEnv *env, dpiError *error)
         OCIHandleFree(env->handle, OCI_HTYPE_ENV);
         env->handle = NULL;
     }
-    free(env);
+    dpiUtils__freeMemory(env, env);
 }
 
 
@@ -89,6 +155,7 @@ int dpiEnv__init(dpiEnv *env, const dpiContext *context,
     char timezoneBuffer[20];
     size_t timezoneLength;
     sword status;
+    int i;
 
     // lookup encoding
     if (params->encoding && dpiGlobal__lookupCharSet(params->encoding,
@@ -103,10 +170,21 @@ int dpiEnv__init(dpiEnv *env, const dpiContext *context,
             &env->ncharsetId, error) < 0)
         return DPI_FAILURE;
 
-    // create the new environment handle
+    // associate the environment with the context and transfer to it any
+    // memory counted before the association was made (such as the memory for
+    // the connection or pool handle that owns the environment)
+    for (i = 0; i < DPI_MEMORY_COUNTER_MAX; i++)
+        DPI_ATOMIC_ADD_64(&((dpiContext*) context)->memoryCounters[i],
+                env->memoryCounters[i]);
     env->context = context;
+
+    // create the new environment handle; the allocator retained when the
+    // environment was allocated is passed through to OCI so that the memory
+    // it allocates for the environment is included
     status = OCIEnvNlsCreate(&env->handle, params->createMode | OCI_OBJECT,
-            NULL, NULL, NULL, NULL, 0, NULL, env->charsetId, env->ncharsetId);
+            env->allocator.context, env->allocator.allocate,
+            env->allocator.reallocate, env->allocator.free, 0, NULL,
+            env->charsetId, env->ncharsetId);
     if (!env->handle ||
             (status != OCI_SUCCESS && status != OCI_SUCCESS_WITH_INFO))
         return dpiError__set(error, "create environment", DPI_ERR_CREATE_ENV);
@@ -172,9 +250,14 @@ int dpiEnv__init(dpiEnv *env, const dpiContext *context,
     if (dpiError__check(error, status, NULL, "construct base date") < 0)
         return DPI_FAILURE;
 
-    // set whether or not we are threaded
-    if (params->createMode & OCI_THREADED)
+    // set whether or not we are threaded and, if so, assign an identifier
+    // used for caching error handles in thread local storage
+    if (params->createMode & OCI_THREADED) {
         env->threaded = 1;
+#ifdef DPI_USE_ERROR_HANDLE_CACHE
+        env->id = DPI_ATOMIC_ADD(&dpiEnvLastId, 1);
+#endif
+    }
 
     return DPI_SUCCESS;
 }
@@ -193,6 +276,10 @@ int dpiEnv__init(dpiEnv *env, const dpiContext *context,
 //-----------------------------------------------------------------------------
 int dpiEnv__initError(dpiEnv *env, dpiError *error)
 {
+#ifdef DPI_USE_ERROR_HANDLE_CACHE
+    dpiErrorHandleCacheEntry *entry;
+    uint32_t i;
+#endif
     sword status;
 
     // the encoding for errors is the CHAR encoding
@@ -206,6 +293,17 @@ int dpiEnv__initError(dpiEnv *env, dpiError *error)
     // if threaded, however, use thread-specified error handle
     else {
 
+#ifdef DPI_USE_ERROR_HANDLE_CACHE
+        // check the error handles cached by this thread first
+        for (i = 0; i < DPI_MAX_CACHED_ERROR_HANDLES; i++) {
+            entry = &dpiEnvErrorHandleCache[i];
+            if (entry->handle && entry->envId == env->id) {
+                error->handle = entry->handle;
+                return DPI_SUCCESS;
+            }
+        }
+#endif
+
         // get the thread specific error handle
         status = OCIThreadKeyGet(env->handle, env->errorHandle, env->threadKey,
                 (void**) &error->handle);
@@ -229,8 +327,52 @@ int dpiEnv__initError(dpiEnv *env, dpiError *error)
             }
         }
 
+#ifdef DPI_USE_ERROR_HANDLE_CACHE
+        // cache the error handle for subsequent calls by this thread,
+        // replacing the oldest entry if the cache is full; the error handle
+        // itself remains owned by the thread key
+        entry = &dpiEnvErrorHandleCache[dpiEnvErrorHandleCachePos];
+        dpiEnvErrorHandleCachePos = (dpiEnvErrorHandleCachePos + 1) %
+                DPI_MAX_CACHED_ERROR_HANDLES;
+        entry->envId = env->id;
+        entry->handle = error->handle;
+#endif
+
     }
 
     return DPI_SUCCESS;
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiEnv__releaseMutex() [INTERNAL]
+//   Release the mutex acquired by dpiEnv__acquireMutex(). If the environment
+// is not threaded, nothing is done.
+//-----------------------------------------------------------------------------
+int dpiEnv__releaseMutex(dpiEnv *env, dpiError *error)
+{
+    sword status;
+
+    if (!env->threaded)
+        return DPI_SUCCESS;
+    status = OCIThreadMutexRelease(env->handle, error->handle, env->mutex);
+    return dpiError__check(error, status, NULL, "release mutex");
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiEnv__updateMemoryStats() [INTERNAL]
+//   Adjust one of the memory counters maintained by the environment and, if
+// the environment has been associated with a context, the same counter
+// maintained by the context. The context counters are shared by all
+// environments created with the context so they are adjusted atomically.
+//-----------------------------------------------------------------------------
+void dpiEnv__updateMemoryStats(dpiEnv *env, dpiMemoryCounterNum counterNum,
+        int64_t delta)
+{
+    dpiContext *context = (dpiContext*) env->context;
+
+    DPI_ATOMIC_ADD_64(&env->memoryCounters[counterNum], delta);
+    if (context)
+        DPI_ATOMIC_ADD_64(&context->memoryCounters[counterNum], delta);
+}
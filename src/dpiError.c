@@ -119,6 +119,19 @@ int dpiError__check(dpiError *error, sword status, dpiConn *conn,
         }
     }
 
+    // check for certain errors which indicate that an object type has been
+    // changed and that the object types cached by the connection should no
+    // longer be used
+    if (conn && conn->objectTypeCache) {
+        switch (error->buffer->code) {
+            case 21700: // object does not exist or is marked for delete
+            case 22303: // type not found
+            case 22337: // the type of accessed object has been evolved
+                conn->objectTypeCache->invalidated = 1;
+                break;
+        }
+    }
+
     return DPI_FAILURE;
 }
 
@@ -137,7 +150,8 @@ int dpiError__getInfo(dpiError *error, dpiErrorInfo *info)
     info->fnName = error->buffer->fnName;
     info->action = error->buffer->action;
     info->isRecoverable = error->buffer->isRecoverable;
-    info->encoding = error->buffer->encoding;
+    info->encoding = (info->code == 0 && error->buffer->dpiErrorNum == 0) ?
+            DPI_CHARSET_NAME_UTF8 : error->buffer->encoding;
     switch(info->code) {
         case 12154: // TNS:could not resolve the connect identifier specified
             info->sqlState = "42S02";
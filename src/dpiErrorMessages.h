@@ -64,5 +64,19 @@ static const char* const dpiErrorMessages[DPI_ERR_MAX - DPI_ERR_NO_ERR] = {
     "DPI-1044: number too large", // DPI_ERR_NUMBER_TOO_LARGE
     "DPI-1045: strings converted to numbers can only be up to 172 characters long", // DPI_ERR_NUMBER_STRING_TOO_LONG
     "DPI-1046: parameter %s cannot be a NULL pointer", // DPI_ERR_NULL_POINTER_PARAMETER
+    "DPI-1047: allocator must specify allocate, reallocate and free callbacks", // DPI_ERR_INVALID_ALLOCATOR
+    "DPI-1048: pools managed by ODPI-C must be homogeneous", // DPI_ERR_MANAGED_POOL_NOT_HOMOGENEOUS
+    "DPI-1049: no session is available in the pool", // DPI_ERR_NO_SESSION_AVAILABLE
+    "DPI-1050: the maximum number of %u threads waiting for a session has been reached", // DPI_ERR_TOO_MANY_POOL_WAITERS
+    "DPI-1051: timed out after %u milliseconds waiting for a session", // DPI_ERR_POOL_WAIT_TIMEOUT
+    "DPI-1052: pool has busy sessions", // DPI_ERR_POOL_HAS_BUSY_SESSIONS
+    "DPI-1053: unable to create thread", // DPI_ERR_CREATE_THREAD
+    "DPI-1054: an asynchronous operation is in progress on this connection", // DPI_ERR_ASYNC_OPERATION_PENDING
+    "DPI-1055: executor is closed", // DPI_ERR_EXECUTOR_CLOSED
+    "DPI-1056: executor queue is full", // DPI_ERR_EXECUTOR_QUEUE_FULL
+    "DPI-1057: session fixup callback failed", // DPI_ERR_SESSION_FIXUP_FAILED
+    "DPI-1058: LOBs must all belong to the same connection and be of the same type", // DPI_ERR_LOB_ARRAY_MISMATCH
+    "DPI-1059: attribute at index %u does not exist", // DPI_ERR_INVALID_ATTR_INDEX
+    "DPI-1060: attribute %.*s does not exist in object type %.*s.%.*s", // DPI_ERR_ATTR_NOT_FOUND
 };
 
@@ -0,0 +1,499 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016, 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiExecutor.c
+//   Implementation of executors, which run requests submitted by the
+// application on a fixed set of worker threads.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// the submission queue is a bounded queue in which each slot carries a
+// sequence number that tells producers and consumers whether the slot is
+// ready for them; positions are claimed with compare-and-swap so that
+// submitting a request never blocks; if atomic operations are not available,
+// the same algorithm is used while holding the mutex of the executor
+#ifndef DPI_ATOMIC_COMPARE_AND_SWAP
+#define DPI_EXECUTOR_USE_MUTEX
+#define DPI_ATOMIC_LOAD(ptr)            (*(ptr))
+#define DPI_ATOMIC_STORE(ptr, value)    (*(ptr) = (value))
+#define DPI_ATOMIC_COMPARE_AND_SWAP(ptr, expected, desired) \
+        ((*(ptr) == (expected)) ? ((*(ptr) = (desired)), 1) : 0)
+#define DPI_ATOMIC_FENCE()
+#endif
+
+// the submit state of the executor holds a flag indicating that no further
+// requests are accepted in its lowest bit and the number of threads in the
+// middle of submitting a request in the remaining bits
+#define DPI_EXECUTOR_SUBMIT_CLOSED      1
+#define DPI_EXECUTOR_SUBMIT_INCREMENT   2
+
+// forward declarations of internal functions only used in this file
+static int dpiExecutor__closeWorkers(dpiExecutor *executor);
+static int dpiExecutor__dequeue(dpiExecutor *executor,
+        dpiExecutorRequest *request);
+static int dpiExecutor__enqueue(dpiExecutor *executor,
+        const dpiExecutorRequest *request);
+static int dpiExecutor__execute(dpiExecutorWorker *worker,
+        dpiExecutorRequest *request, dpiStmt **stmt);
+static void dpiExecutor__processRequest(dpiExecutorWorker *worker,
+        dpiExecutorRequest *request);
+static void dpiExecutor__workerThread(dpiExecutorWorker *worker);
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor__closeWorkers() [INTERNAL]
+//   Stop accepting requests, mark the executor as closing, wake all of the
+// idle worker threads and wait for them to finish. The worker threads process
+// all requests that are still in the queue before finishing. Threads that are
+// in the middle of submitting a request are waited for before the worker
+// threads are told to stop so that every request that was accepted is
+// processed. Returns 0 if the executor was already closed.
+//-----------------------------------------------------------------------------
+static int dpiExecutor__closeWorkers(dpiExecutor *executor)
+{
+    uint32_t i;
+#ifndef DPI_EXECUTOR_USE_MUTEX
+    uint32_t state;
+
+    // set the closed bit of the submit state; only the first caller does so
+    while (1) {
+        state = DPI_ATOMIC_LOAD(&executor->submitState);
+        if (state & DPI_EXECUTOR_SUBMIT_CLOSED)
+            return 0;
+        if (DPI_ATOMIC_COMPARE_AND_SWAP(&executor->submitState, state,
+                state | DPI_EXECUTOR_SUBMIT_CLOSED))
+            break;
+    }
+
+    // wait for the threads still submitting requests; enqueuing never blocks
+    // so this only ever spins for a very short time
+    while (DPI_ATOMIC_LOAD(&executor->submitState) !=
+            DPI_EXECUTOR_SUBMIT_CLOSED);
+#endif
+
+    dpiThread__acquireMutex(&executor->mutex);
+    if (executor->closing) {
+        dpiThread__releaseMutex(&executor->mutex);
+        return 0;
+    }
+    executor->closing = 1;
+    dpiThread__broadcastCondition(&executor->condition);
+    dpiThread__releaseMutex(&executor->mutex);
+    for (i = 0; i < executor->numWorkers; i++)
+        dpiThread__join(executor->workers[i].thread);
+    executor->numWorkers = 0;
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor__dequeue() [INTERNAL]
+//   Remove the request at the head of the queue and return 1, or return 0 if
+// the queue is empty.
+//-----------------------------------------------------------------------------
+static int dpiExecutor__dequeue(dpiExecutor *executor,
+        dpiExecutorRequest *request)
+{
+    dpiExecutorSlot *slot;
+    uint32_t pos;
+    int32_t diff;
+
+#ifdef DPI_EXECUTOR_USE_MUTEX
+    dpiThread__acquireMutex(&executor->mutex);
+#endif
+    pos = DPI_ATOMIC_LOAD(&executor->dequeuePos);
+    while (1) {
+        slot = &executor->slots[pos & executor->queueMask];
+        diff = (int32_t) (DPI_ATOMIC_LOAD(&slot->sequence) - (pos + 1));
+        if (diff == 0) {
+            if (DPI_ATOMIC_COMPARE_AND_SWAP(&executor->dequeuePos, pos,
+                    pos + 1))
+                break;
+            pos = DPI_ATOMIC_LOAD(&executor->dequeuePos);
+        } else if (diff < 0) {
+#ifdef DPI_EXECUTOR_USE_MUTEX
+            dpiThread__releaseMutex(&executor->mutex);
+#endif
+            return 0;
+        } else pos = DPI_ATOMIC_LOAD(&executor->dequeuePos);
+    }
+    *request = slot->request;
+    DPI_ATOMIC_STORE(&slot->sequence, pos + executor->queueMask + 1);
+#ifdef DPI_EXECUTOR_USE_MUTEX
+    dpiThread__releaseMutex(&executor->mutex);
+#endif
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor__enqueue() [INTERNAL]
+//   Add the request to the tail of the queue and return 1, or return 0 if the
+// queue is full. If atomic operations are not available, the caller must hold
+// the mutex of the executor.
+//-----------------------------------------------------------------------------
+static int dpiExecutor__enqueue(dpiExecutor *executor,
+        const dpiExecutorRequest *request)
+{
+    dpiExecutorSlot *slot;
+    uint32_t pos;
+    int32_t diff;
+
+    pos = DPI_ATOMIC_LOAD(&executor->enqueuePos);
+    while (1) {
+        slot = &executor->slots[pos & executor->queueMask];
+        diff = (int32_t) (DPI_ATOMIC_LOAD(&slot->sequence) - pos);
+        if (diff == 0) {
+            if (DPI_ATOMIC_COMPARE_AND_SWAP(&executor->enqueuePos, pos,
+                    pos + 1))
+                break;
+            pos = DPI_ATOMIC_LOAD(&executor->enqueuePos);
+        } else if (diff < 0)
+            return 0;
+        else pos = DPI_ATOMIC_LOAD(&executor->enqueuePos);
+    }
+    slot->request = *request;
+    DPI_ATOMIC_STORE(&slot->sequence, pos + 1);
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor__execute() [INTERNAL]
+//   Prepare, bind and execute the statement of the request on the connection
+// of the worker thread. The connection is acquired from the pool the first
+// time it is needed and is retained by the worker thread afterwards so that
+// its statement cache can be used for subsequent requests.
+//-----------------------------------------------------------------------------
+static int dpiExecutor__execute(dpiExecutorWorker *worker,
+        dpiExecutorRequest *request, dpiStmt **stmt)
+{
+    uint32_t numQueryColumns, i;
+
+    if (!worker->conn && dpiPool_acquireConnection(worker->executor->pool,
+            NULL, 0, NULL, 0, NULL, &worker->conn) < 0)
+        return DPI_FAILURE;
+    if (dpiConn_prepareStmt(worker->conn, 0, request->sql,
+            request->sqlLength, NULL, 0, stmt) < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < request->numBindValues; i++) {
+        if (dpiStmt_bindValueByPos(*stmt, i + 1,
+                request->bindNativeTypeNums[i], &request->bindValues[i]) < 0)
+            return DPI_FAILURE;
+    }
+    if (request->fetchArraySize > 0 &&
+            dpiStmt_setFetchArraySize(*stmt, request->fetchArraySize) < 0)
+        return DPI_FAILURE;
+    return dpiStmt_execute(*stmt, request->execMode, &numQueryColumns);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor__free() [INTERNAL]
+//   Free the memory associated with the executor. The worker threads are
+// stopped first if the executor was not closed explicitly.
+//-----------------------------------------------------------------------------
+void dpiExecutor__free(dpiExecutor *executor, dpiError *error)
+{
+    dpiGen__updateMemoryStats(executor, -1);
+    if (executor->workers) {
+        dpiExecutor__closeWorkers(executor);
+        dpiUtils__freeMemory(executor->env, executor->workers);
+        executor->workers = NULL;
+        dpiThread__destroyCondition(&executor->condition);
+        dpiThread__destroyMutex(&executor->mutex);
+    }
+    if (executor->slots) {
+        dpiUtils__freeMemory(executor->env, executor->slots);
+        executor->slots = NULL;
+    }
+    if (executor->pool) {
+        dpiGen__setRefCount(executor->pool, error, -1);
+        executor->pool = NULL;
+    }
+    dpiGen__free(executor, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor__processRequest() [INTERNAL]
+//   Process a request on a worker thread and deliver the result to the
+// callback of the request. On success the callback receives the executed
+// statement, which it may use to fetch rows; the statement is released once
+// the callback returns. On failure the callback receives the error instead.
+// If the connection of the worker thread is no longer usable, it is dropped
+// and a new one is acquired for the next request.
+//-----------------------------------------------------------------------------
+static void dpiExecutor__processRequest(dpiExecutorWorker *worker,
+        dpiExecutorRequest *request)
+{
+    dpiStmt *stmt = NULL;
+    dpiErrorInfo info;
+    dpiError error;
+
+    if (dpiExecutor__execute(worker, request, &stmt) == DPI_SUCCESS) {
+        (*request->callback)(request->callbackContext, stmt, NULL);
+        dpiStmt_release(stmt);
+        return;
+    }
+    dpiGlobal__initError(NULL, &error);
+    dpiError__getInfo(&error, &info);
+    (*request->callback)(request->callbackContext, NULL, &info);
+    if (stmt)
+        dpiStmt_release(stmt);
+    if (worker->conn && dpiConn_ping(worker->conn) < 0) {
+        dpiConn_close(worker->conn, DPI_MODE_CONN_CLOSE_DROP, NULL, 0);
+        dpiConn_release(worker->conn);
+        worker->conn = NULL;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor__workerThread() [INTERNAL]
+//   Thread procedure of the worker threads of an executor. Requests are
+// removed from the queue and processed until the queue is empty; the thread
+// then waits until a new request is submitted or the executor is closed.
+// Before waiting, the thread announces that it is idle and checks the queue
+// once more so that a request submitted concurrently is not missed.
+//-----------------------------------------------------------------------------
+static void dpiExecutor__workerThread(dpiExecutorWorker *worker)
+{
+    dpiExecutor *executor = worker->executor;
+    dpiExecutorRequest request;
+    int found;
+
+    while (1) {
+        if (dpiExecutor__dequeue(executor, &request)) {
+            dpiExecutor__processRequest(worker, &request);
+            continue;
+        }
+        dpiThread__acquireMutex(&executor->mutex);
+        if (executor->closing) {
+            dpiThread__releaseMutex(&executor->mutex);
+            break;
+        }
+        DPI_ATOMIC_STORE(&executor->numIdleWorkers,
+                executor->numIdleWorkers + 1);
+        DPI_ATOMIC_FENCE();
+#ifdef DPI_EXECUTOR_USE_MUTEX
+        found = (executor->slots[executor->dequeuePos &
+                executor->queueMask].sequence == executor->dequeuePos + 1);
+#else
+        found = dpiExecutor__dequeue(executor, &request);
+#endif
+        if (!found)
+            dpiThread__waitCondition(&executor->condition, &executor->mutex,
+                    0);
+        DPI_ATOMIC_STORE(&executor->numIdleWorkers,
+                executor->numIdleWorkers - 1);
+        dpiThread__releaseMutex(&executor->mutex);
+#ifndef DPI_EXECUTOR_USE_MUTEX
+        if (found)
+            dpiExecutor__processRequest(worker, &request);
+#endif
+    }
+
+    if (worker->conn) {
+        dpiConn_release(worker->conn);
+        worker->conn = NULL;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor_addRef() [PUBLIC]
+//   Add a reference to the executor.
+//-----------------------------------------------------------------------------
+int dpiExecutor_addRef(dpiExecutor *executor)
+{
+    return dpiGen__addRef(executor, DPI_HTYPE_EXECUTOR, __func__);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor_close() [PUBLIC]
+//   Stop accepting requests, wait for the requests that were already submitted
+// to complete and stop the worker threads. This must not be called from the
+// callback of a request.
+//-----------------------------------------------------------------------------
+int dpiExecutor_close(dpiExecutor *executor)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(executor, DPI_HTYPE_EXECUTOR, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    if (!dpiExecutor__closeWorkers(executor))
+        return dpiError__set(&error, "check closed", DPI_ERR_EXECUTOR_CLOSED);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor_create() [PUBLIC]
+//   Create an executor with the given number of worker threads, each of which
+// uses its own connection acquired from the pool, and a queue which can hold
+// at least the given number of requests.
+//-----------------------------------------------------------------------------
+int dpiExecutor_create(dpiPool *pool, uint32_t numWorkers, uint32_t queueSize,
+        dpiExecutor **executor)
+{
+    dpiExecutor *tempExecutor;
+    dpiExecutorWorker *worker;
+    uint32_t queueCapacity, i;
+    dpiError error;
+
+    // validate parameters
+    if (dpiGen__startPublicFn(pool, DPI_HTYPE_POOL, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (!pool->handle)
+        return dpiError__set(&error, "check pool", DPI_ERR_NOT_CONNECTED);
+    if (!executor)
+        return dpiError__set(&error, "check executor handle",
+                DPI_ERR_NULL_POINTER_PARAMETER, "executor");
+    if (numWorkers == 0 || queueSize == 0 || queueSize > 0x40000000)
+        return dpiError__set(&error, "check parameters",
+                DPI_ERR_NOT_SUPPORTED);
+
+    // the queue capacity must be a power of two
+    for (queueCapacity = 1; queueCapacity < queueSize; queueCapacity <<= 1);
+
+    // allocate the executor and its queue
+    if (dpiGen__allocate(DPI_HTYPE_EXECUTOR, pool->env,
+            (void**) &tempExecutor, &error) < 0)
+        return DPI_FAILURE;
+    if (dpiGen__setRefCount(pool, &error, 1) < 0) {
+        dpiExecutor__free(tempExecutor, &error);
+        return DPI_FAILURE;
+    }
+    tempExecutor->pool = pool;
+    tempExecutor->queueMask = queueCapacity - 1;
+    tempExecutor->slots = dpiUtils__allocateMemory(pool->env, queueCapacity,
+            sizeof(dpiExecutorSlot), 1);
+    tempExecutor->workers = dpiUtils__allocateMemory(pool->env, numWorkers,
+            sizeof(dpiExecutorWorker), 1);
+    if (!tempExecutor->slots || !tempExecutor->workers) {
+        if (tempExecutor->workers) {
+            dpiUtils__freeMemory(pool->env, tempExecutor->workers);
+            tempExecutor->workers = NULL;
+        }
+        dpiExecutor__free(tempExecutor, &error);
+        return dpiError__set(&error, "allocate executor", DPI_ERR_NO_MEMORY);
+    }
+    for (i = 0; i < queueCapacity; i++)
+        tempExecutor->slots[i].sequence = i;
+    dpiThread__initMutex(&tempExecutor->mutex);
+    dpiThread__initCondition(&tempExecutor->condition);
+
+    // start the worker threads
+    for (i = 0; i < numWorkers; i++) {
+        worker = &tempExecutor->workers[i];
+        worker->executor = tempExecutor;
+        if (dpiThread__create(tempExecutor->env, &worker->thread,
+                (dpiThreadProc) dpiExecutor__workerThread, worker) < 0) {
+            dpiExecutor__free(tempExecutor, &error);
+            return dpiError__set(&error, "start worker thread",
+                    DPI_ERR_CREATE_THREAD);
+        }
+        tempExecutor->numWorkers++;
+    }
+
+    *executor = tempExecutor;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor_release() [PUBLIC]
+//   Release a reference to the executor.
+//-----------------------------------------------------------------------------
+int dpiExecutor_release(dpiExecutor *executor)
+{
+    return dpiGen__release(executor, DPI_HTYPE_EXECUTOR, __func__);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiExecutor_submit() [PUBLIC]
+//   Submit a request to the executor. The request is copied into the queue
+// but the memory it refers to must remain valid until its callback has been
+// called. The submitting thread registers itself in the submit state of the
+// executor before checking whether the executor is closed and enqueuing the
+// request, and dpiExecutor__closeWorkers() waits for it to finish doing so,
+// which means that a request that is accepted is always processed. An idle
+// worker thread is woken only if there is one, so that the mutex of the
+// executor is not acquired while all worker threads are busy.
+//-----------------------------------------------------------------------------
+int dpiExecutor_submit(dpiExecutor *executor,
+        const dpiExecutorRequest *request)
+{
+    dpiError error;
+#ifndef DPI_EXECUTOR_USE_MUTEX
+    uint32_t state;
+#endif
+    int queued;
+
+    if (dpiGen__startPublicFn(executor, DPI_HTYPE_EXECUTOR, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    if (!request)
+        return dpiError__set(&error, "check request",
+                DPI_ERR_NULL_POINTER_PARAMETER, "request");
+    if (!request->callback)
+        return dpiError__set(&error, "check callback",
+                DPI_ERR_NULL_POINTER_PARAMETER, "callback");
+
+#ifdef DPI_EXECUTOR_USE_MUTEX
+    // without atomic operations the check and the enqueue are both performed
+    // while holding the mutex, which is also held when closing is set
+    dpiThread__acquireMutex(&executor->mutex);
+    if (executor->closing) {
+        dpiThread__releaseMutex(&executor->mutex);
+        return dpiError__set(&error, "check closed", DPI_ERR_EXECUTOR_CLOSED);
+    }
+    queued = dpiExecutor__enqueue(executor, request);
+    dpiThread__releaseMutex(&executor->mutex);
+#else
+    // register as a submitting thread unless the executor has been closed
+    while (1) {
+        state = DPI_ATOMIC_LOAD(&executor->submitState);
+        if (state & DPI_EXECUTOR_SUBMIT_CLOSED)
+            return dpiError__set(&error, "check closed",
+                    DPI_ERR_EXECUTOR_CLOSED);
+        if (DPI_ATOMIC_COMPARE_AND_SWAP(&executor->submitState, state,
+                state + DPI_EXECUTOR_SUBMIT_INCREMENT))
+            break;
+    }
+
+    // enqueue the request and deregister as a submitting thread
+    queued = dpiExecutor__enqueue(executor, request);
+    while (1) {
+        state = DPI_ATOMIC_LOAD(&executor->submitState);
+        if (DPI_ATOMIC_COMPARE_AND_SWAP(&executor->submitState, state,
+                state - DPI_EXECUTOR_SUBMIT_INCREMENT))
+            break;
+    }
+#endif
+
+    if (!queued)
+        return dpiError__set(&error, "enqueue request",
+                DPI_ERR_EXECUTOR_QUEUE_FULL);
+    DPI_ATOMIC_FENCE();
+    if (DPI_ATOMIC_LOAD(&executor->numIdleWorkers) > 0) {
+        dpiThread__acquireMutex(&executor->mutex);
+        dpiThread__signalCondition(&executor->condition);
+        dpiThread__releaseMutex(&executor->mutex);
+    }
+    return DPI_SUCCESS;
+}
@@ -97,6 +97,24 @@ static const dpiTypeDef dpiAllTypeDefs[DPI_HTYPE_MAX - DPI_HTYPE_NONE - 1] = {
         sizeof(dpiRowid),               // size of structure
         0x6204fa04,                     // check integer
         (dpiTypeFreeProc) dpiRowid__free
+    },
+    {
+        "dpiExecutor",                  // name
+        sizeof(dpiExecutor),            // size of structure
+        0x5c3a8e17,                     // check integer
+        (dpiTypeFreeProc) dpiExecutor__free
+    },
+    {
+        "dpiLobReader",                 // name
+        sizeof(dpiLobReader),           // size of structure
+        0x1fb7c6d4,                     // check integer
+        (dpiTypeFreeProc) dpiLobReader__free
+    },
+    {
+        "dpiLobWriter",                 // name
+        sizeof(dpiLobWriter),           // size of structure
+        0x7e2d9a51,                     // check integer
+        (dpiTypeFreeProc) dpiLobWriter__free
     }
 };
 
@@ -118,31 +136,43 @@ int dpiGen__addRef(void *ptr, dpiHandleTypeNum typeNum, const char *fnName)
 //-----------------------------------------------------------------------------
 // dpiGen__allocate() [INTERNAL]
 //   Allocate memory for the specified type and initialize the base fields. The
-// type specified is assumed to be valid. If the environment is specified, use
-// it; otherwise, create a new one. No additional initialization is performed.
+// type specified is assumed to be valid. The memory is allocated with the
+// allocator of the environment, if one was supplied; otherwise, a handle
+// previously freed by this thread is reused, if one is available. No
+// additional initialization is performed.
 //-----------------------------------------------------------------------------
 int dpiGen__allocate(dpiHandleTypeNum typeNum, dpiEnv *env, void **handle,
         dpiError *error)
 {
     const dpiTypeDef *typeDef;
+    dpiHandleCache *cache;
     dpiBaseType *value;
 
+    // use the allocator of the environment, if one was supplied; otherwise,
+    // use a handle previously freed by this thread, if one is available, or
+    // allocate memory for a new one
     typeDef = &dpiAllTypeDefs[typeNum - DPI_HTYPE_NONE - 1];
-    value = calloc(1, typeDef->size);
-    if (!value)
-        return dpiError__set(error, "allocate memory", DPI_ERR_NO_MEMORY);
+    cache = (error->buffer->handleCaches) ?
+            &error->buffer->handleCaches[typeNum - DPI_HTYPE_NONE - 1] : NULL;
+    if (env->allocator.allocate) {
+        value = dpiUtils__allocateMemory(env, 1, typeDef->size, 1);
+        if (!value)
+            return dpiError__set(error, "allocate memory", DPI_ERR_NO_MEMORY);
+        value->allocatorFree = env->allocator.free;
+        value->allocatorContext = env->allocator.context;
+    } else if (cache && cache->numHandles > 0) {
+        value = cache->handles[--cache->numHandles];
+        memset(value, 0, typeDef->size);
+    } else {
+        value = dpiUtils__allocateMemory(NULL, 1, typeDef->size, 1);
+        if (!value)
+            return dpiError__set(error, "allocate memory", DPI_ERR_NO_MEMORY);
+    }
     value->typeDef = typeDef;
     value->checkInt = typeDef->checkInt;
     value->refCount = 1;
-    if (!env) {
-        env = (dpiEnv*) calloc(1, sizeof(dpiEnv));
-        if (!env) {
-            free(value);
-            return dpiError__set(error, "allocate env memory",
-                    DPI_ERR_NO_MEMORY);
-        }
-    }
     value->env = env;
+    dpiGen__updateMemoryStats(value, 1);
 #if DPI_TRACE_REFS
     fprintf(stderr, "REF: %p (%s) -> 1 [NEW]\n", value, typeDef->name);
 #endif
@@ -172,6 +202,39 @@ int dpiGen__checkHandle(void *ptr, dpiHandleTypeNum typeNum,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiGen__free() [INTERNAL]
+//   Free the memory associated with the handle. This is called by the free
+// routines of each of the handle types once all other resources have been
+// released. Memory allocated with the allocator of the environment is
+// returned to it; otherwise, the memory is retained in the calling thread's
+// cache of freed handles of the same type, if there is space available, so
+// that it can be reused by dpiGen__allocate() without going to the heap.
+//-----------------------------------------------------------------------------
+void dpiGen__free(void *ptr, dpiError *error)
+{
+    dpiBaseType *value = (dpiBaseType*) ptr;
+    dpiHandleCache *cache;
+
+    // handles allocated with the allocator of their environment are returned
+    // to it; the environment may already have been freed at this point so the
+    // callback retained when the handle was allocated is used
+    if (value->allocatorFree) {
+        (*value->allocatorFree)(value->allocatorContext, ptr);
+        return;
+    }
+
+    if (error->buffer->handleCaches) {
+        cache = &error->buffer->handleCaches[value->typeDef - dpiAllTypeDefs];
+        if (cache->numHandles < DPI_MAX_CACHED_HANDLES) {
+            cache->handles[cache->numHandles++] = ptr;
+            return;
+        }
+    }
+    dpiUtils__freeMemory(NULL, ptr);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiGen__release() [INTERNAL]
 //   Release a reference to the specified handle. If the reference count
@@ -189,22 +252,63 @@ int dpiGen__release(void *ptr, dpiHandleTypeNum typeNum, const char *fnName)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiGen__setMemoryOwner() [INTERNAL]
+//   Associate the handle with the memory counters of the connection that owns
+// it, moving the handle from the counters of the previous owner, if any. This
+// is called once the handle has been allocated and before any buffers are
+// allocated for it. The owning connection must outlive the handle, which is
+// ensured by the reference each owned handle retains (directly or indirectly)
+// to the connection.
+//-----------------------------------------------------------------------------
+void dpiGen__setMemoryOwner(void *ptr, int64_t *memoryCounters)
+{
+    dpiBaseType *value = (dpiBaseType*) ptr;
+    int64_t *previousCounters, size;
+    dpiMemoryCounterNum counterNum;
+
+    previousCounters = value->ownerMemoryCounters;
+    if (previousCounters == memoryCounters)
+        return;
+    counterNum = (dpiMemoryCounterNum) (value->typeDef - dpiAllTypeDefs);
+    size = (int64_t) value->typeDef->size;
+    if (previousCounters) {
+        DPI_ATOMIC_ADD_64(&previousCounters[counterNum], -1);
+        DPI_ATOMIC_ADD_64(&previousCounters[DPI_MEMORY_COUNTER_HANDLE_BYTES],
+                -size);
+    }
+    value->ownerMemoryCounters = memoryCounters;
+    if (memoryCounters) {
+        DPI_ATOMIC_ADD_64(&memoryCounters[counterNum], 1);
+        DPI_ATOMIC_ADD_64(&memoryCounters[DPI_MEMORY_COUNTER_HANDLE_BYTES],
+                size);
+    }
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiGen__setRefCount() [INTERNAL]
 //   Increase or decrease the reference count by the given amount. The handle
 // is assumed to be valid at this point. If the environment is in threaded
-// mode, acquire the mutex first before making any adjustments to the reference
-// count. If the operation sets the reference count to zero, release all
-// resources and free the memory associated with the structure.
+// mode, the reference count is adjusted atomically or, on platforms where
+// atomic operations are not available or when DPI_DISABLE_ATOMIC_REF_COUNTS
+// is defined, after acquiring the mutex. If the operation sets the reference
+// count to zero, release all resources and free the memory associated with
+// the structure.
 //-----------------------------------------------------------------------------
 int dpiGen__setRefCount(void *ptr, dpiError *error, int increment)
 {
     dpiBaseType *value = (dpiBaseType*) ptr;
     unsigned localRefCount;
+#ifndef DPI_USE_ATOMIC_REF_COUNTS
     sword status;
+#endif
 
-    // if threaded need to protect modification of the refCount with a mutex
+    // if threaded need to protect modification of the refCount
     if (value->env->threaded) {
+#ifdef DPI_USE_ATOMIC_REF_COUNTS
+        localRefCount = DPI_ATOMIC_ADD(&value->refCount, increment);
+#else
         status = OCIThreadMutexAcquire(value->env->handle,
                 error->handle, value->env->mutex);
         if (dpiError__check(error, status, NULL, "acquire mutex") < 0)
@@ -215,6 +319,7 @@ int dpiGen__setRefCount(void *ptr, dpiError *error, int increment)
                 error->handle, value->env->mutex);
         if (dpiError__check(error, status, NULL, "release mutex") < 0)
             return DPI_FAILURE;
+#endif
 
     // otherwise the count can be incremented normally
     } else {
@@ -258,3 +363,39 @@ int dpiGen__startPublicFn(void *ptr, dpiHandleTypeNum typeNum,
     return DPI_SUCCESS;
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiGen__updateMemoryCounter() [INTERNAL]
+//   Adjust one of the memory counters on behalf of the handle. The counters of
+// the environment used by the handle are always adjusted; the counters of the
+// connection that owns the handle (if any) are adjusted as well.
+//-----------------------------------------------------------------------------
+void dpiGen__updateMemoryCounter(void *ptr, dpiMemoryCounterNum counterNum,
+        int64_t delta)
+{
+    dpiBaseType *value = (dpiBaseType*) ptr;
+
+    dpiEnv__updateMemoryStats(value->env, counterNum, delta);
+    if (value->ownerMemoryCounters)
+        DPI_ATOMIC_ADD_64(&value->ownerMemoryCounters[counterNum], delta);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiGen__updateMemoryStats() [INTERNAL]
+//   Adjust the number of live handles of the handle's type and the memory
+// used by them. This is called with an increment of 1 when the handle is
+// allocated and with an increment of -1 at the start of the free routine of
+// each of the handle types, while the environment (and the connection owning
+// the handle, if any) is still known to be valid.
+//-----------------------------------------------------------------------------
+void dpiGen__updateMemoryStats(void *ptr, int increment)
+{
+    dpiBaseType *value = (dpiBaseType*) ptr;
+
+    dpiGen__updateMemoryCounter(value,
+            (dpiMemoryCounterNum) (value->typeDef - dpiAllTypeDefs),
+            increment);
+    dpiGen__updateMemoryCounter(value, DPI_MEMORY_COUNTER_HANDLE_BYTES,
+            increment * (int64_t) value->typeDef->size);
+}
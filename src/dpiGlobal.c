@@ -26,6 +26,21 @@ static OCIError *dpiGlobalErrHandle = NULL;
 static OCIThreadKey *dpiGlobalThreadKey = NULL;
 static dpiErrorBuffer dpiGlobalErrorBuffer;
 
+// the memory allocated for the error buffers of all threads is tracked so that
+// it can be included in the memory statistics
+static int64_t dpiGlobalErrorBufferBytes = 0;
+
+// if supported by the compiler, the error buffer for each thread is also
+// cached in native thread local storage so that the OCI thread key only needs
+// to be consulted on the first call made by each thread
+#ifdef DPI_THREAD_LOCAL
+static DPI_THREAD_LOCAL dpiErrorBuffer *dpiGlobalThreadErrorBuffer = NULL;
+#endif
+
+// forward declarations of internal functions only used in this file
+static void dpiGlobal__freeErrorBuffer(dpiErrorBuffer *buffer);
+static int64_t dpiGlobal__getErrorBufferSize(dpiErrorBuffer *buffer);
+
 
 //-----------------------------------------------------------------------------
 // dpiGlobal__createEnv() [INTERNAL]
@@ -68,7 +83,7 @@ static int dpiGlobal__createEnv(const char *fnName, dpiError *error)
 
     // create thread key
     status = OCIThreadKeyInit(envHandle, error->handle, &threadKey,
-            (OCIThreadKeyDestFunc) free);
+            (OCIThreadKeyDestFunc) dpiGlobal__freeErrorBuffer);
     if (dpiError__check(error, status, NULL, "create global thread key") < 0) {
         OCIHandleFree(error->handle, OCI_HTYPE_ERROR);
         OCIHandleFree(envHandle, OCI_HTYPE_ENV);
@@ -93,21 +108,40 @@ static int dpiGlobal__createEnv(const char *fnName, dpiError *error)
 
 
 //-----------------------------------------------------------------------------
-// dpiGlobal__initError() [INTERNAL]
-//   Get the thread local error structure for use in all other functions. If
-// an error structure cannot be determined for some reason, the global error
-// buffer structure is returned instead.
+// dpiGlobal__freeErrorBuffer() [INTERNAL]
+//   Free the error buffer allocated for a thread, along with any handles
+// cached by the thread. This is called when the thread exits.
 //-----------------------------------------------------------------------------
-int dpiGlobal__initError(const char *fnName, dpiError *error)
+static void dpiGlobal__freeErrorBuffer(dpiErrorBuffer *buffer)
+{
+    dpiHandleCache *cache;
+    uint32_t i, j;
+
+    DPI_ATOMIC_ADD_64(&dpiGlobalErrorBufferBytes,
+            -dpiGlobal__getErrorBufferSize(buffer));
+    if (buffer->handleCaches) {
+        for (i = 0; i < DPI_HTYPE_MAX - DPI_HTYPE_NONE - 1; i++) {
+            cache = &buffer->handleCaches[i];
+            for (j = 0; j < cache->numHandles; j++)
+                dpiUtils__freeMemory(NULL, cache->handles[j]);
+        }
+        dpiUtils__freeMemory(NULL, buffer->handleCaches);
+    }
+    dpiUtils__freeMemory(NULL, buffer);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiGlobal__getErrorBuffer() [INTERNAL]
+//   Look up the error buffer for the current thread using the OCI thread key,
+// creating the global environment and the error buffer if necessary.
+//-----------------------------------------------------------------------------
+static int dpiGlobal__getErrorBuffer(const char *fnName,
+        dpiErrorBuffer **errorBuffer, dpiError *error)
 {
     dpiErrorBuffer *tempErrorBuffer;
     sword status;
 
-    // initialize error buffer output to global error buffer structure; this is
-    // the value that is used if an error takes place before the thread local
-    // error structure can be returned
-    error->buffer = &dpiGlobalErrorBuffer;
-
     // initialize global environment, if necessary
     // this should only ever be done once by the first thread to execute this
     if (!dpiGlobalEnvHandle && dpiGlobal__createEnv(fnName, error) < 0)
@@ -122,21 +156,92 @@ int dpiGlobal__initError(const char *fnName, dpiError *error)
     // if NULL, key has never been set for this thread, allocate new error
     // and set it
     if (!tempErrorBuffer) {
-        tempErrorBuffer = calloc(1, sizeof(dpiErrorBuffer));
+        tempErrorBuffer = dpiUtils__allocateMemory(NULL, 1,
+                sizeof(dpiErrorBuffer), 1);
         if (!tempErrorBuffer)
             return dpiError__set(error, "allocate error buffer",
                     DPI_ERR_NO_MEMORY);
+
+        // the caches of freed handles are optional; if memory cannot be
+        // allocated for them, handles are simply allocated from the heap
+        tempErrorBuffer->handleCaches = dpiUtils__allocateMemory(NULL,
+                DPI_HTYPE_MAX - DPI_HTYPE_NONE - 1, sizeof(dpiHandleCache), 1);
+        DPI_ATOMIC_ADD_64(&dpiGlobalErrorBufferBytes,
+                dpiGlobal__getErrorBufferSize(tempErrorBuffer));
         status = OCIThreadKeySet(dpiGlobalEnvHandle, dpiGlobalErrHandle,
                 dpiGlobalThreadKey, tempErrorBuffer);
         if (status != OCI_SUCCESS) {
-            free(tempErrorBuffer);
+            dpiGlobal__freeErrorBuffer(tempErrorBuffer);
             return dpiError__set(error, "set error buffer", DPI_ERR_TLS_ERROR);
         }
     }
 
+    *errorBuffer = tempErrorBuffer;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiGlobal__getErrorBufferBytes() [INTERNAL]
+//   Return the memory allocated for the error buffers of all threads.
+//-----------------------------------------------------------------------------
+uint64_t dpiGlobal__getErrorBufferBytes(void)
+{
+    int64_t bytes = dpiGlobalErrorBufferBytes;
+
+    return (bytes < 0) ? 0 : (uint64_t) bytes;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiGlobal__getErrorBufferSize() [INTERNAL]
+//   Return the memory allocated for the given error buffer, including the
+// array of caches of freed handles but not the handles retained in them.
+//-----------------------------------------------------------------------------
+static int64_t dpiGlobal__getErrorBufferSize(dpiErrorBuffer *buffer)
+{
+    int64_t size = sizeof(dpiErrorBuffer);
+
+    if (buffer->handleCaches)
+        size += (DPI_HTYPE_MAX - DPI_HTYPE_NONE - 1) * sizeof(dpiHandleCache);
+    return size;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiGlobal__initError() [INTERNAL]
+//   Get the thread local error structure for use in all other functions. If
+// an error structure cannot be determined for some reason, the global error
+// buffer structure is returned instead.
+//-----------------------------------------------------------------------------
+int dpiGlobal__initError(const char *fnName, dpiError *error)
+{
+    dpiErrorBuffer *tempErrorBuffer;
+
+    // initialize error buffer output to global error buffer structure; this is
+    // the value that is used if an error takes place before the thread local
+    // error structure can be returned
+    error->buffer = &dpiGlobalErrorBuffer;
+
+    // use the error buffer cached in native thread local storage, if
+    // available; otherwise, look it up using the OCI thread key
+#ifdef DPI_THREAD_LOCAL
+    tempErrorBuffer = dpiGlobalThreadErrorBuffer;
+    if (!tempErrorBuffer) {
+        if (dpiGlobal__getErrorBuffer(fnName, &tempErrorBuffer, error) < 0)
+            return DPI_FAILURE;
+        dpiGlobalThreadErrorBuffer = tempErrorBuffer;
+    }
+#else
+    if (dpiGlobal__getErrorBuffer(fnName, &tempErrorBuffer, error) < 0)
+        return DPI_FAILURE;
+#endif
+
     // if a function name has been specified, clear error
     // the only time a function name is not specified is for
-    // dpiContext_getError() when the error information is being retrieved
+    // dpiContext_getError() when the error information is being retrieved;
+    // the encoding is not reset here since it is always set when an error is
+    // raised and is not reported when no error has taken place
     if (fnName) {
         tempErrorBuffer->code = 0;
         tempErrorBuffer->offset = 0;
@@ -145,7 +250,6 @@ int dpiGlobal__initError(const char *fnName, dpiError *error)
         tempErrorBuffer->messageLength = 0;
         tempErrorBuffer->fnName = fnName;
         tempErrorBuffer->action = "start";
-        strcpy(tempErrorBuffer->encoding, DPI_CHARSET_NAME_UTF8);
     }
 
     error->buffer = tempErrorBuffer;
@@ -26,6 +26,32 @@
 #include <xa.h>
 #include "dpi.h"
 
+// determine if large variable buffers can be mapped directly and backed by
+// huge pages; this is only supported on Linux and can be disabled by defining
+// DPI_DISABLE_HUGE_PAGES
+#if defined(__linux__) && !defined(DPI_DISABLE_HUGE_PAGES)
+#include <sys/mman.h>
+#if defined(MADV_HUGEPAGE) && defined(MAP_ANONYMOUS)
+#define DPI_USE_HUGE_PAGES
+#endif
+#endif
+
+// define types used for native threads, mutexes and condition variables; these
+// are used by ODPI-C managed pools which need to wait for sessions with a
+// timeout and to create sessions on other threads, neither of which can be
+// done with the OCI thread package
+#ifdef _WIN32
+#include <windows.h>
+typedef CRITICAL_SECTION dpiMutexType;
+typedef CONDITION_VARIABLE dpiConditionType;
+typedef HANDLE dpiThreadHandle;
+#else
+#include <pthread.h>
+typedef pthread_mutex_t dpiMutexType;
+typedef pthread_cond_t dpiConditionType;
+typedef pthread_t dpiThreadHandle;
+#endif
+
 // validate OCI library
 #if !defined(OCI_MAJOR_VERSION) || (OCI_MAJOR_VERSION < 11) || \
         ((OCI_MAJOR_VERSION == 11) && (OCI_MINOR_VERSION < 2))
@@ -57,6 +83,79 @@
     #define DPI_ACTUAL_LENGTH_TYPE      uint16_t
 #endif
 
+// define atomic operations used for adjusting reference counts in threaded
+// mode, for assigning environment identifiers and (on unsigned 32-bit values)
+// by the submission queue of executors; on platforms without atomic
+// operations, reference counts and the submission queue fall back to using a
+// mutex
+#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || \
+        ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 7))))
+    #define DPI_ATOMIC_ADD(ptr, increment) \
+            __atomic_add_fetch(ptr, increment, __ATOMIC_ACQ_REL)
+    #define DPI_ATOMIC_LOAD(ptr) \
+            __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+    #define DPI_ATOMIC_STORE(ptr, value) \
+            __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+    #define DPI_ATOMIC_COMPARE_AND_SWAP(ptr, expected, desired) \
+            __sync_bool_compare_and_swap(ptr, expected, desired)
+    #define DPI_ATOMIC_FENCE() \
+            __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+    #define DPI_ATOMIC_ADD(ptr, increment) \
+            ((unsigned) _InterlockedExchangeAdd((volatile long*) ptr, \
+            increment) + increment)
+    #define DPI_ATOMIC_LOAD(ptr) \
+            (*(volatile unsigned*) (ptr))
+    #define DPI_ATOMIC_STORE(ptr, value) \
+            (*(volatile unsigned*) (ptr) = (value))
+    #define DPI_ATOMIC_COMPARE_AND_SWAP(ptr, expected, desired) \
+            (_InterlockedCompareExchange((volatile long*) (ptr), \
+            (long) (desired), (long) (expected)) == (long) (expected))
+    #define DPI_ATOMIC_FENCE() \
+            MemoryBarrier()
+#endif
+
+// define whether reference counts are adjusted atomically; this can be
+// disabled by defining DPI_DISABLE_ATOMIC_REF_COUNTS, in which case the mutex
+// of the environment is used instead; the other uses of atomic operations are
+// not affected
+#if defined(DPI_ATOMIC_ADD) && !defined(DPI_DISABLE_ATOMIC_REF_COUNTS)
+    #define DPI_USE_ATOMIC_REF_COUNTS
+#endif
+
+// define atomic operation used for maintaining the memory statistics; these
+// are shared by all threads using a context so they are always adjusted
+// atomically, if possible; otherwise the statistics are only approximate when
+// multiple threads are in use
+#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || \
+        ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 7))))
+    #define DPI_ATOMIC_ADD_64(ptr, increment) \
+            __atomic_add_fetch(ptr, increment, __ATOMIC_RELAXED)
+#elif defined(_MSC_VER) && defined(_WIN64)
+    #include <intrin.h>
+    #define DPI_ATOMIC_ADD_64(ptr, increment) \
+            (_InterlockedExchangeAdd64((volatile __int64*) ptr, \
+            increment) + increment)
+#else
+    #define DPI_ATOMIC_ADD_64(ptr, increment) \
+            (*(ptr) += (increment))
+#endif
+
+// define storage class used for native thread local variables, if supported
+// by the compiler; these are used to avoid the OCI thread key lookups made at
+// the start of each public function; they can be disabled by defining
+// DPI_DISABLE_THREAD_LOCAL
+#if !defined(DPI_DISABLE_THREAD_LOCAL)
+    #if defined(_MSC_VER)
+        #define DPI_THREAD_LOCAL                __declspec(thread)
+    #elif defined(__GNUC__) || defined(__clang__)
+        #define DPI_THREAD_LOCAL                __thread
+    #elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+        #define DPI_THREAD_LOCAL                _Thread_local
+    #endif
+#endif
+
 // define context name for ping interval
 #define DPI_CONTEXT_LAST_TIME_USED      "DPI_LAST_TIME_USED"
 
@@ -66,12 +165,48 @@
 // define maximum number of digits possible in an Oracle number
 #define DPI_NUMBER_MAX_DIGITS           40
 
+// define maximum number of numbers converted to doubles by a single call to
+// OCI when the elements of a collection are retrieved in bulk
+#define DPI_NUMBER_BATCH_SIZE           128
+
 // define maximum size in bytes supported by basic string handling
 #define DPI_MAX_BASIC_BUFFER_SIZE       32767
 
+// define size of buffer used for the directory alias and file name of BFILEs
+#define DPI_MAX_BFILE_DIR_ALIAS_LENGTH  30
+#define DPI_MAX_BFILE_FILE_NAME_LENGTH  255
+
+// define chunk size used when streaming BFILEs, which have no chunk size
+#define DPI_LOB_BFILE_CHUNK_SIZE        8192
+
+// define minimum and maximum period (in seconds) between checks of the health
+// of the idle sessions of pools managed by ODPI-C; the minimum is also used as
+// the ping interval when the ping interval of the pool is zero
+#define DPI_POOL_MIN_HEALTH_CHECK_PERIOD    1
+#define DPI_POOL_MAX_HEALTH_CHECK_PERIOD    3600
+
+// define number of sets of statistics counters kept by each pool; threads
+// are spread across the sets so that they rarely update the same counters
+#define DPI_POOL_STATS_NUM_STRIPES      8
+
 // define internal chunk size used for dynamic binding/fetching
 #define DPI_DYNAMIC_BYTES_CHUNK_SIZE    65536
 
+// define alignment of the arrays carved from the block of memory allocated for
+// each variable
+#define DPI_BUFFER_ALIGNMENT            8
+
+// define interval at which pages of mapped variable buffers are touched when
+// they are prefaulted by the thread creating the variable
+#define DPI_PREFAULT_PAGE_SIZE          4096
+
+// define maximum number of freed handles of each type cached by each thread
+#define DPI_MAX_CACHED_HANDLES          32
+
+// define maximum number of OCI error handles (one per environment) cached by
+// each thread in native thread local storage
+#define DPI_MAX_CACHED_ERROR_HANDLES    8
+
 // define well-known character sets
 #define DPI_CHARSET_ID_ASCII            1
 #define DPI_CHARSET_ID_UTF8             873
@@ -136,6 +271,20 @@ typedef enum {
     DPI_ERR_NUMBER_TOO_LARGE,
     DPI_ERR_NUMBER_STRING_TOO_LONG,
     DPI_ERR_NULL_POINTER_PARAMETER,
+    DPI_ERR_INVALID_ALLOCATOR,
+    DPI_ERR_MANAGED_POOL_NOT_HOMOGENEOUS,
+    DPI_ERR_NO_SESSION_AVAILABLE,
+    DPI_ERR_TOO_MANY_POOL_WAITERS,
+    DPI_ERR_POOL_WAIT_TIMEOUT,
+    DPI_ERR_POOL_HAS_BUSY_SESSIONS,
+    DPI_ERR_CREATE_THREAD,
+    DPI_ERR_ASYNC_OPERATION_PENDING,
+    DPI_ERR_EXECUTOR_CLOSED,
+    DPI_ERR_EXECUTOR_QUEUE_FULL,
+    DPI_ERR_SESSION_FIXUP_FAILED,
+    DPI_ERR_LOB_ARRAY_MISMATCH,
+    DPI_ERR_INVALID_ATTR_INDEX,
+    DPI_ERR_ATTR_NOT_FOUND,
     DPI_ERR_MAX
 } dpiErrorNum;
 
@@ -155,13 +304,61 @@ typedef enum {
     DPI_HTYPE_ENQ_OPTIONS,
     DPI_HTYPE_MSG_PROPS,
     DPI_HTYPE_ROWID,
+    DPI_HTYPE_EXECUTOR,
+    DPI_HTYPE_LOB_READER,
+    DPI_HTYPE_LOB_WRITER,
     DPI_HTYPE_MAX
 } dpiHandleTypeNum;
 
+// memory counters maintained by environments and contexts; the first counters
+// (not named here) hold the number of live handles of each type, in the same
+// order as the handle types above
+typedef enum {
+    DPI_MEMORY_COUNTER_HANDLE_BYTES = DPI_HTYPE_MAX - DPI_HTYPE_NONE - 1,
+    DPI_MEMORY_COUNTER_VAR_BUFFER_BYTES,
+    DPI_MEMORY_COUNTER_DYNAMIC_BYTES,
+    DPI_MEMORY_COUNTER_LOB_BUFFER_BYTES,
+    DPI_MEMORY_COUNTER_MAX
+} dpiMemoryCounterNum;
+
+// statistics counters maintained by pools; the acquire time histogram is
+// maintained separately
+typedef enum {
+    DPI_POOL_STAT_NUM_ACQUIRES = 0,
+    DPI_POOL_STAT_ACQUIRE_TIME,
+    DPI_POOL_STAT_NUM_WAITS,
+    DPI_POOL_STAT_NUM_WAIT_TIMEOUTS,
+    DPI_POOL_STAT_NUM_SESSIONS_CREATED,
+    DPI_POOL_STAT_SESSION_CREATE_TIME,
+    DPI_POOL_STAT_NUM_PING_DROPS,
+    DPI_POOL_STAT_NUM_TAG_HITS,
+    DPI_POOL_STAT_NUM_TAG_MISSES,
+    DPI_POOL_STAT_NUM_SESSION_FIXUPS,
+    DPI_POOL_STAT_MAX
+} dpiPoolStatNum;
+
+// operations which can be performed asynchronously using the non-blocking
+// mode of the server handle, as well as streamed LOB reads and writes, which
+// also leave the connection unusable until they have completed; only one can
+// be pending on a connection
+typedef enum {
+    DPI_ASYNC_OP_NONE = 0,
+    DPI_ASYNC_OP_EXECUTE,
+    DPI_ASYNC_OP_FETCH,
+    DPI_ASYNC_OP_COMMIT,
+    DPI_ASYNC_OP_LOB_READ,
+    DPI_ASYNC_OP_LOB_WRITE
+} dpiAsyncOpType;
+
 
 //-----------------------------------------------------------------------------
 // Internal implementation type definitions
 //-----------------------------------------------------------------------------
+typedef struct {
+    uint32_t numHandles;
+    void *handles[DPI_MAX_CACHED_HANDLES];
+} dpiHandleCache;
+
 typedef struct {
     int32_t code;
     uint16_t offset;
@@ -172,8 +369,14 @@ typedef struct {
     char message[DPI_MAX_ERROR_SIZE];
     uint32_t messageLength;
     boolean isRecoverable;
+    dpiHandleCache *handleCaches;
 } dpiErrorBuffer;
 
+typedef struct {
+    unsigned envId;
+    OCIError *handle;
+} dpiErrorHandleCacheEntry;
+
 typedef struct {
     dpiErrorBuffer *buffer;
     OCIError *handle;
@@ -195,9 +398,29 @@ typedef struct {
     uint16_t ncharsetId;
     OCIDateTime *baseDate;
     int threaded;
+    unsigned id;
+    dpiAllocator allocator;
+    int64_t memoryCounters[DPI_MEMORY_COUNTER_MAX];
 } dpiEnv;
 
+typedef struct {
+    int64_t counters[DPI_POOL_STAT_MAX];
+    int64_t acquireTimeBuckets[DPI_POOL_STATS_NUM_BUCKETS];
+} dpiPoolStatsStripe;
+
+typedef struct {
+    uint32_t sequence;
+    dpiExecutorRequest request;
+} dpiExecutorSlot;
+
+typedef struct {
+    dpiExecutor *executor;
+    dpiThreadHandle thread;
+    dpiConn *conn;
+} dpiExecutorWorker;
+
 typedef void (*dpiTypeFreeProc)(void*, dpiError*);
+typedef void (*dpiThreadProc)(void*);
 
 typedef struct {
     const char *name;
@@ -210,7 +433,10 @@ typedef struct {
     const dpiTypeDef *typeDef; \
     uint32_t checkInt; \
     unsigned refCount; \
-    dpiEnv *env;
+    dpiEnv *env; \
+    int64_t *ownerMemoryCounters; \
+    dpiFreeCallback allocatorFree; \
+    void *allocatorContext;
 
 typedef struct {
     dpiType_HEAD
@@ -244,8 +470,80 @@ typedef struct {
     uint32_t pos;
     const char *name;
     uint32_t nameLength;
+    int isAutoCreated;
 } dpiBindVar;
 
+typedef struct {
+    char *sql;
+    uint32_t sqlLength;
+    char *tag;
+    uint32_t tagLength;
+    int scrollable;
+    OCIStmt *handle;
+    uint16_t statementType;
+    int isReturning;
+    uint32_t numQueryVars;
+    dpiVar **queryVars;
+    dpiQueryInfo *queryInfo;
+    uint32_t allocatedBindVars;
+    uint32_t numBindVars;
+    dpiBindVar *bindVars;
+} dpiStmtCacheEntry;
+
+typedef struct {
+    OCILobLocator *locator;
+    const dpiOracleType *type;
+} dpiTempLobCacheEntry;
+
+typedef struct {
+    char *sql;
+    uint32_t sqlLength;
+    uint32_t numQueryVars;
+    size_t queryInfoSize;
+    dpiQueryInfo *queryInfo;
+} dpiQueryInfoCacheEntry;
+
+typedef struct {
+    uint32_t capacity;
+    uint32_t numEntries;
+    dpiQueryInfoCacheEntry *entries;
+} dpiQueryInfoCache;
+
+typedef struct {
+    char *name;
+    uint32_t nameLength;
+    uint32_t hash;
+    dpiObjectType *objType;
+} dpiObjectTypeCacheEntry;
+
+typedef struct {
+    uint32_t capacity;
+    uint32_t numEntries;
+    int invalidated;
+    dpiObjectTypeCacheEntry *entries;
+} dpiObjectTypeCache;
+
+typedef struct {
+    OCISvcCtx *handle;
+    uint64_t lastTimeUsed;
+    char *tag;
+    uint32_t tagLength;
+    uint32_t stmtCacheCapacity;
+    uint32_t numStmtCacheEntries;
+    dpiStmtCacheEntry *stmtCache;
+    uint32_t tempLobCacheCapacity;
+    uint32_t numTempLobCacheEntries;
+    dpiTempLobCacheEntry *tempLobCache;
+    dpiObjectTypeCache *objectTypeCache;
+} dpiPoolSession;
+
+typedef struct dpiPoolWaiter {
+    dpiConditionType condition;
+    dpiPoolSession session;
+    int canCreate;
+    struct dpiPoolWaiter *next;
+} dpiPoolWaiter;
+
 
 //-----------------------------------------------------------------------------
 // External implementation type definitions
@@ -259,6 +557,34 @@ struct dpiPool {
     int pingTimeout;
     int homogeneous;
     int externalAuth;
+    uint32_t queryInfoCacheSize;
+    dpiQueryInfoCache *queryInfoCache;
+    uint32_t objectTypeCacheSize;
+    int managed;
+    int closing;
+    int destroyed;
+    dpiMutexType mutex;
+    dpiPoolGetMode getMode;
+    uint32_t minSessions;
+    uint32_t maxSessions;
+    uint32_t numSessions;
+    uint32_t numIdleSessions;
+    dpiPoolSession *idleSessions;
+    uint32_t idleTimeout;
+    uint32_t waitTimeout;
+    uint32_t maxWaiters;
+    uint32_t numWaiters;
+    dpiPoolWaiter *firstWaiter;
+    dpiPoolWaiter *lastWaiter;
+    int healthCheckThreadStarted;
+    dpiThreadHandle healthCheckThread;
+    dpiConditionType healthCheckCondition;
+    dpiPoolStatsStripe *stats;
+    dpiThreadHandle *warmupThreads;
+    uint32_t numWarmupThreads;
+    dpiConditionType warmupCondition;
+    dpiPoolSessionFixupCallback sessionFixupCallback;
+    void *sessionFixupContext;
 };
 
 struct dpiConn {
@@ -278,12 +604,32 @@ struct dpiConn {
     int externalHandle;
     int dropSession;
     int standalone;
+    uint32_t stmtCacheCapacity;
+    uint32_t hugePageThreshold;
+    int prefaultHugePages;
+    uint32_t numStmtCacheEntries;
+    dpiStmtCacheEntry *stmtCache;
+    dpiQueryInfoCache *queryInfoCache;
+    dpiObjectTypeCache *objectTypeCache;
+    int nonBlocking;
+    int asyncBreak;
+    dpiAsyncOpType asyncOp;
+    dpiStmt *asyncStmt;
+    char *tag;
+    uint32_t tagLength;
+    uint32_t bfileIdleTimeout;
+    dpiLob *openFiles;
+    uint32_t tempLobCacheCapacity;
+    uint32_t numTempLobCacheEntries;
+    dpiTempLobCacheEntry *tempLobCache;
+    int64_t memoryCounters[DPI_MEMORY_COUNTER_MAX];
 };
 
 struct dpiContext {
     uint32_t checkInt;
     unsigned int majorVersion;
     unsigned int minorVersion;
+    int64_t memoryCounters[DPI_MEMORY_COUNTER_MAX];
 };
 
 struct dpiStmt {
@@ -309,6 +655,11 @@ struct dpiStmt {
     int scrollable;
     int isReturning;
     int deleteFromCache;
+    char *sql;
+    uint32_t sqlLength;
+    char *tag;
+    uint32_t tagLength;
+    int queryVarsFromCache;
 };
 
 typedef union {
@@ -377,6 +728,9 @@ struct dpiVar {
     dpiData *externalData;
     dpiOracleData data;
     dpiError *error;
+    char *buffer;
+    size_t bufferSize;
+    int isBufferMapped;
 };
 
 struct dpiLob {
@@ -385,6 +739,32 @@ struct dpiLob {
     const dpiOracleType *type;
     OCILobLocator *locator;
     char *buffer;
+    int isCacheable;
+    int fileOpened;
+    uint64_t fileLastUsed;
+    dpiLob *prevOpenFile;
+    dpiLob *nextOpenFile;
+};
+
+struct dpiLobReader {
+    dpiType_HEAD
+    dpiLob *lob;
+    uint64_t offset;
+    char *buffer;
+    uint32_t bufferSize;
+    int started;
+    int finished;
+};
+
+struct dpiLobWriter {
+    dpiType_HEAD
+    dpiLob *lob;
+    uint64_t offset;
+    char *buffer;
+    uint32_t bufferSize;
+    uint32_t bufferLength;
+    int started;
+    int finished;
 };
 
 struct dpiObjectAttr {
@@ -392,6 +772,7 @@ struct dpiObjectAttr {
     dpiObjectType *belongsToType;
     const char *name;
     uint32_t nameLength;
+    uint32_t nameHash;
     const dpiOracleType *oracleType;
     dpiObjectType *type;
 };
@@ -409,6 +790,7 @@ struct dpiObjectType {
     dpiObjectType *elementType;
     boolean isCollection;
     uint16_t numAttributes;
+    dpiObjectAttr **attributes;
 };
 
 struct dpiObject {
@@ -426,6 +808,22 @@ struct dpiRowid {
     uint16_t bufferLength;
 };
 
+struct dpiExecutor {
+    dpiType_HEAD
+    dpiPool *pool;
+    uint32_t queueMask;
+    dpiExecutorSlot *slots;
+    uint32_t enqueuePos;
+    uint32_t dequeuePos;
+    dpiMutexType mutex;
+    dpiConditionType condition;
+    uint32_t numIdleWorkers;
+    uint32_t numWorkers;
+    dpiExecutorWorker *workers;
+    uint32_t submitState;
+    int closing;
+};
+
 struct dpiSubscr {
     dpiType_HEAD
     dpiConn *conn;
@@ -481,6 +879,8 @@ int dpiData__fromOracleNumberAsDouble(dpiData *data, dpiEnv *env,
         dpiError *error, OCINumber *oracleValue);
 int dpiData__fromOracleNumberAsInteger(dpiData *data, dpiEnv *env,
         dpiError *error, OCINumber *oracleValue);
+int dpiData__fromOracleNumbersAsDouble(dpiData **data,
+        OCINumber **oracleValues, uint32_t numValues, dpiError *error);
 int dpiData__fromOracleNumberAsText(dpiData *data, dpiVar *var,
         uint32_t pos, dpiError *error, OCINumber *oracleValue);
 int dpiData__fromOracleNumberAsUnsignedInteger(dpiData *data, dpiEnv *env,
@@ -511,11 +911,17 @@ int dpiData__toOracleTimestampFromDouble(dpiData *data, dpiEnv *env,
 //-----------------------------------------------------------------------------
 // definition of internal dpiEnv methods
 //-----------------------------------------------------------------------------
+int dpiEnv__acquireMutex(dpiEnv *env, dpiError *error);
+int dpiEnv__allocate(const dpiAllocator *allocator, dpiEnv **env,
+        dpiError *error);
 void dpiEnv__free(dpiEnv *env, dpiError *error);
 int dpiEnv__init(dpiEnv *env, const dpiContext *context,
         const dpiCommonCreateParams *params, dpiError *error);
 int dpiEnv__getEncodingInfo(dpiEnv *env, dpiEncodingInfo *info);
 int dpiEnv__initError(dpiEnv *env, dpiError *error);
+int dpiEnv__releaseMutex(dpiEnv *env, dpiError *error);
+void dpiEnv__updateMemoryStats(dpiEnv *env, dpiMemoryCounterNum counterNum,
+        int64_t delta);
 
 
 //-----------------------------------------------------------------------------
@@ -536,8 +942,13 @@ int dpiGen__allocate(dpiHandleTypeNum typeNum, dpiEnv *env, void **handle,
         dpiError *error);
 int dpiGen__checkHandle(void *ptr, dpiHandleTypeNum typeNum,
         const char *context, dpiError *error);
+void dpiGen__free(void *ptr, dpiError *error);
 int dpiGen__release(void *ptr, dpiHandleTypeNum typeNum, const char *fnName);
+void dpiGen__setMemoryOwner(void *ptr, int64_t *memoryCounters);
 int dpiGen__setRefCount(void *ptr, dpiError *error, int increment);
+void dpiGen__updateMemoryCounter(void *ptr, dpiMemoryCounterNum counterNum,
+        int64_t delta);
+void dpiGen__updateMemoryStats(void *ptr, int increment);
 int dpiGen__startPublicFn(void *ptr, dpiHandleTypeNum typeNum,
         const char *context, dpiError *error);
 
@@ -545,6 +956,7 @@ int dpiGen__startPublicFn(void *ptr, dpiHandleTypeNum typeNum,
 //-----------------------------------------------------------------------------
 // definition of internal dpiGlobal methods
 //-----------------------------------------------------------------------------
+uint64_t dpiGlobal__getErrorBufferBytes(void);
 int dpiGlobal__initError(const char *fnName, dpiError *error);
 int dpiGlobal__lookupCharSet(const char *name, uint16_t *charsetId,
         dpiError *error);
@@ -566,14 +978,23 @@ const dpiOracleType *dpiOracleType__getFromObjectTypeInfo(OCITypeCode typeCode,
 //-----------------------------------------------------------------------------
 // definition of internal dpiConn methods
 //-----------------------------------------------------------------------------
+void dpiConn__attachCaches(dpiConn *conn, dpiPoolSession *session,
+        dpiError *error);
+void dpiConn__cancelAsync(dpiConn *conn, dpiError *error);
+void dpiConn__finishAsync(dpiConn *conn, dpiAsyncOpType op, dpiStmt *stmt,
+        sword status, int *isComplete, dpiError *error);
 void dpiConn__free(dpiConn *conn, dpiError *error);
 int dpiConn__get(dpiConn *conn, const char *userName, uint32_t userNameLength,
         const char *password, uint32_t passwordLength,
         const char *connectString, uint32_t connectStringLength,
         dpiConnCreateParams *createParams, dpiPool *pool, dpiError *error);
+int dpiConn__getHandles(dpiConn *conn, dpiError *error);
 int dpiConn__setAttributesFromCommonCreateParams(const dpiContext *context,
         void *handle, uint32_t handleType, const dpiCommonCreateParams *params,
         dpiError *error);
+int dpiConn__setNonBlocking(dpiConn *conn, int nonBlocking, dpiError *error);
+int dpiConn__startAsync(dpiConn *conn, dpiAsyncOpType op, dpiStmt *stmt,
+        int *isPending, dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -583,6 +1004,11 @@ int dpiPool__acquireConnection(dpiPool *pool, const char *userName,
         uint32_t userNameLength, const char *password, uint32_t passwordLength,
         dpiConnCreateParams *params, dpiConn **conn, dpiError *error);
 void dpiPool__free(dpiPool *pool, dpiError *error);
+int dpiPool__isDestroyed(dpiPool *pool);
+int dpiPool__releaseSession(dpiPool *pool, dpiPoolSession *session,
+        int drop, dpiError *error);
+void dpiPool__updateStats(dpiPool *pool, dpiPoolStatNum statNum,
+        int64_t delta);
 
 
 //-----------------------------------------------------------------------------
@@ -590,10 +1016,18 @@ void dpiPool__free(dpiPool *pool, dpiError *error);
 //-----------------------------------------------------------------------------
 int dpiStmt__allocate(dpiConn *conn, int scrollable, dpiStmt **stmt,
         dpiError *error);
+int dpiStmt__createQueryInfoCache(dpiEnv *env, uint32_t capacity,
+        dpiQueryInfoCache **cache, dpiError *error);
 void dpiStmt__free(dpiStmt *stmt, dpiError *error);
+void dpiStmt__freeQueryInfoCache(dpiEnv *env, dpiQueryInfoCache *cache);
 int dpiStmt__init(dpiStmt *stmt, dpiError *error);
 int dpiStmt__prepare(dpiStmt *stmt, const char *sql, uint32_t sqlLength,
         const char *tag, uint32_t tagLength, dpiError *error);
+int dpiStmt__prepareFromCache(dpiStmt *stmt, const char *sql,
+        uint32_t sqlLength, const char *tag, uint32_t tagLength,
+        dpiError *error);
+void dpiStmt__releaseCacheEntry(dpiEnv *env, dpiStmtCacheEntry *entry,
+        dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -616,6 +1050,9 @@ int32_t dpiVar__inBindCallback(dpiVar *var, OCIBind *bindp, uint32_t iter,
         void **indpp);
 int dpiVar__getValue(dpiVar *var, uint32_t pos, dpiData *data,
         dpiError *error);
+int dpiVar__setBytesFromLobs(dpiVar *var, uint32_t numRows,
+        dpiError *error);
+void dpiVar__setConnection(dpiVar *var, dpiConn *conn);
 int dpiVar__setValue(dpiVar *var, uint32_t pos, dpiData *data,
         dpiError *error);
 int32_t dpiVar__outBindCallback(dpiVar *var, OCIBind *bindp, uint32_t iter,
@@ -628,12 +1065,25 @@ int32_t dpiVar__outBindCallback(dpiVar *var, OCIBind *bindp, uint32_t iter,
 //-----------------------------------------------------------------------------
 int dpiLob__allocate(dpiConn *conn, const dpiOracleType *type, dpiLob **lob,
         dpiError *error);
+int dpiLob__allocateTemporary(dpiConn *conn, const dpiOracleType *type,
+        dpiLob **lob, dpiError *error);
+int dpiLob__closeFile(dpiLob *lob, dpiError *error);
+void dpiLob__closeFiles(dpiConn *conn, dpiLob *excludeLob,
+        uint64_t maxIdleTime, uint64_t now, dpiError *error);
 int dpiLob__createTemporary(dpiLob *lob, dpiError *error);
 void dpiLob__free(dpiLob *lob, dpiError *error);
+int dpiLob__getStreamBufferSize(dpiLob *lob, uint32_t requestedSize,
+        uint32_t *bufferSize, dpiError *error);
+int dpiLob__openFile(dpiLob *lob, dpiError *error);
 int dpiLob__readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
         char *value, uint64_t *valueLength, dpiError *error);
+int dpiLob__readMany(dpiLob **lobs, uint32_t numLobs, uint64_t offset,
+        const uint64_t *amounts, char **values, uint64_t *valueLengths,
+        dpiError *error);
 int dpiLob__setFromBytes(dpiLob *lob, const char *value, uint64_t valueLength,
         dpiError *error);
+int dpiLob__writeBytes(dpiLob *lob, uint64_t offset, const char *value,
+        uint64_t valueLength, dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -649,7 +1099,17 @@ void dpiObject__free(dpiObject *obj, dpiError *error);
 //-----------------------------------------------------------------------------
 int dpiObjectType__allocate(dpiConn *conn, OCIParam *param,
         uint32_t nameAttribute, dpiObjectType **objType, dpiError *error);
+void dpiObjectType__cache(dpiConn *conn, const char *name,
+        uint32_t nameLength, dpiObjectType *objType, dpiError *error);
+int dpiObjectType__copy(dpiObjectType *source, dpiObjectType **objType,
+        dpiError *error);
+int dpiObjectType__createCache(dpiEnv *env, uint32_t capacity,
+        dpiObjectTypeCache **cache, dpiError *error);
 void dpiObjectType__free(dpiObjectType *objType, dpiError *error);
+void dpiObjectType__freeCache(dpiEnv *env, dpiObjectTypeCache *cache,
+        dpiError *error);
+int dpiObjectType__lookup(dpiConn *conn, const char *name,
+        uint32_t nameLength, dpiObjectType **objType, dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -658,6 +1118,8 @@ void dpiObjectType__free(dpiObjectType *objType, dpiError *error);
 int dpiObjectAttr__allocate(dpiObjectType *objType, OCIParam *param,
         dpiObjectAttr **attr, dpiError *error);
 int dpiObjectAttr__check(dpiObjectAttr *attr, dpiError *error);
+int dpiObjectAttr__copy(dpiObjectAttr *source, dpiObjectType *objType,
+        dpiObjectAttr **attr, dpiError *error);
 void dpiObjectAttr__free(dpiObjectAttr *attr, dpiError *error);
 
 
@@ -699,13 +1161,40 @@ int dpiMsgProps__create(dpiMsgProps *props, dpiConn *conn, dpiError *error);
 void dpiMsgProps__free(dpiMsgProps *props, dpiError *error);
 
 
+//-----------------------------------------------------------------------------
+// definition of internal dpiExecutor methods
+//-----------------------------------------------------------------------------
+void dpiExecutor__free(dpiExecutor *executor, dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// definition of internal dpiLobReader methods
+//-----------------------------------------------------------------------------
+int dpiLobReader__create(dpiLobReader *reader, dpiLob *lob, uint64_t offset,
+        uint32_t bufferSize, dpiError *error);
+void dpiLobReader__free(dpiLobReader *reader, dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// definition of internal dpiLobWriter methods
+//-----------------------------------------------------------------------------
+int dpiLobWriter__create(dpiLobWriter *writer, dpiLob *lob, uint64_t offset,
+        uint32_t bufferSize, dpiError *error);
+void dpiLobWriter__free(dpiLobWriter *writer, dpiError *error);
+
+
 //-----------------------------------------------------------------------------
 // definition of internal dpiUtils methods
 //-----------------------------------------------------------------------------
+void *dpiUtils__allocateMemory(dpiEnv *env, size_t numMembers,
+        size_t memberSize, int clearMemory);
 void dpiUtils__clearMemory(void *ptr, size_t length);
-int dpiUtils__getAttrStringWithDup(dpiError *error, const char *context,
-        const void *ociHandle, uint32_t ociHandleType, uint32_t ociAttribute,
-        const char **value, uint32_t *valueLength);
+void dpiUtils__freeMemory(dpiEnv *env, void *ptr);
+int dpiUtils__getAttrStringWithDup(dpiEnv *env, dpiError *error,
+        const char *context, const void *ociHandle, uint32_t ociHandleType,
+        uint32_t ociAttribute, const char **value, uint32_t *valueLength);
+void dpiUtils__getMemoryStats(const int64_t *counters,
+        dpiMemoryStats *stats);
 int dpiUtils__parseNumberString(const char *value, uint32_t valueLength,
         uint16_t charsetId, int *isNegative, int16_t *decimalPointIndex,
         uint8_t *numDigits, uint8_t *digits, dpiError *error);
@@ -713,5 +1202,24 @@ int dpiUtils__parseOracleNumber(OCINumber *oracleValue, int *isNegative,
         int16_t *decimalPointIndex, uint8_t *numDigits, uint8_t *digits,
         dpiError *error);
 
+
+//-----------------------------------------------------------------------------
+// definition of internal dpiThread methods
+//-----------------------------------------------------------------------------
+void dpiThread__acquireMutex(dpiMutexType *mutex);
+void dpiThread__broadcastCondition(dpiConditionType *condition);
+int dpiThread__create(dpiEnv *env, dpiThreadHandle *thread,
+        dpiThreadProc proc, void *arg);
+void dpiThread__destroyCondition(dpiConditionType *condition);
+void dpiThread__destroyMutex(dpiMutexType *mutex);
+uint64_t dpiThread__getMonotonicTime(void);
+void dpiThread__initCondition(dpiConditionType *condition);
+void dpiThread__initMutex(dpiMutexType *mutex);
+void dpiThread__join(dpiThreadHandle thread);
+void dpiThread__releaseMutex(dpiMutexType *mutex);
+void dpiThread__signalCondition(dpiConditionType *condition);
+void dpiThread__waitCondition(dpiConditionType *condition,
+        dpiMutexType *mutex, uint32_t timeout);
+
 #endif
 
@@ -17,8 +17,10 @@
 #include "dpiImpl.h"
 
 // forward declarations of internal functions only used in this file
-static int dpiLob__writeBytes(dpiLob *lob, uint64_t offset, const char *value,
-        uint64_t valueLength, dpiError *error);
+static int dpiLob__transferMany(dpiLob **lobs, uint32_t numLobs,
+        uint64_t offset, const uint64_t *amounts, void **values,
+        uint64_t *valueLengths, int isWrite, dpiError *error);
+static void dpiLob__unlinkFile(dpiLob *lob);
 
 
 //-----------------------------------------------------------------------------
@@ -34,6 +36,7 @@ int dpiLob__allocate(dpiConn *conn, const dpiOracleType *type, dpiLob **lob,
     if (dpiGen__allocate(DPI_HTYPE_LOB, conn->env, (void**) &tempLob,
             error) < 0)
         return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempLob, conn->memoryCounters);
     if (dpiGen__setRefCount(conn, error, 1) < 0) {
         dpiLob__free(tempLob, error);
         return DPI_FAILURE;
@@ -52,6 +55,100 @@ int dpiLob__allocate(dpiConn *conn, const dpiOracleType *type, dpiLob **lob,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob__allocateTemporary() [INTERNAL]
+//   Allocate a LOB object for a temporary LOB. If the connection has retained
+// a temporary LOB of the same type for reuse, it is trimmed and used instead
+// of creating a new one. Either way the LOB is empty when it is returned.
+//-----------------------------------------------------------------------------
+int dpiLob__allocateTemporary(dpiConn *conn, const dpiOracleType *type,
+        dpiLob **lob, dpiError *error)
+{
+    OCILobLocator *locator = NULL;
+    dpiTempLobCacheEntry *entry;
+    dpiLob *tempLob;
+    sword status;
+    uint32_t i;
+
+    // allocate the LOB object
+    if (dpiLob__allocate(conn, type, &tempLob, error) < 0)
+        return DPI_FAILURE;
+
+    // search the cache for a temporary LOB of the same type; the last entry
+    // takes the place of the one that is removed
+    if (conn->numTempLobCacheEntries > 0) {
+        if (dpiEnv__acquireMutex(conn->env, error) < 0) {
+            dpiLob__free(tempLob, error);
+            return DPI_FAILURE;
+        }
+        for (i = conn->numTempLobCacheEntries; i > 0; i--) {
+            entry = &conn->tempLobCache[i - 1];
+            if (entry->type == type) {
+                locator = entry->locator;
+                *entry = conn->tempLobCache[--conn->numTempLobCacheEntries];
+                break;
+            }
+        }
+        dpiEnv__releaseMutex(conn->env, error);
+    }
+
+    // reuse the temporary LOB, if one was found; otherwise, create one
+    if (locator) {
+        OCIDescriptorFree(tempLob->locator, OCI_DTYPE_LOB);
+        tempLob->locator = locator;
+        tempLob->isCacheable = 1;
+        status = OCILobTrim2(conn->handle, error->handle, locator, 0);
+        if (dpiError__check(error, status, conn, "trim temporary LOB") < 0) {
+            dpiLob__free(tempLob, error);
+            return DPI_FAILURE;
+        }
+    } else if (dpiLob__createTemporary(tempLob, error) < 0) {
+        dpiLob__free(tempLob, error);
+        return DPI_FAILURE;
+    }
+
+    *lob = tempLob;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__cacheTemporary() [INTERNAL]
+//   Retain the temporary LOB in the connection's temporary LOB cache for
+// reuse, if the cache is enabled and is not full. Only temporary LOBs created
+// by ODPI-C are retained; temporary LOBs returned by the database (such as
+// those fetched from queries) are always freed. The cache is allocated
+// when the first temporary LOB is added to it. Returns 1 if the temporary LOB
+// was retained, in which case the locator no longer belongs to the LOB, or 0
+// if it was not.
+//-----------------------------------------------------------------------------
+static int dpiLob__cacheTemporary(dpiLob *lob, dpiError *error)
+{
+    dpiConn *conn = lob->conn;
+    dpiTempLobCacheEntry *entry;
+    int cached = 0;
+
+    if (!lob->isCacheable || conn->tempLobCacheCapacity == 0 ||
+            !conn->handle)
+        return 0;
+    if (dpiEnv__acquireMutex(conn->env, error) < 0)
+        return 0;
+    if (!conn->tempLobCache)
+        conn->tempLobCache = dpiUtils__allocateMemory(conn->env,
+                conn->tempLobCacheCapacity, sizeof(dpiTempLobCacheEntry), 0);
+    if (conn->tempLobCache &&
+            conn->numTempLobCacheEntries < conn->tempLobCacheCapacity) {
+        entry = &conn->tempLobCache[conn->numTempLobCacheEntries++];
+        entry->locator = lob->locator;
+        entry->type = lob->type;
+        lob->locator = NULL;
+        cached = 1;
+    }
+    dpiEnv__releaseMutex(conn->env, error);
+    return cached;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob__check() [INTERNAL]
 //   Check that the LOB is valid and get an error handle for subsequent calls.
@@ -64,6 +161,40 @@ int dpiLob__check(dpiLob *lob, const char *fnName, dpiError *error)
         return dpiError__set(error, "check closed", DPI_ERR_LOB_CLOSED);
     if (!lob->conn->handle)
         return dpiError__set(error, "check connection", DPI_ERR_NOT_CONNECTED);
+    if (lob->conn->asyncOp != DPI_ASYNC_OP_NONE)
+        return dpiError__set(error, "check async operation",
+                DPI_ERR_ASYNC_OPERATION_PENDING);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__checkMany() [INTERNAL]
+//   Check that all of the LOBs are valid, belong to the same connection and
+// are of the same type, as required for transferring data to or from all of
+// them in a single round trip. An error handle is acquired for subsequent
+// calls using the first LOB.
+//-----------------------------------------------------------------------------
+static int dpiLob__checkMany(dpiLob **lobs, uint32_t numLobs,
+        const char *fnName, dpiError *error)
+{
+    uint32_t i;
+
+    if (!lobs)
+        return dpiGen__startPublicFn(NULL, DPI_HTYPE_LOB, fnName, error);
+    if (dpiLob__check(lobs[0], fnName, error) < 0)
+        return DPI_FAILURE;
+    for (i = 1; i < numLobs; i++) {
+        if (dpiGen__checkHandle(lobs[i], DPI_HTYPE_LOB, "check LOB",
+                error) < 0)
+            return DPI_FAILURE;
+        if (!lobs[i]->locator)
+            return dpiError__set(error, "check closed", DPI_ERR_LOB_CLOSED);
+        if (lobs[i]->conn != lobs[0]->conn ||
+                lobs[i]->type != lobs[0]->type)
+            return dpiError__set(error, "check LOBs",
+                    DPI_ERR_LOB_ARRAY_MISMATCH);
+    }
     return DPI_SUCCESS;
 }
 
@@ -78,38 +209,96 @@ static int dpiLob__close(dpiLob *lob, int propagateErrors, dpiError *error)
     sword status;
 
     if (lob->locator) {
+        if (lob->fileOpened && dpiLob__closeFile(lob, error) < 0 &&
+                propagateErrors)
+            return DPI_FAILURE;
         status = OCILobIsTemporary(lob->conn->env->handle, error->handle,
                 lob->locator, &isTemporary);
         if (propagateErrors && dpiError__check(error, status, lob->conn,
                 "check is temporary") < 0)
             return DPI_FAILURE;
-        if (isTemporary) {
+        if (isTemporary && !dpiLob__cacheTemporary(lob, error)) {
             status = OCILobFreeTemporary(lob->conn->handle, error->handle,
                     lob->locator);
             if (propagateErrors && dpiError__check(error, status, lob->conn,
                     "free temporary LOB") < 0)
                 return DPI_FAILURE;
         }
-        OCIDescriptorFree(lob->locator, OCI_DTYPE_LOB);
-        lob->locator = NULL;
+        if (lob->locator) {
+            OCIDescriptorFree(lob->locator, OCI_DTYPE_LOB);
+            lob->locator = NULL;
+        }
+    }
+    if (lob->buffer) {
+        dpiUtils__freeMemory(lob->env, lob->buffer);
+        dpiGen__updateMemoryCounter(lob,
+                DPI_MEMORY_COUNTER_LOB_BUFFER_BYTES,
+                -(DPI_MAX_BFILE_DIR_ALIAS_LENGTH +
+                DPI_MAX_BFILE_FILE_NAME_LENGTH));
+        lob->buffer = NULL;
     }
     if (lob->conn) {
         dpiGen__setRefCount(lob->conn, error, -1);
         lob->conn = NULL;
     }
-    if (lob->buffer) {
-        free(lob->buffer);
-        lob->buffer = NULL;
-    }
 
     return DPI_SUCCESS;
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob__closeFile() [INTERNAL]
+//   Close the file of a BFILE that was opened by ODPI-C and remove the LOB
+// from the list of files kept open by the connection. The mutex is held while
+// the file is closed so that another thread closing the connection cannot
+// close the same file.
+//-----------------------------------------------------------------------------
+int dpiLob__closeFile(dpiLob *lob, dpiError *error)
+{
+    sword status = OCI_SUCCESS;
+
+    if (dpiEnv__acquireMutex(lob->env, error) < 0)
+        return DPI_FAILURE;
+    if (lob->fileOpened) {
+        dpiLob__unlinkFile(lob);
+        status = OCILobClose(lob->conn->handle, error->handle, lob->locator);
+    }
+    dpiEnv__releaseMutex(lob->env, error);
+    return dpiError__check(error, status, lob->conn, "close LOB");
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__closeFiles() [INTERNAL]
+//   Close the files kept open by the connection that have not been used for at
+// least the given time (in microseconds); a time of zero closes all of them.
+// The LOB being read, if any, is excluded. Errors are ignored since the files
+// are closed when the session ends in any case.
+//-----------------------------------------------------------------------------
+void dpiLob__closeFiles(dpiConn *conn, dpiLob *excludeLob,
+        uint64_t maxIdleTime, uint64_t now, dpiError *error)
+{
+    dpiLob *lob, *nextLob;
+
+    if (dpiEnv__acquireMutex(conn->env, error) < 0)
+        return;
+    for (lob = conn->openFiles; lob; lob = nextLob) {
+        nextLob = lob->nextOpenFile;
+        if (lob == excludeLob || (maxIdleTime > 0 &&
+                now - lob->fileLastUsed < maxIdleTime))
+            continue;
+        dpiLob__unlinkFile(lob);
+        OCILobClose(conn->handle, error->handle, lob->locator);
+    }
+    dpiEnv__releaseMutex(conn->env, error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob__createTemporary() [INTERNAL]
 //   Create a temporary LOB locator (when locator has not been fetched from the
-// database).
+// database). Temporary LOBs created this way may be retained by the
+// connection for reuse when they are released.
 //-----------------------------------------------------------------------------
 int dpiLob__createTemporary(dpiLob *lob, dpiError *error)
 {
@@ -122,7 +311,10 @@ int dpiLob__createTemporary(dpiLob *lob, dpiError *error)
     status = OCILobCreateTemporary(lob->conn->handle, error->handle,
             lob->locator, OCI_DEFAULT, lob->type->charsetForm, lobType,
             FALSE, OCI_DURATION_SESSION);
-    return dpiError__check(error, status, lob->conn, "create temporary LOB");
+    if (dpiError__check(error, status, lob->conn, "create temporary LOB") < 0)
+        return DPI_FAILURE;
+    lob->isCacheable = 1;
+    return DPI_SUCCESS;
 }
 
 
@@ -132,8 +324,108 @@ int dpiLob__createTemporary(dpiLob *lob, dpiError *error)
 //-----------------------------------------------------------------------------
 void dpiLob__free(dpiLob *lob, dpiError *error)
 {
+    dpiGen__updateMemoryStats(lob, -1);
     dpiLob__close(lob, 0, error);
-    free(lob);
+    dpiGen__free(lob, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__getStreamBufferSize() [INTERNAL]
+//   Return the size of the buffer to use for streaming the LOB to or from the
+// database. The requested size is rounded up to a multiple of the chunk size
+// of the LOB so that each piece transferred consists of whole chunks; if no
+// size was requested, a default number of chunks is used.
+//-----------------------------------------------------------------------------
+int dpiLob__getStreamBufferSize(dpiLob *lob, uint32_t requestedSize,
+        uint32_t *bufferSize, dpiError *error)
+{
+    uint32_t chunkSize;
+    sword status;
+
+    // determine the chunk size; BFILEs do not have one
+    if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE)
+        chunkSize = DPI_LOB_BFILE_CHUNK_SIZE;
+    else {
+        status = OCILobGetChunkSize(lob->conn->handle, error->handle,
+                lob->locator, &chunkSize);
+        if (dpiError__check(error, status, lob->conn, "get chunk size") < 0)
+            return DPI_FAILURE;
+        if (chunkSize == 0)
+            chunkSize = DPI_LOB_BFILE_CHUNK_SIZE;
+    }
+
+    // round the requested size to a multiple of the chunk size
+    if (requestedSize == 0)
+        *bufferSize = chunkSize * DPI_DEFAULT_LOB_STREAM_CHUNKS;
+    else if (requestedSize % chunkSize == 0)
+        *bufferSize = requestedSize;
+    else if (requestedSize > UINT32_MAX - chunkSize)
+        *bufferSize = requestedSize - requestedSize % chunkSize;
+    else *bufferSize = requestedSize + chunkSize - requestedSize % chunkSize;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__openFile() [INTERNAL]
+//   Open the file of a BFILE for reading, if needed. Files opened by ODPI-C
+// are kept open until the LOB is closed, the connection is closed or the file
+// has been idle for longer than the BFILE idle timeout of the connection,
+// which is checked whenever another file is opened; this avoids opening and
+// closing the file for each read. Files opened by the application are left
+// alone.
+//-----------------------------------------------------------------------------
+int dpiLob__openFile(dpiLob *lob, dpiError *error)
+{
+    uint64_t now = dpiThread__getMonotonicTime();
+    dpiConn *conn = lob->conn;
+    boolean isOpen;
+    sword status;
+
+    // nothing to do if the file is already kept open
+    if (lob->fileOpened) {
+        lob->fileLastUsed = now;
+        return DPI_SUCCESS;
+    }
+
+    // close any other files that have been idle for too long
+    if (conn->openFiles && conn->bfileIdleTimeout > 0)
+        dpiLob__closeFiles(conn, lob,
+                (uint64_t) conn->bfileIdleTimeout * 1000000, now, error);
+
+    // check to see if the file has been opened by the application
+    status = OCILobIsOpen(conn->handle, error->handle, lob->locator, &isOpen);
+    if (dpiError__check(error, status, conn, "check LOB open") < 0)
+        return DPI_FAILURE;
+    if (isOpen)
+        return DPI_SUCCESS;
+
+    // open the file; if the maximum number of open files for the session has
+    // been reached (ORA-22290), close the other files kept open and try again
+    status = OCILobOpen(conn->handle, error->handle, lob->locator,
+            OCI_FILE_READONLY);
+    if (dpiError__check(error, status, conn, "open LOB") < 0) {
+        if (error->buffer->code != 22290 || !conn->openFiles)
+            return DPI_FAILURE;
+        dpiLob__closeFiles(conn, lob, 0, now, error);
+        status = OCILobOpen(conn->handle, error->handle, lob->locator,
+                OCI_FILE_READONLY);
+        if (dpiError__check(error, status, conn, "open LOB") < 0)
+            return DPI_FAILURE;
+    }
+
+    // add the LOB to the list of files kept open by the connection
+    if (dpiEnv__acquireMutex(conn->env, error) < 0)
+        return DPI_FAILURE;
+    lob->fileOpened = 1;
+    lob->fileLastUsed = now;
+    lob->prevOpenFile = NULL;
+    lob->nextOpenFile = conn->openFiles;
+    if (conn->openFiles)
+        conn->openFiles->prevOpenFile = lob;
+    conn->openFiles = lob;
+    return dpiEnv__releaseMutex(conn->env, error);
 }
 
 
@@ -146,7 +438,6 @@ int dpiLob__readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
 {
     uint64_t lengthInBytes = 0, lengthInChars = 0;
     uint16_t charsetId;
-    boolean isOpen;
     sword status;
 
     // amount is in characters for character LOBs and bytes for binary LOBs
@@ -154,19 +445,10 @@ int dpiLob__readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
         lengthInChars = amount;
     else lengthInBytes = amount;
 
-    // for files, open the file if needed
-    if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE) {
-        status = OCILobIsOpen(lob->conn->handle, error->handle, lob->locator,
-                &isOpen);
-        if (dpiError__check(error, status, lob->conn, "check LOB open") < 0)
-            return DPI_FAILURE;
-        if (!isOpen) {
-            status = OCILobOpen(lob->conn->handle, error->handle, lob->locator,
-                    OCI_FILE_READONLY);
-            if (dpiError__check(error, status, lob->conn, "open LOB") < 0)
-                return DPI_FAILURE;
-        }
-    }
+    // for files, open the file if needed; it is kept open for further reads
+    if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE &&
+            dpiLob__openFile(lob, error) < 0)
+        return DPI_FAILURE;
 
     // read the bytes from the LOB
     charsetId = (lob->type->charsetForm == SQLCS_NCHAR) ?
@@ -179,17 +461,33 @@ int dpiLob__readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
         return DPI_FAILURE;
     *valueLength = lengthInBytes;
 
-    // if file was opened in this routine, close it again
-    if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE && !isOpen) {
-        status = OCILobClose(lob->conn->handle, error->handle, lob->locator);
-        if (dpiError__check(error, status, lob->conn, "close LOB") < 0)
-            return DPI_FAILURE;
-    }
-
     return DPI_SUCCESS;
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob__readMany() [INTERNAL]
+//   Read from many LOBs in a single round trip. The LOBs are assumed to have
+// been validated already. For files, each file is opened first if needed and
+// kept open, as is done by dpiLob__readBytes().
+//-----------------------------------------------------------------------------
+int dpiLob__readMany(dpiLob **lobs, uint32_t numLobs, uint64_t offset,
+        const uint64_t *amounts, char **values, uint64_t *valueLengths,
+        dpiError *error)
+{
+    uint32_t i;
+
+    if (lobs[0]->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE) {
+        for (i = 0; i < numLobs; i++) {
+            if (dpiLob__openFile(lobs[i], error) < 0)
+                return DPI_FAILURE;
+        }
+    }
+    return dpiLob__transferMany(lobs, numLobs, offset, amounts,
+            (void**) values, valueLengths, 0, error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob__setFromBytes() [INTERNAL]
 //   Clear the LOB completely and then write the specified bytes to it.
@@ -210,11 +508,104 @@ int dpiLob__setFromBytes(dpiLob *lob, const char *value, uint64_t valueLength,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob__transferMany() [INTERNAL]
+//   Read from or write to many LOBs in a single round trip using the array
+// LOB functions of OCI. The LOBs are assumed to belong to the same connection
+// and to be of the same type. For reads, the amounts are in characters for
+// character LOBs and in bytes for binary LOBs and the lengths are the sizes of
+// the buffers on input and the number of bytes read on output. For writes,
+// the amounts are not used and the lengths, which are not modified, are the
+// number of bytes to write.
+//-----------------------------------------------------------------------------
+static int dpiLob__transferMany(dpiLob **lobs, uint32_t numLobs,
+        uint64_t offset, const uint64_t *amounts, void **values,
+        uint64_t *valueLengths, int isWrite, dpiError *error)
+{
+    uint64_t *byteAmounts, *charAmounts, *offsets, *bufferLengths;
+    OCILobLocator **locators;
+    dpiLob *lob = lobs[0];
+    uint32_t numIters, i;
+    uint16_t charsetId;
+    sword status;
+
+    // allocate the arrays required by OCI
+    byteAmounts = dpiUtils__allocateMemory(lob->env, numLobs,
+            4 * sizeof(uint64_t) + sizeof(OCILobLocator*), 0);
+    if (!byteAmounts)
+        return dpiError__set(error, "allocate arrays", DPI_ERR_NO_MEMORY);
+    charAmounts = byteAmounts + numLobs;
+    offsets = charAmounts + numLobs;
+    bufferLengths = offsets + numLobs;
+    locators = (OCILobLocator**) (bufferLengths + numLobs);
+
+    // populate the arrays; amounts are in characters for character LOBs and
+    // bytes for binary LOBs when reading but always in bytes when writing
+    for (i = 0; i < numLobs; i++) {
+        locators[i] = lobs[i]->locator;
+        offsets[i] = offset;
+        bufferLengths[i] = valueLengths[i];
+        byteAmounts[i] = 0;
+        charAmounts[i] = 0;
+        if (isWrite)
+            byteAmounts[i] = valueLengths[i];
+        else if (lob->type->isCharacterData)
+            charAmounts[i] = amounts[i];
+        else byteAmounts[i] = amounts[i];
+    }
+
+    // perform the transfer
+    numIters = numLobs;
+    charsetId = (lob->type->charsetForm == SQLCS_NCHAR) ?
+            lob->conn->env->ncharsetId : lob->conn->env->charsetId;
+    if (isWrite)
+        status = OCILobArrayWrite(lob->conn->handle, error->handle,
+                &numIters, locators, (ub8*) byteAmounts, (ub8*) charAmounts,
+                (ub8*) offsets, values, (ub8*) bufferLengths, OCI_ONE_PIECE,
+                NULL, NULL, charsetId, lob->type->charsetForm);
+    else status = OCILobArrayRead(lob->conn->handle, error->handle,
+                &numIters, locators, (ub8*) byteAmounts, (ub8*) charAmounts,
+                (ub8*) offsets, values, (ub8*) bufferLengths, OCI_ONE_PIECE,
+                NULL, NULL, charsetId, lob->type->charsetForm);
+    if (dpiError__check(error, status, lob->conn,
+            (isWrite) ? "write LOBs" : "read from LOBs") < 0) {
+        dpiUtils__freeMemory(lob->env, byteAmounts);
+        return DPI_FAILURE;
+    }
+
+    // for reads, return the number of bytes read from each LOB
+    if (!isWrite) {
+        for (i = 0; i < numLobs; i++)
+            valueLengths[i] = byteAmounts[i];
+    }
+    dpiUtils__freeMemory(lob->env, byteAmounts);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob__unlinkFile() [INTERNAL]
+//   Remove the LOB from the list of files kept open by the connection. The
+// mutex must be held by the caller.
+//-----------------------------------------------------------------------------
+static void dpiLob__unlinkFile(dpiLob *lob)
+{
+    if (lob->prevOpenFile)
+        lob->prevOpenFile->nextOpenFile = lob->nextOpenFile;
+    else lob->conn->openFiles = lob->nextOpenFile;
+    if (lob->nextOpenFile)
+        lob->nextOpenFile->prevOpenFile = lob->prevOpenFile;
+    lob->prevOpenFile = NULL;
+    lob->nextOpenFile = NULL;
+    lob->fileOpened = 0;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob__writeBytes() [INTERNAL]
 //   Writes data to the LOB at the specified offset.
 //-----------------------------------------------------------------------------
-static int dpiLob__writeBytes(dpiLob *lob, uint64_t offset, const char *value,
+int dpiLob__writeBytes(dpiLob *lob, uint64_t offset, const char *value,
         uint64_t valueLength, dpiError *error)
 {
     uint64_t lengthInBytes = valueLength, lengthInChars = 0;
@@ -266,6 +657,8 @@ int dpiLob_closeResource(dpiLob *lob)
 
     if (dpiLob__check(lob, __func__, &error) < 0)
         return DPI_FAILURE;
+    if (lob->fileOpened)
+        return dpiLob__closeFile(lob, &error);
     status = OCILobClose(lob->conn->handle, error.handle, lob->locator);
     return dpiError__check(&error, status, lob->conn, "close resource");
 }
@@ -368,12 +761,16 @@ int dpiLob_getDirectoryAndFileName(dpiLob *lob, const char **directoryAlias,
 
     if (dpiLob__check(lob, __func__, &error) < 0)
         return DPI_FAILURE;
-    ociDirectoryAliasLength = 30;
-    ociFileNameLength = 255;
+    ociDirectoryAliasLength = DPI_MAX_BFILE_DIR_ALIAS_LENGTH;
+    ociFileNameLength = DPI_MAX_BFILE_FILE_NAME_LENGTH;
     if (!lob->buffer) {
-        lob->buffer = malloc(ociDirectoryAliasLength + ociFileNameLength);
+        lob->buffer = dpiUtils__allocateMemory(lob->env, 1,
+                ociDirectoryAliasLength + ociFileNameLength, 0);
         if (!lob->buffer)
             return dpiError__set(&error, "allocate memory", DPI_ERR_NO_MEMORY);
+        dpiGen__updateMemoryCounter(lob,
+                DPI_MEMORY_COUNTER_LOB_BUFFER_BYTES,
+                ociDirectoryAliasLength + ociFileNameLength);
     }
     *directoryAlias = lob->buffer;
     *fileName = lob->buffer + ociDirectoryAliasLength;
@@ -447,9 +844,70 @@ int dpiLob_getSize(dpiLob *lob, uint64_t *size)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob_newReader() [PUBLIC]
+//   Create a new LOB reader and return it.
+//-----------------------------------------------------------------------------
+int dpiLob_newReader(dpiLob *lob, uint64_t offset, uint32_t bufferSize,
+        dpiLobReader **reader)
+{
+    dpiLobReader *tempReader;
+    dpiError error;
+
+    if (dpiLob__check(lob, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (!reader)
+        return dpiError__set(&error, "check reader handle",
+                DPI_ERR_NULL_POINTER_PARAMETER, "reader");
+    if (dpiGen__allocate(DPI_HTYPE_LOB_READER, lob->env,
+            (void**) &tempReader, &error) < 0)
+        return DPI_FAILURE;
+    if (dpiLobReader__create(tempReader, lob, offset, bufferSize,
+            &error) < 0) {
+        dpiLobReader__free(tempReader, &error);
+        return DPI_FAILURE;
+    }
+
+    *reader = tempReader;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLob_newWriter() [PUBLIC]
+//   Create a new LOB writer and return it.
+//-----------------------------------------------------------------------------
+int dpiLob_newWriter(dpiLob *lob, uint64_t offset, uint32_t bufferSize,
+        dpiLobWriter **writer)
+{
+    dpiLobWriter *tempWriter;
+    dpiError error;
+
+    if (dpiLob__check(lob, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (!writer)
+        return dpiError__set(&error, "check writer handle",
+                DPI_ERR_NULL_POINTER_PARAMETER, "writer");
+    if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE)
+        return dpiError__set(&error, "check LOB type", DPI_ERR_NOT_SUPPORTED);
+    if (dpiGen__allocate(DPI_HTYPE_LOB_WRITER, lob->env,
+            (void**) &tempWriter, &error) < 0)
+        return DPI_FAILURE;
+    if (dpiLobWriter__create(tempWriter, lob, offset, bufferSize,
+            &error) < 0) {
+        dpiLobWriter__free(tempWriter, &error);
+        return DPI_FAILURE;
+    }
+
+    *writer = tempWriter;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob_openResource() [PUBLIC]
-//   Open the LOB's resources to speed further accesses.
+//   Open the LOB's resources to speed further accesses. A file already kept
+// open by ODPI-C is handed over to the application instead.
 //-----------------------------------------------------------------------------
 int dpiLob_openResource(dpiLob *lob)
 {
@@ -458,6 +916,13 @@ int dpiLob_openResource(dpiLob *lob)
 
     if (dpiLob__check(lob, __func__, &error) < 0)
         return DPI_FAILURE;
+    if (lob->fileOpened) {
+        if (dpiEnv__acquireMutex(lob->env, &error) < 0)
+            return DPI_FAILURE;
+        if (lob->fileOpened)
+            dpiLob__unlinkFile(lob);
+        return dpiEnv__releaseMutex(lob->env, &error);
+    }
     status = OCILobOpen(lob->conn->handle, error.handle, lob->locator,
             OCI_LOB_READWRITE);
     return dpiError__check(&error, status, lob->conn, "open resource");
@@ -479,6 +944,29 @@ int dpiLob_readBytes(dpiLob *lob, uint64_t offset, uint64_t amount,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiLob_readMany() [PUBLIC]
+//   Return a portion (or all) of the data in each of the LOBs, reading from
+// all of them in a single round trip.
+//-----------------------------------------------------------------------------
+int dpiLob_readMany(dpiLob **lobs, uint32_t numLobs, uint64_t offset,
+        const uint64_t *amounts, char **values, uint64_t *valueLengths)
+{
+    dpiError error;
+
+    if (numLobs == 0)
+        return DPI_SUCCESS;
+    if (dpiLob__checkMany(lobs, numLobs, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (!amounts || !values || !valueLengths)
+        return dpiError__set(&error, "check parameters",
+                DPI_ERR_NULL_POINTER_PARAMETER, (!amounts) ? "amounts" :
+                (!values) ? "values" : "valueLengths");
+    return dpiLob__readMany(lobs, numLobs, offset, amounts, values,
+            valueLengths, &error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiLob_release() [PUBLIC]
 //   Release a reference to the LOB.
@@ -502,6 +990,8 @@ int dpiLob_setDirectoryAndFileName(dpiLob *lob, const char *directoryAlias,
 
     if (dpiLob__check(lob, __func__, &error) < 0)
         return DPI_FAILURE;
+    if (lob->fileOpened && dpiLob__closeFile(lob, &error) < 0)
+        return DPI_FAILURE;
     status = OCILobFileSetName(lob->conn->env->handle, error.handle,
             &lob->locator, (text*) directoryAlias,
             (uint16_t) directoryAliasLength, (text*) fileName,
@@ -555,3 +1045,27 @@ int dpiLob_writeBytes(dpiLob *lob, uint64_t offset, const char *value,
     return dpiLob__writeBytes(lob, offset, value, valueLength, &error);
 }
 
+
+//-----------------------------------------------------------------------------
+// dpiLob_writeMany() [PUBLIC]
+//   Write data to each of the LOBs at the specified offset, writing to all of
+// them in a single round trip.
+//-----------------------------------------------------------------------------
+int dpiLob_writeMany(dpiLob **lobs, uint32_t numLobs, uint64_t offset,
+        const char **values, const uint64_t *valueLengths)
+{
+    dpiError error;
+
+    if (numLobs == 0)
+        return DPI_SUCCESS;
+    if (dpiLob__checkMany(lobs, numLobs, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (!values || !valueLengths)
+        return dpiError__set(&error, "check parameters",
+                DPI_ERR_NULL_POINTER_PARAMETER, (!values) ? "values" :
+                "valueLengths");
+    if (lobs[0]->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE)
+        return dpiError__set(&error, "check LOB type", DPI_ERR_NOT_SUPPORTED);
+    return dpiLob__transferMany(lobs, numLobs, offset, NULL, (void**) values,
+            (uint64_t*) valueLengths, 1, &error);
+}
@@ -0,0 +1,270 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016, 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiLobReader.c
+//   Implementation of LOB readers, which stream the contents of a LOB.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// forward declarations of internal functions only used in this file
+static void dpiLobReader__freeBuffer(dpiLobReader *reader);
+
+
+//-----------------------------------------------------------------------------
+// dpiLobReader__check() [INTERNAL]
+//   Check that the LOB reader is valid and get an error handle for subsequent
+// calls.
+//-----------------------------------------------------------------------------
+static int dpiLobReader__check(dpiLobReader *reader, const char *fnName,
+        dpiError *error)
+{
+    if (dpiGen__startPublicFn(reader, DPI_HTYPE_LOB_READER, fnName,
+            error) < 0)
+        return DPI_FAILURE;
+    if (!reader->lob)
+        return dpiError__set(error, "check closed", DPI_ERR_LOB_CLOSED);
+    if (!reader->lob->locator)
+        return dpiError__set(error, "check LOB closed", DPI_ERR_LOB_CLOSED);
+    if (!reader->lob->conn->handle)
+        return dpiError__set(error, "check connection", DPI_ERR_NOT_CONNECTED);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobReader__create() [INTERNAL]
+//   Create a LOB reader. The buffer is sized to a multiple of the chunk size
+// of the LOB so that each piece returned by the database consists of whole
+// chunks.
+//-----------------------------------------------------------------------------
+int dpiLobReader__create(dpiLobReader *reader, dpiLob *lob, uint64_t offset,
+        uint32_t bufferSize, dpiError *error)
+{
+    // determine the size of the buffer
+    if (dpiLob__getStreamBufferSize(lob, bufferSize, &bufferSize, error) < 0)
+        return DPI_FAILURE;
+
+    // retain a reference to the LOB
+    if (dpiGen__setRefCount(lob, error, 1) < 0)
+        return DPI_FAILURE;
+    reader->lob = lob;
+    dpiGen__setMemoryOwner(reader, lob->ownerMemoryCounters);
+    reader->offset = (offset == 0) ? 1 : offset;
+
+    // allocate the buffer
+    reader->buffer = dpiUtils__allocateMemory(lob->env, 1, bufferSize, 0);
+    if (!reader->buffer)
+        return dpiError__set(error, "allocate buffer", DPI_ERR_NO_MEMORY);
+    reader->bufferSize = bufferSize;
+    dpiGen__updateMemoryCounter(reader, DPI_MEMORY_COUNTER_LOB_BUFFER_BYTES,
+            bufferSize);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobReader__finish() [INTERNAL]
+//   Finish reading the LOB. If the read is still in progress, it is
+// interrupted and the protocol is reset as required by OCI. The connection is
+// then made available for other operations.
+//-----------------------------------------------------------------------------
+static void dpiLobReader__finish(dpiLobReader *reader, int interrupt,
+        dpiError *error)
+{
+    dpiConn *conn = reader->lob->conn;
+
+    if (reader->started && !reader->finished) {
+        if (interrupt) {
+            OCIBreak(conn->handle, error->handle);
+            OCIReset(conn->serverHandle, error->handle);
+        }
+        conn->asyncOp = DPI_ASYNC_OP_NONE;
+    }
+    reader->finished = 1;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobReader__free() [INTERNAL]
+//   Free the memory for a LOB reader. A read still in progress is
+// interrupted.
+//-----------------------------------------------------------------------------
+void dpiLobReader__free(dpiLobReader *reader, dpiError *error)
+{
+    dpiGen__updateMemoryStats(reader, -1);
+    if (reader->lob) {
+        if (reader->lob->conn && reader->lob->conn->handle)
+            dpiLobReader__finish(reader, 1, error);
+        dpiLobReader__freeBuffer(reader);
+        dpiGen__setRefCount(reader->lob, error, -1);
+        reader->lob = NULL;
+    }
+    dpiGen__free(reader, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobReader__freeBuffer() [INTERNAL]
+//   Free the buffer of the LOB reader, if it has not already been freed. This
+// must be done before the reference to the LOB is released since the buffer
+// is counted in the memory statistics of the connection that owns the LOB.
+//-----------------------------------------------------------------------------
+static void dpiLobReader__freeBuffer(dpiLobReader *reader)
+{
+    if (!reader->buffer)
+        return;
+    dpiUtils__freeMemory(reader->env, reader->buffer);
+    dpiGen__updateMemoryCounter(reader, DPI_MEMORY_COUNTER_LOB_BUFFER_BYTES,
+            -(int64_t) reader->bufferSize);
+    reader->buffer = NULL;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobReader__start() [INTERNAL]
+//   Start reading the LOB. The whole remainder of the LOB is requested from
+// the database in a single call in polling mode; the database then streams
+// the contents of the LOB and each subsequent call only collects the next
+// piece, rather than requiring a round trip for each piece. For files, the
+// file is opened first if needed and kept open in the same way as for
+// dpiLob__readBytes().
+//-----------------------------------------------------------------------------
+static int dpiLobReader__start(dpiLobReader *reader, uint64_t *lengthInBytes,
+        dpiError *error)
+{
+    uint64_t lengthInChars = 0;
+    dpiLob *lob = reader->lob;
+    uint16_t charsetId;
+    sword status;
+
+    // the connection cannot be used for anything else while reading
+    if (lob->conn->asyncOp != DPI_ASYNC_OP_NONE)
+        return dpiError__set(error, "check async operation",
+                DPI_ERR_ASYNC_OPERATION_PENDING);
+
+    // for files, open the file if needed
+    if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_BFILE &&
+            dpiLob__openFile(lob, error) < 0)
+        return DPI_FAILURE;
+
+    // request the remainder of the LOB
+    *lengthInBytes = 0;
+    charsetId = (lob->type->charsetForm == SQLCS_NCHAR) ?
+            lob->conn->env->ncharsetId : lob->conn->env->charsetId;
+    status = OCILobRead2(lob->conn->handle, error->handle, lob->locator,
+            (ub8*) lengthInBytes, (ub8*) &lengthInChars, reader->offset,
+            reader->buffer, reader->bufferSize, OCI_FIRST_PIECE, NULL, NULL,
+            charsetId, lob->type->charsetForm);
+    reader->started = 1;
+    if (status == OCI_NEED_DATA) {
+        lob->conn->asyncOp = DPI_ASYNC_OP_LOB_READ;
+        return DPI_SUCCESS;
+    }
+    dpiLobReader__finish(reader, 0, error);
+    return dpiError__check(error, status, lob->conn, "read from LOB");
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobReader_addRef() [PUBLIC]
+//   Add a reference to the LOB reader.
+//-----------------------------------------------------------------------------
+int dpiLobReader_addRef(dpiLobReader *reader)
+{
+    return dpiGen__addRef(reader, DPI_HTYPE_LOB_READER, __func__);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobReader_close() [PUBLIC]
+//   Stop reading the LOB and release the reference to it. If the LOB has not
+// been read completely, the read is interrupted.
+//-----------------------------------------------------------------------------
+int dpiLobReader_close(dpiLobReader *reader)
+{
+    dpiError error;
+
+    if (dpiLobReader__check(reader, __func__, &error) < 0)
+        return DPI_FAILURE;
+    dpiLobReader__finish(reader, 1, &error);
+    dpiLobReader__freeBuffer(reader);
+    dpiGen__setMemoryOwner(reader, NULL);
+    dpiGen__setRefCount(reader->lob, &error, -1);
+    reader->lob = NULL;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobReader_read() [PUBLIC]
+//   Return the next piece of the LOB. The piece remains valid until the next
+// call to this function or until the reader is closed. A length of zero is
+// returned once the whole LOB has been read.
+//-----------------------------------------------------------------------------
+int dpiLobReader_read(dpiLobReader *reader, const char **value,
+        uint32_t *valueLength)
+{
+    uint64_t lengthInBytes = 0, lengthInChars = 0;
+    uint16_t charsetId;
+    dpiError error;
+    sword status;
+    dpiLob *lob;
+
+    // validate parameters
+    if (dpiLobReader__check(reader, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (!value || !valueLength)
+        return dpiError__set(&error, "check value",
+                DPI_ERR_NULL_POINTER_PARAMETER, (!value) ? "value" :
+                "valueLength");
+    *value = reader->buffer;
+    *valueLength = 0;
+
+    // start reading, if needed; nothing more is returned once the whole LOB
+    // has been read
+    if (!reader->started) {
+        if (dpiLobReader__start(reader, &lengthInBytes, &error) < 0)
+            return DPI_FAILURE;
+        *valueLength = (uint32_t) lengthInBytes;
+        return DPI_SUCCESS;
+    }
+    if (reader->finished)
+        return DPI_SUCCESS;
+
+    // collect the next piece
+    lob = reader->lob;
+    charsetId = (lob->type->charsetForm == SQLCS_NCHAR) ?
+            lob->conn->env->ncharsetId : lob->conn->env->charsetId;
+    status = OCILobRead2(lob->conn->handle, error.handle, lob->locator,
+            (ub8*) &lengthInBytes, (ub8*) &lengthInChars, reader->offset,
+            reader->buffer, reader->bufferSize, OCI_NEXT_PIECE, NULL, NULL,
+            charsetId, lob->type->charsetForm);
+    if (status != OCI_NEED_DATA) {
+        dpiLobReader__finish(reader, 0, &error);
+        if (dpiError__check(&error, status, lob->conn, "read from LOB") < 0)
+            return DPI_FAILURE;
+    }
+    *valueLength = (uint32_t) lengthInBytes;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobReader_release() [PUBLIC]
+//   Release a reference to the LOB reader.
+//-----------------------------------------------------------------------------
+int dpiLobReader_release(dpiLobReader *reader)
+{
+    return dpiGen__release(reader, DPI_HTYPE_LOB_READER, __func__);
+}
@@ -0,0 +1,303 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016, 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter.c
+//   Implementation of LOB writers, which stream data to a LOB.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+
+// forward declarations of internal functions only used in this file
+static void dpiLobWriter__freeBuffer(dpiLobWriter *writer);
+static void dpiLobWriter__interrupt(dpiLobWriter *writer, dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter__check() [INTERNAL]
+//   Check that the LOB writer is valid and get an error handle for subsequent
+// calls.
+//-----------------------------------------------------------------------------
+static int dpiLobWriter__check(dpiLobWriter *writer, const char *fnName,
+        dpiError *error)
+{
+    if (dpiGen__startPublicFn(writer, DPI_HTYPE_LOB_WRITER, fnName,
+            error) < 0)
+        return DPI_FAILURE;
+    if (!writer->lob)
+        return dpiError__set(error, "check closed", DPI_ERR_LOB_CLOSED);
+    if (!writer->lob->locator)
+        return dpiError__set(error, "check LOB closed", DPI_ERR_LOB_CLOSED);
+    if (!writer->lob->conn->handle)
+        return dpiError__set(error, "check connection", DPI_ERR_NOT_CONNECTED);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter__create() [INTERNAL]
+//   Create a LOB writer. The buffer is sized to a multiple of the chunk size
+// of the LOB so that each piece sent to the database consists of whole
+// chunks. An offset of zero indicates that data is to be appended to the LOB.
+//-----------------------------------------------------------------------------
+int dpiLobWriter__create(dpiLobWriter *writer, dpiLob *lob, uint64_t offset,
+        uint32_t bufferSize, dpiError *error)
+{
+    // determine the size of the buffer
+    if (dpiLob__getStreamBufferSize(lob, bufferSize, &bufferSize, error) < 0)
+        return DPI_FAILURE;
+
+    // retain a reference to the LOB
+    if (dpiGen__setRefCount(lob, error, 1) < 0)
+        return DPI_FAILURE;
+    writer->lob = lob;
+    dpiGen__setMemoryOwner(writer, lob->ownerMemoryCounters);
+    writer->offset = offset;
+
+    // allocate the buffer
+    writer->buffer = dpiUtils__allocateMemory(lob->env, 1, bufferSize, 0);
+    if (!writer->buffer)
+        return dpiError__set(error, "allocate buffer", DPI_ERR_NO_MEMORY);
+    writer->bufferSize = bufferSize;
+    dpiGen__updateMemoryCounter(writer, DPI_MEMORY_COUNTER_LOB_BUFFER_BYTES,
+            bufferSize);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter__flush() [INTERNAL]
+//   Send the contents of the buffer to the database as the next piece of the
+// LOB. The first piece starts the write in streaming mode (the total amount
+// is not known in advance) and the connection cannot be used for anything
+// else until the last piece has been sent. If the offset was not specified,
+// the data is appended to the LOB.
+//-----------------------------------------------------------------------------
+static int dpiLobWriter__flush(dpiLobWriter *writer, uint8_t piece,
+        dpiError *error)
+{
+    uint64_t lengthInBytes = 0, lengthInChars = 0;
+    dpiLob *lob = writer->lob;
+    uint16_t charsetId;
+    sword status;
+
+    // the first piece requires the connection to be available
+    if (!writer->started) {
+        if (lob->conn->asyncOp != DPI_ASYNC_OP_NONE)
+            return dpiError__set(error, "check async operation",
+                    DPI_ERR_ASYNC_OPERATION_PENDING);
+        if (writer->offset == 0) {
+            status = OCILobGetLength2(lob->conn->handle, error->handle,
+                    lob->locator, (ub8*) &writer->offset);
+            if (dpiError__check(error, status, lob->conn, "get length") < 0)
+                return DPI_FAILURE;
+            writer->offset++;
+        }
+    }
+
+    // a write consisting of a single piece specifies its length
+    if (piece == OCI_ONE_PIECE)
+        lengthInBytes = writer->bufferLength;
+
+    // send the piece
+    charsetId = (lob->type->charsetForm == SQLCS_NCHAR) ?
+            lob->conn->env->ncharsetId : lob->conn->env->charsetId;
+    status = OCILobWrite2(lob->conn->handle, error->handle, lob->locator,
+            (ub8*) &lengthInBytes, (ub8*) &lengthInChars, writer->offset,
+            writer->buffer, writer->bufferLength, piece, NULL, NULL,
+            charsetId, lob->type->charsetForm);
+    if (piece == OCI_FIRST_PIECE) {
+        writer->started = 1;
+        if (status == OCI_NEED_DATA) {
+            lob->conn->asyncOp = DPI_ASYNC_OP_LOB_WRITE;
+            writer->bufferLength = 0;
+            return DPI_SUCCESS;
+        }
+    } else if (piece == OCI_NEXT_PIECE && status == OCI_NEED_DATA) {
+        writer->bufferLength = 0;
+        return DPI_SUCCESS;
+    }
+
+    // any other result completes the write; if a write consisting of a
+    // single piece fails, the buffered data is retained so that the write
+    // can be attempted again
+    if (writer->started)
+        lob->conn->asyncOp = DPI_ASYNC_OP_NONE;
+    else if (status != OCI_SUCCESS && status != OCI_SUCCESS_WITH_INFO)
+        return dpiError__check(error, status, lob->conn, "write LOB");
+    writer->finished = 1;
+    writer->bufferLength = 0;
+    return dpiError__check(error, status, lob->conn, "write LOB");
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter__free() [INTERNAL]
+//   Free the memory for a LOB writer. A write still in progress is
+// interrupted and any data that has not yet been sent is discarded.
+//-----------------------------------------------------------------------------
+void dpiLobWriter__free(dpiLobWriter *writer, dpiError *error)
+{
+    dpiGen__updateMemoryStats(writer, -1);
+    if (writer->lob) {
+        if (writer->lob->conn && writer->lob->conn->handle)
+            dpiLobWriter__interrupt(writer, error);
+        dpiLobWriter__freeBuffer(writer);
+        dpiGen__setRefCount(writer->lob, error, -1);
+        writer->lob = NULL;
+    }
+    dpiGen__free(writer, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter__freeBuffer() [INTERNAL]
+//   Free the buffer of the LOB writer, if it has not already been freed. This
+// must be done before the reference to the LOB is released since the buffer
+// is counted in the memory statistics of the connection that owns the LOB.
+//-----------------------------------------------------------------------------
+static void dpiLobWriter__freeBuffer(dpiLobWriter *writer)
+{
+    if (!writer->buffer)
+        return;
+    dpiUtils__freeMemory(writer->env, writer->buffer);
+    dpiGen__updateMemoryCounter(writer, DPI_MEMORY_COUNTER_LOB_BUFFER_BYTES,
+            -(int64_t) writer->bufferSize);
+    writer->buffer = NULL;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter__interrupt() [INTERNAL]
+//   Interrupt a write that is still in progress and reset the protocol as
+// required by OCI, then make the connection available for other operations
+// again. Any data that has not yet been sent is discarded.
+//-----------------------------------------------------------------------------
+static void dpiLobWriter__interrupt(dpiLobWriter *writer, dpiError *error)
+{
+    dpiConn *conn = writer->lob->conn;
+
+    if (writer->started && !writer->finished) {
+        OCIBreak(conn->handle, error->handle);
+        OCIReset(conn->serverHandle, error->handle);
+        conn->asyncOp = DPI_ASYNC_OP_NONE;
+    }
+    writer->finished = 1;
+    writer->bufferLength = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter_addRef() [PUBLIC]
+//   Add a reference to the LOB writer.
+//-----------------------------------------------------------------------------
+int dpiLobWriter_addRef(dpiLobWriter *writer)
+{
+    return dpiGen__addRef(writer, DPI_HTYPE_LOB_WRITER, __func__);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter_close() [PUBLIC]
+//   Stop writing to the LOB and release the reference to it. If the write has
+// not been finished, it is interrupted and any buffered data is discarded.
+//-----------------------------------------------------------------------------
+int dpiLobWriter_close(dpiLobWriter *writer)
+{
+    dpiError error;
+
+    if (dpiLobWriter__check(writer, __func__, &error) < 0)
+        return DPI_FAILURE;
+    dpiLobWriter__interrupt(writer, &error);
+    dpiLobWriter__freeBuffer(writer);
+    dpiGen__setMemoryOwner(writer, NULL);
+    dpiGen__setRefCount(writer->lob, &error, -1);
+    writer->lob = NULL;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter_finish() [PUBLIC]
+//   Send any buffered data to the database and complete the write. If no
+// piece has been sent yet, the data is written in a single call; otherwise,
+// the buffered data is sent as the last piece.
+//-----------------------------------------------------------------------------
+int dpiLobWriter_finish(dpiLobWriter *writer)
+{
+    dpiError error;
+
+    if (dpiLobWriter__check(writer, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (writer->finished)
+        return DPI_SUCCESS;
+    if (!writer->started) {
+        if (writer->bufferLength == 0) {
+            writer->finished = 1;
+            return DPI_SUCCESS;
+        }
+        return dpiLobWriter__flush(writer, OCI_ONE_PIECE, &error);
+    }
+    return dpiLobWriter__flush(writer, OCI_LAST_PIECE, &error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter_release() [PUBLIC]
+//   Release a reference to the LOB writer.
+//-----------------------------------------------------------------------------
+int dpiLobWriter_release(dpiLobWriter *writer)
+{
+    return dpiGen__release(writer, DPI_HTYPE_LOB_WRITER, __func__);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiLobWriter_write() [PUBLIC]
+//   Write data to the LOB. The data is copied to the buffer and a piece is
+// sent to the database each time the buffer is full and more data is
+// available; a full buffer is retained until then so that the last piece,
+// sent by dpiLobWriter_finish(), is never empty.
+//-----------------------------------------------------------------------------
+int dpiLobWriter_write(dpiLobWriter *writer, const char *value,
+        uint64_t valueLength)
+{
+    uint32_t length;
+    dpiError error;
+
+    // validate parameters
+    if (dpiLobWriter__check(writer, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (!value && valueLength > 0)
+        return dpiError__set(&error, "check value",
+                DPI_ERR_NULL_POINTER_PARAMETER, "value");
+    if (writer->finished)
+        return dpiError__set(&error, "check finished", DPI_ERR_LOB_CLOSED);
+
+    // copy the data to the buffer, sending a piece whenever the buffer is
+    // full and more data remains to be copied
+    while (valueLength > 0) {
+        if (writer->bufferLength == writer->bufferSize &&
+                dpiLobWriter__flush(writer, (writer->started) ?
+                        OCI_NEXT_PIECE : OCI_FIRST_PIECE, &error) < 0)
+            return DPI_FAILURE;
+        length = writer->bufferSize - writer->bufferLength;
+        if (valueLength < length)
+            length = (uint32_t) valueLength;
+        memcpy(writer->buffer + writer->bufferLength, value, length);
+        writer->bufferLength += length;
+        value += length;
+        valueLength -= length;
+    }
+
+    return DPI_SUCCESS;
+}
@@ -44,6 +44,7 @@ int dpiMsgProps__create(dpiMsgProps *options, dpiConn *conn, dpiError *error)
 //-----------------------------------------------------------------------------
 void dpiMsgProps__free(dpiMsgProps *props, dpiError *error)
 {
+    dpiGen__updateMemoryStats(props, -1);
     if (props->handle) {
         OCIDescriptorFree(props->handle, OCI_DTYPE_AQMSG_PROPERTIES);
         props->handle = NULL;
@@ -52,7 +53,7 @@ void dpiMsgProps__free(dpiMsgProps *props, dpiError *error)
         dpiGen__setRefCount(props->conn, error, -1);
         props->conn = NULL;
     }
-    free(props);
+    dpiGen__free(props, error);
 }
 
 
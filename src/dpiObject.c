@@ -28,6 +28,7 @@ int dpiObject__allocate(dpiObjectType *objType, dvoid *instance,
     if (dpiGen__allocate(DPI_HTYPE_OBJECT, objType->env, (void**) &tempObj,
             error) < 0)
         return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempObj, objType->ownerMemoryCounters);
     if (dpiGen__setRefCount(objType, error, 1) < 0) {
         dpiObject__free(*obj, error);
         return DPI_FAILURE;
@@ -41,6 +42,24 @@ int dpiObject__allocate(dpiObjectType *objType, dvoid *instance,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiObject__check() [INTERNAL]
+//   Check that the object is valid and get an error handle for subsequent
+// calls. Check that no asynchronous operation is in progress on the
+// connection of the object type.
+//-----------------------------------------------------------------------------
+static int dpiObject__check(dpiObject *obj, const char *fnName,
+        dpiError *error)
+{
+    if (dpiGen__startPublicFn(obj, DPI_HTYPE_OBJECT, fnName, error) < 0)
+        return DPI_FAILURE;
+    if (obj->type->conn->asyncOp != DPI_ASYNC_OP_NONE)
+        return dpiError__set(error, "check async operation",
+                DPI_ERR_ASYNC_OPERATION_PENDING);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiObject__checkIsCollection() [INTERNAL]
 //   Check if the object is a collection, and if not, raise an exception.
@@ -48,7 +67,7 @@ int dpiObject__allocate(dpiObjectType *objType, dvoid *instance,
 static int dpiObject__checkIsCollection(dpiObject *obj, const char *fnName,
         dpiError *error)
 {
-    if (dpiGen__startPublicFn(obj, DPI_HTYPE_OBJECT, fnName, error) < 0)
+    if (dpiObject__check(obj, fnName, error) < 0)
         return DPI_FAILURE;
     if (!obj->type->isCollection)
         return dpiError__set(error, "check collection", DPI_ERR_NOT_COLLECTION,
@@ -97,6 +116,7 @@ static void dpiObject__clearOracleValue(dpiEnv *env, dpiError *error,
 //-----------------------------------------------------------------------------
 void dpiObject__free(dpiObject *obj, dpiError *error)
 {
+    dpiGen__updateMemoryStats(obj, -1);
     if (obj->isIndependent) {
         OCIObjectFree(obj->env->handle, error->handle, obj->instance,
                 OCI_DEFAULT);
@@ -106,7 +126,7 @@ void dpiObject__free(dpiObject *obj, dpiError *error)
         dpiGen__setRefCount(obj->type, error, -1);
         obj->type = NULL;
     }
-    free(obj);
+    dpiGen__free(obj, error);
 }
 
 
@@ -349,7 +369,7 @@ int dpiObject_copy(dpiObject *obj, dpiObject **copiedObj)
     sword status;
 
     *copiedObj = NULL;
-    if (dpiGen__startPublicFn(obj, DPI_HTYPE_OBJECT, __func__, &error) < 0)
+    if (dpiObject__check(obj, __func__, &error) < 0)
         return DPI_FAILURE;
     if (dpiObjectType_createObject(obj->type, copiedObj) < 0)
         return DPI_FAILURE;
@@ -397,7 +417,7 @@ int dpiObject_getAttributeValue(dpiObject *obj, dpiObjectAttr *attr,
     sword status;
 
     // validate attribute is for this object
-    if (dpiGen__startPublicFn(obj, DPI_HTYPE_OBJECT, __func__, &error) < 0)
+    if (dpiObject__check(obj, __func__, &error) < 0)
         return DPI_FAILURE;
     if (dpiGen__checkHandle(attr, DPI_HTYPE_OBJECT_ATTR, "get attribute value",
             &error) < 0)
@@ -476,6 +496,93 @@ int dpiObject_getElementValue(dpiObject *obj, int32_t index,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiObject_getElementValues() [PUBLIC]
+//   Return all of the elements of the collection, in index order, in the
+// provided array. Elements deleted from nested tables are skipped. Numbers
+// converted to doubles are collected and converted in batches; integers are
+// decoded directly (see dpiData__fromOracleNumberAsInteger()).
+//-----------------------------------------------------------------------------
+int dpiObject_getElementValues(dpiObject *obj, dpiNativeTypeNum nativeTypeNum,
+        uint32_t maxElements, dpiData *data, uint32_t *numElements)
+{
+    dpiData *numberData[DPI_NUMBER_BATCH_SIZE], *element;
+    OCINumber *numbers[DPI_NUMBER_BATCH_SIZE];
+    dpiOracleTypeNum oracleTypeNum;
+    uint32_t numNumbers = 0;
+    dpiOracleData value;
+    int32_t size, index;
+    OCIInd *indicator;
+    dpiError error;
+    boolean exists;
+    sword status;
+
+    // validate parameters
+    if (dpiObject__checkIsCollection(obj, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (!numElements)
+        return dpiError__set(&error, "check number of elements",
+                DPI_ERR_NULL_POINTER_PARAMETER, "numElements");
+    if (!data && maxElements > 0)
+        return dpiError__set(&error, "check data",
+                DPI_ERR_NULL_POINTER_PARAMETER, "data");
+
+    // determine the size of the collection; for nested tables this includes
+    // any elements that have been deleted
+    *numElements = 0;
+    status = OCICollSize(obj->env->handle, error.handle,
+            (const OCIColl*) obj->instance, &size);
+    if (dpiError__check(&error, status, obj->type->conn, "get size") < 0)
+        return DPI_FAILURE;
+
+    // convert each of the elements that exist
+    oracleTypeNum = (obj->type->elementOracleType) ?
+            obj->type->elementOracleType->oracleTypeNum : 0;
+    for (index = 0; index < size; index++) {
+        status = OCICollGetElem(obj->env->handle, error.handle,
+                (OCIColl*) obj->instance, index, &exists, &value.asRaw,
+                (void**) &indicator);
+        if (dpiError__check(&error, status, obj->type->conn,
+                "get element value") < 0)
+            return DPI_FAILURE;
+        if (!exists)
+            continue;
+        if (*numElements == maxElements)
+            return dpiError__set(&error, "check array size",
+                    DPI_ERR_ARRAY_SIZE_TOO_SMALL, maxElements);
+        element = &data[(*numElements)++];
+
+        // numbers converted to doubles are deferred until a batch is full
+        if (oracleTypeNum == DPI_ORACLE_TYPE_NUMBER &&
+                nativeTypeNum == DPI_NATIVE_TYPE_DOUBLE &&
+                *indicator != OCI_IND_NULL) {
+            element->isNull = 0;
+            numbers[numNumbers] = value.asNumber;
+            numberData[numNumbers++] = element;
+            if (numNumbers == DPI_NUMBER_BATCH_SIZE) {
+                if (dpiData__fromOracleNumbersAsDouble(numberData, numbers,
+                        numNumbers, &error) < 0)
+                    return DPI_FAILURE;
+                numNumbers = 0;
+            }
+            continue;
+        }
+
+        // all other elements are converted as they are retrieved
+        if (dpiObject__fromOracleValue(obj, &error,
+                obj->type->elementOracleType, obj->type->elementType, &value,
+                indicator, nativeTypeNum, element) < 0)
+            return DPI_FAILURE;
+    }
+
+    // convert any remaining numbers
+    if (numNumbers > 0)
+        return dpiData__fromOracleNumbersAsDouble(numberData, numbers,
+                numNumbers, &error);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiObject_getFirstIndex() [PUBLIC]
 //   Return the index of the first entry in the collection.
@@ -590,7 +697,7 @@ int dpiObject_setAttributeValue(dpiObject *obj, dpiObjectAttr *attr,
     sword status;
 
     // validate attribute is for this object
-    if (dpiGen__startPublicFn(obj, DPI_HTYPE_OBJECT, __func__, &error) < 0)
+    if (dpiObject__check(obj, __func__, &error) < 0)
         return DPI_FAILURE;
     if (dpiGen__checkHandle(attr, DPI_HTYPE_OBJECT_ATTR, "set attribute value",
             &error) < 0)
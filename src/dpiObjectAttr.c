@@ -27,20 +27,18 @@ int dpiObjectAttr__allocate(dpiObjectType *objType, OCIParam *param,
     OCITypeCode typeCode;
     sword status;
 
-    // allocate and assign main reference to the type this attribute belongs to
+    // allocate and assign the type this attribute belongs to; no reference
+    // is retained since the type retains a reference to the attribute
     *attr = NULL;
     if (dpiGen__allocate(DPI_HTYPE_OBJECT_ATTR, objType->env,
             (void**) &tempAttr, error) < 0)
         return DPI_FAILURE;
-    if (dpiGen__setRefCount(objType, error, 1) < 0) {
-        dpiObjectAttr__free(tempAttr, error);
-        return DPI_FAILURE;
-    }
+    dpiGen__setMemoryOwner(tempAttr, objType->ownerMemoryCounters);
     tempAttr->belongsToType = objType;
 
     // determine the name of the attribute
-    if (dpiUtils__getAttrStringWithDup(error, "get name", param,
-            OCI_DTYPE_PARAM, OCI_ATTR_NAME, &tempAttr->name,
+    if (dpiUtils__getAttrStringWithDup(tempAttr->env, error, "get name",
+            param, OCI_DTYPE_PARAM, OCI_ATTR_NAME, &tempAttr->name,
             &tempAttr->nameLength) < 0) {
         dpiObjectAttr__free(tempAttr, error);
         return DPI_FAILURE;
@@ -71,35 +69,83 @@ int dpiObjectAttr__allocate(dpiObjectType *objType, OCIParam *param,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiObjectAttr__copy() [INTERNAL]
+//   Create a copy of the attribute for the given copy of the type it belongs
+// to (see dpiObjectType__copy()). If an error occurs, the partially created
+// copy is returned and is released along with the copy of the type.
+//-----------------------------------------------------------------------------
+int dpiObjectAttr__copy(dpiObjectAttr *source, dpiObjectType *objType,
+        dpiObjectAttr **attr, dpiError *error)
+{
+    dpiObjectAttr *tempAttr;
+
+    // create structure
+    *attr = NULL;
+    if (dpiGen__allocate(DPI_HTYPE_OBJECT_ATTR, objType->env,
+            (void**) &tempAttr, error) < 0)
+        return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempAttr, objType->ownerMemoryCounters);
+    tempAttr->belongsToType = objType;
+    *attr = tempAttr;
+
+    // copy the name of the attribute
+    if (source->nameLength > 0) {
+        tempAttr->name = dpiUtils__allocateMemory(objType->env, 1,
+                source->nameLength, 0);
+        if (!tempAttr->name)
+            return dpiError__set(error, "allocate name", DPI_ERR_NO_MEMORY);
+        memcpy((char*) tempAttr->name, source->name, source->nameLength);
+        tempAttr->nameLength = source->nameLength;
+    }
+
+    // copy the remaining information, including the object type, if any
+    tempAttr->nameHash = source->nameHash;
+    tempAttr->oracleType = source->oracleType;
+    if (source->type)
+        return dpiObjectType__copy(source->type, &tempAttr->type, error);
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiObjectAttr__free() [INTERNAL]
 //   Free the memory for an object attribute.
 //-----------------------------------------------------------------------------
 void dpiObjectAttr__free(dpiObjectAttr *attr, dpiError *error)
 {
-    if (attr->belongsToType) {
-        dpiGen__setRefCount(attr->belongsToType, error, -1);
-        attr->belongsToType = NULL;
+    dpiGen__updateMemoryStats(attr, -1);
+    if (attr->name) {
+        dpiUtils__freeMemory(attr->env, (void*) attr->name);
+        attr->name = NULL;
     }
+    attr->belongsToType = NULL;
     if (attr->type) {
         dpiGen__setRefCount(attr->type, error, -1);
         attr->type = NULL;
     }
-    if (attr->name) {
-        free((void*) attr->name);
-        attr->name = NULL;
-    }
-    free(attr);
+    dpiGen__free(attr, error);
 }
 
 
 //-----------------------------------------------------------------------------
 // dpiObjectAttr_addRef() [PUBLIC]
-//   Add a reference to the object attribute.
+//   Add a reference to the object attribute. Attributes are retained by the
+// type they belong to, so each reference held by the application also holds a
+// reference to that type; this keeps the type (and therefore the attribute)
+// alive without a reference cycle between them.
 //-----------------------------------------------------------------------------
 int dpiObjectAttr_addRef(dpiObjectAttr *attr)
 {
-    return dpiGen__addRef(attr, DPI_HTYPE_OBJECT_ATTR, __func__);
+    dpiError error;
+
+    if (dpiGen__startPublicFn(attr, DPI_HTYPE_OBJECT_ATTR, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    if (dpiGen__setRefCount(attr->belongsToType, &error, 1) < 0)
+        return DPI_FAILURE;
+    return dpiGen__setRefCount(attr, &error, 1);
 }
 
 
@@ -130,10 +176,21 @@ int dpiObjectAttr_getInfo(dpiObjectAttr *attr, dpiObjectAttrInfo *info)
 
 //-----------------------------------------------------------------------------
 // dpiObjectAttr_release() [PUBLIC]
-//   Release a reference to the object attribute.
+//   Release a reference to the object attribute, along with the reference to
+// the type it belongs to that was acquired with it. The attribute itself is
+// freed when the type is freed.
 //-----------------------------------------------------------------------------
 int dpiObjectAttr_release(dpiObjectAttr *attr)
 {
-    return dpiGen__release(attr, DPI_HTYPE_OBJECT_ATTR, __func__);
+    dpiObjectType *objType;
+    dpiError error;
+
+    if (dpiGen__startPublicFn(attr, DPI_HTYPE_OBJECT_ATTR, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    objType = attr->belongsToType;
+    if (dpiGen__setRefCount(attr, &error, -1) < 0)
+        return DPI_FAILURE;
+    return dpiGen__setRefCount(objType, &error, -1);
 }
 
@@ -17,8 +17,34 @@
 #include "dpiImpl.h"
 
 // forward declarations of internal functions only used in this file
+static void dpiObjectType__freeCacheEntry(dpiEnv *env,
+        dpiObjectTypeCacheEntry *entry, dpiError *error);
+static uint32_t dpiObjectType__hashName(const char *name,
+        uint32_t nameLength);
 static int dpiObjectType__init(dpiObjectType *objType, OCIParam *param,
         uint32_t nameAttribute, dpiError *error);
+static void dpiObjectType__purgeCache(dpiEnv *env, dpiObjectTypeCache *cache,
+        dpiError *error);
+
+
+//-----------------------------------------------------------------------------
+// dpiObjectType__acquireAttribute() [INTERNAL]
+//   Return one of the attributes retained by the object type to the caller.
+// A reference to the object type is acquired along with the reference to the
+// attribute (see dpiObjectAttr_addRef()).
+//-----------------------------------------------------------------------------
+static int dpiObjectType__acquireAttribute(dpiObjectType *objType,
+        dpiObjectAttr *attr, dpiObjectAttr **attrOut, dpiError *error)
+{
+    if (dpiGen__setRefCount(objType, error, 1) < 0)
+        return DPI_FAILURE;
+    if (dpiGen__setRefCount(attr, error, 1) < 0) {
+        dpiGen__setRefCount(objType, error, -1);
+        return DPI_FAILURE;
+    }
+    *attrOut = attr;
+    return DPI_SUCCESS;
+}
 
 
 //-----------------------------------------------------------------------------
@@ -35,6 +61,7 @@ int dpiObjectType__allocate(dpiConn *conn, OCIParam *param,
     if (dpiGen__allocate(DPI_HTYPE_OBJECT_TYPE, conn->env,
             (void**) &tempObjType, error) < 0)
         return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempObjType, conn->memoryCounters);
     if (dpiGen__setRefCount(conn, error, 1) < 0) {
         dpiObjectType__free(tempObjType, error);
         return DPI_FAILURE;
@@ -52,6 +79,242 @@ int dpiObjectType__allocate(dpiConn *conn, OCIParam *param,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiObjectType__attach() [INTERNAL]
+//   Attach a copy of a cached object type, and the copies of its element type
+// and of the types of its attributes, to the connection, retaining a
+// reference to the connection for each of them.
+//-----------------------------------------------------------------------------
+static int dpiObjectType__attach(dpiObjectType *objType, dpiConn *conn,
+        dpiError *error)
+{
+    uint16_t i;
+
+    if (dpiGen__setRefCount(conn, error, 1) < 0)
+        return DPI_FAILURE;
+    objType->conn = conn;
+    dpiGen__setMemoryOwner(objType, conn->memoryCounters);
+    for (i = 0; i < objType->numAttributes; i++)
+        dpiGen__setMemoryOwner(objType->attributes[i], conn->memoryCounters);
+    if (objType->elementType &&
+            dpiObjectType__attach(objType->elementType, conn, error) < 0)
+        return DPI_FAILURE;
+    for (i = 0; i < objType->numAttributes; i++) {
+        if (objType->attributes[i]->type &&
+                dpiObjectType__attach(objType->attributes[i]->type, conn,
+                        error) < 0)
+            return DPI_FAILURE;
+    }
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiObjectType__cache() [INTERNAL]
+//   Add a copy of the object type to the object type cache of the connection,
+// keyed by the name that was used to look it up, unless another thread using
+// the connection has already done so. The copy is not attached to any
+// connection so that the cache does not keep the connection alive. If the
+// cache is full, the least recently used entry is evicted. Failure to cache
+// the object type is not considered an error.
+//-----------------------------------------------------------------------------
+void dpiObjectType__cache(dpiConn *conn, const char *name,
+        uint32_t nameLength, dpiObjectType *objType, dpiError *error)
+{
+    dpiObjectTypeCache *cache = conn->objectTypeCache;
+    dpiObjectTypeCacheEntry entry, evictedEntry;
+    int evicted = 0, found = 0;
+    uint32_t i;
+
+    // create the entry
+    entry.name = NULL;
+    if (dpiObjectType__copy(objType, &entry.objType, error) < 0) {
+        dpiObjectType__freeCacheEntry(conn->env, &entry, error);
+        return;
+    }
+    entry.name = dpiUtils__allocateMemory(conn->env, 1, nameLength, 0);
+    if (!entry.name) {
+        dpiObjectType__freeCacheEntry(conn->env, &entry, error);
+        return;
+    }
+    memcpy(entry.name, name, nameLength);
+    entry.nameLength = nameLength;
+    entry.hash = dpiObjectType__hashName(name, nameLength);
+
+    // add the entry to the cache unless another thread has already done so,
+    // evicting the least recently used entry if the cache is full
+    if (dpiEnv__acquireMutex(conn->env, error) < 0) {
+        dpiObjectType__freeCacheEntry(conn->env, &entry, error);
+        return;
+    }
+    for (i = 0; i < cache->numEntries; i++) {
+        if (cache->entries[i].hash == entry.hash &&
+                cache->entries[i].nameLength == nameLength &&
+                memcmp(cache->entries[i].name, name, nameLength) == 0) {
+            found = 1;
+            break;
+        }
+    }
+    if (!found) {
+        if (cache->numEntries == cache->capacity) {
+            evictedEntry = cache->entries[0];
+            cache->numEntries--;
+            memmove(cache->entries, cache->entries + 1,
+                    cache->numEntries * sizeof(dpiObjectTypeCacheEntry));
+            evicted = 1;
+        }
+        cache->entries[cache->numEntries++] = entry;
+    }
+    dpiEnv__releaseMutex(conn->env, error);
+
+    // free the entry that was not added or the entry that was evicted
+    if (found)
+        dpiObjectType__freeCacheEntry(conn->env, &entry, error);
+    if (evicted)
+        dpiObjectType__freeCacheEntry(conn->env, &evictedEntry, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiObjectType__copy() [INTERNAL]
+//   Create a copy of the object type, including copies of its element type and
+// of its attributes, without any round trips to the database. The copy is not
+// attached to a connection. Since copies are made while the mutex of the
+// environment is held, no references are released here; if an error occurs,
+// the partially created copy is returned and must be released by the caller.
+//-----------------------------------------------------------------------------
+int dpiObjectType__copy(dpiObjectType *source, dpiObjectType **objType,
+        dpiError *error)
+{
+    dpiObjectType *tempObjType;
+    uint16_t i;
+
+    // create structure
+    *objType = NULL;
+    if (dpiGen__allocate(DPI_HTYPE_OBJECT_TYPE, source->env,
+            (void**) &tempObjType, error) < 0)
+        return DPI_FAILURE;
+    *objType = tempObjType;
+
+    // copy the schema and name of the type
+    if (source->schemaLength > 0) {
+        tempObjType->schema = dpiUtils__allocateMemory(source->env, 1,
+                source->schemaLength, 0);
+        if (!tempObjType->schema)
+            return dpiError__set(error, "allocate schema", DPI_ERR_NO_MEMORY);
+        memcpy((char*) tempObjType->schema, source->schema,
+                source->schemaLength);
+        tempObjType->schemaLength = source->schemaLength;
+    }
+    if (source->nameLength > 0) {
+        tempObjType->name = dpiUtils__allocateMemory(source->env, 1,
+                source->nameLength, 0);
+        if (!tempObjType->name)
+            return dpiError__set(error, "allocate name", DPI_ERR_NO_MEMORY);
+        memcpy((char*) tempObjType->name, source->name, source->nameLength);
+        tempObjType->nameLength = source->nameLength;
+    }
+
+    // copy the remaining information, including the element type, if any
+    tempObjType->tdo = source->tdo;
+    tempObjType->typeCode = source->typeCode;
+    tempObjType->elementOracleType = source->elementOracleType;
+    tempObjType->isCollection = source->isCollection;
+    if (source->numAttributes > 0) {
+        tempObjType->attributes = dpiUtils__allocateMemory(source->env,
+                source->numAttributes, sizeof(dpiObjectAttr*), 1);
+        if (!tempObjType->attributes)
+            return dpiError__set(error, "allocate attributes",
+                    DPI_ERR_NO_MEMORY);
+        tempObjType->numAttributes = source->numAttributes;
+        for (i = 0; i < source->numAttributes; i++) {
+            if (dpiObjectAttr__copy(source->attributes[i], tempObjType,
+                    &tempObjType->attributes[i], error) < 0)
+                return DPI_FAILURE;
+        }
+    }
+    if (source->elementType)
+        return dpiObjectType__copy(source->elementType,
+                &tempObjType->elementType, error);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiObjectType__createAttributes() [INTERNAL]
+//   Create the attributes of the object type from its top level parameter
+// descriptor while the type is being described, so that no additional round
+// trips are required to retrieve them later. The attributes are retained by
+// the type but do not retain a reference to the type in turn, which would
+// otherwise form a reference cycle.
+//-----------------------------------------------------------------------------
+static int dpiObjectType__createAttributes(dpiObjectType *objType,
+        OCIParam *param, dpiError *error)
+{
+    OCIParam *attrListParam, *attrParam;
+    dpiObjectAttr *attr;
+    sword status;
+    uint16_t i;
+
+    // allocate the array of attributes
+    objType->attributes = dpiUtils__allocateMemory(objType->env,
+            objType->numAttributes, sizeof(dpiObjectAttr*), 1);
+    if (!objType->attributes)
+        return dpiError__set(error, "allocate attributes", DPI_ERR_NO_MEMORY);
+
+    // get the attribute list parameter descriptor
+    status = OCIAttrGet(param, OCI_DTYPE_PARAM, (dvoid*) &attrListParam, 0,
+            OCI_ATTR_LIST_TYPE_ATTRS, error->handle);
+    if (dpiError__check(error, status, objType->conn,
+            "get attribute list param") < 0)
+        return DPI_FAILURE;
+
+    // create attribute structure for each attribute
+    for (i = 0; i < objType->numAttributes; i++) {
+        status = OCIParamGet(attrListParam, OCI_DTYPE_PARAM, error->handle,
+                (dvoid**) &attrParam, (uint32_t) i + 1);
+        if (dpiError__check(error, status, objType->conn,
+                "get attribute param") < 0)
+            return DPI_FAILURE;
+        if (dpiObjectAttr__allocate(objType, attrParam, &attr, error) < 0)
+            return DPI_FAILURE;
+        attr->nameHash = dpiObjectType__hashName(attr->name, attr->nameLength);
+        objType->attributes[i] = attr;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiObjectType__createCache() [INTERNAL]
+//   Create a cache of object types keyed by name, capable of holding the
+// specified number of entries.
+//-----------------------------------------------------------------------------
+int dpiObjectType__createCache(dpiEnv *env, uint32_t capacity,
+        dpiObjectTypeCache **cache, dpiError *error)
+{
+    dpiObjectTypeCache *tempCache;
+
+    tempCache = dpiUtils__allocateMemory(env, 1, sizeof(dpiObjectTypeCache),
+            1);
+    if (!tempCache)
+        return dpiError__set(error, "allocate object type cache",
+                DPI_ERR_NO_MEMORY);
+    tempCache->entries = dpiUtils__allocateMemory(env, capacity,
+            sizeof(dpiObjectTypeCacheEntry), 1);
+    if (!tempCache->entries) {
+        dpiUtils__freeMemory(env, tempCache);
+        return dpiError__set(error, "allocate object type cache entries",
+                DPI_ERR_NO_MEMORY);
+    }
+    tempCache->capacity = capacity;
+    *cache = tempCache;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiObjectType__describe() [INTERNAL]
 //   Describe the object type and store information about it. Note that a
@@ -94,6 +357,11 @@ static int dpiObjectType__describe(dpiObjectType *objType,
             "get number of attributes") < 0)
         return DPI_FAILURE;
 
+    // create the attributes of the type, if applicable
+    if (objType->numAttributes > 0 &&
+            dpiObjectType__createAttributes(objType, param, error) < 0)
+        return DPI_FAILURE;
+
     // if a collection, need to determine the element type
     if (typeCode == OCI_TYPECODE_NAMEDCOLLECTION) {
         objType->isCollection = 1;
@@ -140,6 +408,25 @@ static int dpiObjectType__describe(dpiObjectType *objType,
 //-----------------------------------------------------------------------------
 void dpiObjectType__free(dpiObjectType *objType, dpiError *error)
 {
+    uint16_t i;
+
+    dpiGen__updateMemoryStats(objType, -1);
+    if (objType->attributes) {
+        for (i = 0; i < objType->numAttributes; i++) {
+            if (objType->attributes[i])
+                dpiGen__setRefCount(objType->attributes[i], error, -1);
+        }
+        dpiUtils__freeMemory(objType->env, objType->attributes);
+        objType->attributes = NULL;
+    }
+    if (objType->schema) {
+        dpiUtils__freeMemory(objType->env, (void*) objType->schema);
+        objType->schema = NULL;
+    }
+    if (objType->name) {
+        dpiUtils__freeMemory(objType->env, (void*) objType->name);
+        objType->name = NULL;
+    }
     if (objType->conn) {
         dpiGen__setRefCount(objType->conn, error, -1);
         objType->conn = NULL;
@@ -148,15 +435,60 @@ void dpiObjectType__free(dpiObjectType *objType, dpiError *error)
         dpiGen__setRefCount(objType->elementType, error, -1);
         objType->elementType = NULL;
     }
-    if (objType->schema) {
-        free((void*) objType->schema);
-        objType->schema = NULL;
+    dpiGen__free(objType, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiObjectType__freeCache() [INTERNAL]
+//   Free the object type cache and all of its entries.
+//-----------------------------------------------------------------------------
+void dpiObjectType__freeCache(dpiEnv *env, dpiObjectTypeCache *cache,
+        dpiError *error)
+{
+    uint32_t i;
+
+    for (i = 0; i < cache->numEntries; i++)
+        dpiObjectType__freeCacheEntry(env, &cache->entries[i], error);
+    dpiUtils__freeMemory(env, cache->entries);
+    dpiUtils__freeMemory(env, cache);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiObjectType__freeCacheEntry() [INTERNAL]
+//   Free the resources held by an entry in the object type cache.
+//-----------------------------------------------------------------------------
+static void dpiObjectType__freeCacheEntry(dpiEnv *env,
+        dpiObjectTypeCacheEntry *entry, dpiError *error)
+{
+    if (entry->objType) {
+        dpiGen__setRefCount(entry->objType, error, -1);
+        entry->objType = NULL;
     }
-    if (objType->name) {
-        free((void*) objType->name);
-        objType->name = NULL;
+    if (entry->name) {
+        dpiUtils__freeMemory(env, entry->name);
+        entry->name = NULL;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiObjectType__hashName() [INTERNAL]
+//   Return a hash of the name used to look up an object type (FNV-1a), which
+// allows most entries in the object type cache to be skipped without
+// comparing names.
+//-----------------------------------------------------------------------------
+static uint32_t dpiObjectType__hashName(const char *name,
+        uint32_t nameLength)
+{
+    uint32_t hash = 2166136261u, i;
+
+    for (i = 0; i < nameLength; i++) {
+        hash ^= (uint8_t) name[i];
+        hash *= 16777619u;
     }
-    free(objType);
+    return hash;
 }
 
 
@@ -172,14 +504,14 @@ static int dpiObjectType__init(dpiObjectType *objType, OCIParam *param,
     sword status;
 
     // determine the schema of the type
-    if (dpiUtils__getAttrStringWithDup(error, "get schema", param,
-            OCI_DTYPE_PARAM, OCI_ATTR_SCHEMA_NAME, &objType->schema,
+    if (dpiUtils__getAttrStringWithDup(objType->env, error, "get schema",
+            param, OCI_DTYPE_PARAM, OCI_ATTR_SCHEMA_NAME, &objType->schema,
             &objType->schemaLength) < 0)
         return DPI_FAILURE;
 
     // determine the name of the type
-    if (dpiUtils__getAttrStringWithDup(error, "get name", param,
-            OCI_DTYPE_PARAM, nameAttribute, &objType->name,
+    if (dpiUtils__getAttrStringWithDup(objType->env, error, "get name",
+            param, OCI_DTYPE_PARAM, nameAttribute, &objType->name,
             &objType->nameLength) < 0)
         return DPI_FAILURE;
 
@@ -214,6 +546,105 @@ static int dpiObjectType__init(dpiObjectType *objType, OCIParam *param,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiObjectType__lookup() [INTERNAL]
+//   Search the object type cache of the connection for an entry matching the
+// name. If one is found, a copy of the cached object type is attached to the
+// connection and returned and the entry is marked as the most recently used;
+// otherwise, NULL is returned and the type is described as usual. If an error
+// has indicated that object types have changed since they were cached, the
+// cache is purged first.
+//-----------------------------------------------------------------------------
+int dpiObjectType__lookup(dpiConn *conn, const char *name,
+        uint32_t nameLength, dpiObjectType **objType, dpiError *error)
+{
+    dpiObjectTypeCache *cache = conn->objectTypeCache;
+    dpiObjectTypeCacheEntry *entry, foundEntry;
+    dpiObjectType *tempObjType = NULL;
+    int status = DPI_SUCCESS;
+    uint32_t hash, i;
+
+    // purge the cache, if needed
+    *objType = NULL;
+    if (cache->invalidated)
+        dpiObjectType__purgeCache(conn->env, cache, error);
+
+    // search the cache, starting with the most recently used entry; if a copy
+    // of the object type cannot be made, it is simply described as usual
+    hash = dpiObjectType__hashName(name, nameLength);
+    if (dpiEnv__acquireMutex(conn->env, error) < 0)
+        return DPI_FAILURE;
+    for (i = cache->numEntries; i > 0; i--) {
+        entry = &cache->entries[i - 1];
+        if (entry->hash != hash || entry->nameLength != nameLength ||
+                memcmp(entry->name, name, nameLength) != 0)
+            continue;
+        if (dpiObjectType__copy(entry->objType, &tempObjType, error) < 0)
+            status = DPI_FAILURE;
+
+        // move the entry to the end of the cache as most recently used
+        foundEntry = *entry;
+        memmove(entry, entry + 1,
+                (cache->numEntries - i) * sizeof(dpiObjectTypeCacheEntry));
+        cache->entries[cache->numEntries - 1] = foundEntry;
+        break;
+    }
+    if (dpiEnv__releaseMutex(conn->env, error) < 0) {
+        if (tempObjType)
+            dpiGen__setRefCount(tempObjType, error, -1);
+        return DPI_FAILURE;
+    }
+    if (status < 0) {
+        if (tempObjType)
+            dpiGen__setRefCount(tempObjType, error, -1);
+        return DPI_SUCCESS;
+    }
+
+    // attach the copy to the connection
+    if (tempObjType && dpiObjectType__attach(tempObjType, conn, error) < 0) {
+        dpiGen__setRefCount(tempObjType, error, -1);
+        return DPI_FAILURE;
+    }
+
+    *objType = tempObjType;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiObjectType__purgeCache() [INTERNAL]
+//   Remove all of the entries from the object type cache. This is done when an
+// error indicates that object types have changed since they were cached.
+//-----------------------------------------------------------------------------
+static void dpiObjectType__purgeCache(dpiEnv *env, dpiObjectTypeCache *cache,
+        dpiError *error)
+{
+    dpiObjectTypeCacheEntry *entries, *emptyEntries;
+    uint32_t numEntries, i;
+
+    // replace the entries of the cache while the mutex is held
+    emptyEntries = dpiUtils__allocateMemory(env, cache->capacity,
+            sizeof(dpiObjectTypeCacheEntry), 1);
+    if (!emptyEntries)
+        return;
+    if (dpiEnv__acquireMutex(env, error) < 0) {
+        dpiUtils__freeMemory(env, emptyEntries);
+        return;
+    }
+    entries = cache->entries;
+    numEntries = cache->numEntries;
+    cache->entries = emptyEntries;
+    cache->numEntries = 0;
+    cache->invalidated = 0;
+    dpiEnv__releaseMutex(env, error);
+
+    // free each of the entries that were replaced
+    for (i = 0; i < numEntries; i++)
+        dpiObjectType__freeCacheEntry(env, &entries[i], error);
+    dpiUtils__freeMemory(env, entries);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiObjectType_addRef() [PUBLIC]
 //   Add a reference to the object type.
@@ -239,6 +670,9 @@ int dpiObjectType_createObject(dpiObjectType *objType, dpiObject **obj)
     if (dpiGen__startPublicFn(objType, DPI_HTYPE_OBJECT_TYPE, __func__,
             &error) < 0)
         return DPI_FAILURE;
+    if (objType->conn->asyncOp != DPI_ASYNC_OP_NONE)
+        return dpiError__set(&error, "check async operation",
+                DPI_ERR_ASYNC_OPERATION_PENDING);
 
     // validate object handle
     if (!obj)
@@ -273,17 +707,80 @@ int dpiObjectType_createObject(dpiObjectType *objType, dpiObject **obj)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiObjectType_getAttributeByIndex() [PUBLIC]
+//   Get the attribute of the object type at the given (zero-based) index.
+//-----------------------------------------------------------------------------
+int dpiObjectType_getAttributeByIndex(dpiObjectType *objType, uint16_t index,
+        dpiObjectAttr **attr)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(objType, DPI_HTYPE_OBJECT_TYPE, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    if (!attr)
+        return dpiError__set(&error, "check attribute handle",
+                DPI_ERR_NULL_POINTER_PARAMETER, "attr");
+    if (index >= objType->numAttributes)
+        return dpiError__set(&error, "check index",
+                DPI_ERR_INVALID_ATTR_INDEX, index);
+    return dpiObjectType__acquireAttribute(objType,
+            objType->attributes[index], attr, &error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiObjectType_getAttributeByName() [PUBLIC]
+//   Get the attribute of the object type with the given name. The hash of the
+// name is compared first so that most attributes are skipped without
+// comparing names.
+//-----------------------------------------------------------------------------
+int dpiObjectType_getAttributeByName(dpiObjectType *objType, const char *name,
+        uint32_t nameLength, dpiObjectAttr **attr)
+{
+    dpiObjectAttr *tempAttr;
+    dpiError error;
+    uint32_t hash;
+    uint16_t i;
+
+    // validate parameters
+    if (dpiGen__startPublicFn(objType, DPI_HTYPE_OBJECT_TYPE, __func__,
+            &error) < 0)
+        return DPI_FAILURE;
+    if (!name && nameLength > 0)
+        return dpiError__set(&error, "check name",
+                DPI_ERR_NULL_POINTER_PARAMETER, "name");
+    if (!attr)
+        return dpiError__set(&error, "check attribute handle",
+                DPI_ERR_NULL_POINTER_PARAMETER, "attr");
+
+    // search the attributes
+    hash = dpiObjectType__hashName(name, nameLength);
+    for (i = 0; i < objType->numAttributes; i++) {
+        tempAttr = objType->attributes[i];
+        if (tempAttr->nameHash == hash && tempAttr->nameLength == nameLength &&
+                memcmp(tempAttr->name, name, nameLength) == 0)
+            return dpiObjectType__acquireAttribute(objType, tempAttr, attr,
+                    &error);
+    }
+
+    return dpiError__set(&error, "get attribute", DPI_ERR_ATTR_NOT_FOUND,
+            nameLength, name, objType->schemaLength, objType->schema,
+            objType->nameLength, objType->name);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiObjectType_getAttributes() [PUBLIC]
-//   Get the attributes for the object type in the provided array.
+//   Get the attributes for the object type in the provided array. The
+// attributes were created when the type was described so no round trips are
+// required.
 //-----------------------------------------------------------------------------
 int dpiObjectType_getAttributes(dpiObjectType *objType, uint16_t numAttributes,
         dpiObjectAttr **attributes)
 {
-    OCIParam *topLevelParam, *attrListParam, *attrParam;
-    OCIDescribe *describeHandle;
     dpiError error;
-    sword status;
     uint16_t i;
 
     // validate object type and the number of attributes
@@ -299,63 +796,13 @@ int dpiObjectType_getAttributes(dpiObjectType *objType, uint16_t numAttributes,
         return dpiError__set(&error, "check attributes array",
                 DPI_ERR_NULL_POINTER_PARAMETER, "attributes");
 
-    // acquire a describe handle
-    status = OCIHandleAlloc(objType->env->handle, (dvoid**) &describeHandle,
-            OCI_HTYPE_DESCRIBE, 0, 0);
-    if (dpiError__check(&error, status, objType->conn,
-            "allocate describe handle") < 0)
-        return DPI_FAILURE;
-
-    // describe the type
-    status = OCIDescribeAny(objType->conn->handle, error.handle,
-            (dvoid*) objType->tdo, 0, OCI_OTYPE_PTR, OCI_DEFAULT,
-            OCI_PTYPE_TYPE, describeHandle);
-    if (dpiError__check(&error, status, objType->conn, "describe type") < 0) {
-        OCIHandleFree(describeHandle, OCI_HTYPE_DESCRIBE);
-        return DPI_FAILURE;
-    }
-
-    // get the top level parameter descriptor
-    status = OCIAttrGet(describeHandle, OCI_HTYPE_DESCRIBE, &topLevelParam, 0,
-            OCI_ATTR_PARAM, error.handle);
-    if (dpiError__check(&error, status, objType->conn,
-            "get top level param") < 0) {
-        OCIHandleFree(describeHandle, OCI_HTYPE_DESCRIBE);
-        return DPI_FAILURE;
-    }
-
-    // get the attribute list parameter descriptor
-    status = OCIAttrGet(topLevelParam, OCI_DTYPE_PARAM,
-            (dvoid*) &attrListParam, 0, OCI_ATTR_LIST_TYPE_ATTRS,
-            error.handle);
-    if (dpiError__check(&error, status, objType->conn,
-            "get attribute list param") < 0) {
-        OCIHandleFree(describeHandle, OCI_HTYPE_DESCRIBE);
-        return DPI_FAILURE;
-    }
-
-    // create attribute structure for each attribute
+    // return a reference to each of the attributes
     for (i = 0; i < objType->numAttributes; i++) {
-        status = OCIParamGet(attrListParam, OCI_DTYPE_PARAM, error.handle,
-                (dvoid**) &attrParam, (uint32_t) i + 1);
-        if (dpiError__check(&error, status, objType->conn,
-                "get attribute param") < 0) {
-            OCIHandleFree(describeHandle, OCI_HTYPE_DESCRIBE);
-            return DPI_FAILURE;
-        }
-        if (dpiObjectAttr__allocate(objType, attrParam, &attributes[i],
-                &error) < 0) {
-            OCIHandleFree(describeHandle, OCI_HTYPE_DESCRIBE);
+        if (dpiObjectType__acquireAttribute(objType, objType->attributes[i],
+                &attributes[i], &error) < 0)
             return DPI_FAILURE;
-        }
     }
 
-    // free the describe handle
-    status = OCIHandleFree(describeHandle, OCI_HTYPE_DESCRIBE);
-    if (dpiError__check(&error, status, objType->conn,
-            "free describe handle") < 0)
-        return DPI_FAILURE;
-
     return DPI_SUCCESS;
 }
 
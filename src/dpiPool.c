@@ -16,34 +16,287 @@
 
 #include "dpiImpl.h"
 
+// forward declarations of internal functions only used in this file
+static int dpiPool__acquireSession(dpiPool *pool,
+        const dpiConnCreateParams *params, dpiPoolSession *session,
+        dpiError *error);
+static void dpiPool__checkIdleSessions(dpiPool *pool, dpiError *error);
+static void dpiPool__closeSessions(dpiPool *pool, dpiError *error);
+static int dpiPool__createSession(dpiPool *pool, OCISvcCtx **handle,
+        dpiError *error);
+static dpiPoolWaiter *dpiPool__dequeueWaiter(dpiPool *pool);
+static int dpiPool__dropSession(dpiPool *pool, dpiPoolSession *session,
+        dpiError *error);
+static int dpiPool__findIdleSession(dpiPool *pool,
+        const dpiConnCreateParams *params, uint32_t *pos);
+static int dpiPool__fixupSession(dpiPool *pool, dpiConn *conn,
+        dpiConnCreateParams *params, dpiError *error);
+static void dpiPool__freeSessionCaches(dpiPool *pool,
+        dpiPoolSession *session, int sessionEnded, dpiError *error);
+static dpiPoolStatsStripe *dpiPool__getStatsStripe(dpiPool *pool);
+static void dpiPool__healthCheckThread(dpiPool *pool);
+static int dpiPool__pingSession(dpiPool *pool, OCISvcCtx *handle,
+        dpiError *error);
+static void dpiPool__recordAcquireTime(dpiPool *pool, uint64_t elapsed);
+static void dpiPool__removeSession(dpiPool *pool);
+static void dpiPool__trimIdleSessions(dpiPool *pool, dpiError *error);
+static int dpiPool__warmup(dpiPool *pool, uint32_t numThreads,
+        uint32_t readyPercent, dpiError *error);
+static int dpiPool__warmupSessions(dpiPool *pool, uint32_t numReady,
+        dpiError *error);
+static void dpiPool__warmupThread(dpiPool *pool);
+
+// each thread updates the statistics counters of pools in one of a number of
+// sets of counters, chosen the first time the thread records a statistic, so
+// that threads acquiring connections concurrently rarely update the same
+// memory; the sets are summed when the statistics are read
+#ifdef DPI_THREAD_LOCAL
+static int64_t dpiPoolStatsNumThreads = 0;
+static DPI_THREAD_LOCAL uint32_t dpiPoolStatsStripeNum = 0;
+#endif
+
+
 //-----------------------------------------------------------------------------
 // dpiPool__acquireConnection() [INTERNAL]
-//   Internal method used for acquiring a connection from a pool.
+//   Internal method used for acquiring a connection from a pool. Pools managed
+// by ODPI-C supply the session directly; otherwise the OCI session pool is
+// asked for one. If a tag was requested but the session does not have it, the
+// session fixup callback of the pool (if one was supplied) is called to
+// prepare the session, after which the session is given the requested tag.
 //-----------------------------------------------------------------------------
 int dpiPool__acquireConnection(dpiPool *pool, const char *userName,
         uint32_t userNameLength, const char *password, uint32_t passwordLength,
         dpiConnCreateParams *params, dpiConn **conn, dpiError *error)
 {
+    dpiPoolSession session;
     dpiConn *tempConn;
+    uint64_t startTime;
+
+    // pools managed by ODPI-C are always homogeneous
+    if (pool->managed && userName && userNameLength > 0)
+        return dpiError__set(error, "check proxy", DPI_ERR_INVALID_PROXY);
 
     // allocate new connection
+    startTime = dpiThread__getMonotonicTime();
     if (dpiGen__allocate(DPI_HTYPE_CONN, pool->env, (void**) &tempConn,
             error) < 0)
         return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempConn, tempConn->memoryCounters);
+    tempConn->stmtCacheCapacity = params->clientStmtCacheSize;
+    tempConn->hugePageThreshold = params->hugePageThreshold;
+    tempConn->prefaultHugePages = params->prefaultHugePages;
+    tempConn->bfileIdleTimeout = params->bfileIdleTimeout;
+    tempConn->tempLobCacheCapacity = params->tempLobCacheSize;
 
     // create the connection
-    if (dpiConn__get(tempConn, userName, userNameLength, password,
+    if (pool->managed) {
+        if (dpiGen__setRefCount(pool, error, 1) < 0) {
+            dpiConn__free(tempConn, error);
+            return DPI_FAILURE;
+        }
+        tempConn->pool = pool;
+        if (dpiPool__acquireSession(pool, params, &session, error) < 0) {
+            dpiConn__free(tempConn, error);
+            return DPI_FAILURE;
+        }
+        tempConn->handle = session.handle;
+        tempConn->tag = session.tag;
+        tempConn->tagLength = session.tagLength;
+        dpiConn__attachCaches(tempConn, &session, error);
+        if (dpiConn__getHandles(tempConn, error) < 0) {
+            dpiConn__free(tempConn, error);
+            return DPI_FAILURE;
+        }
+        params->outTag = tempConn->tag;
+        params->outTagLength = tempConn->tagLength;
+        params->outTagFound = (params->tagLength > 0 &&
+                tempConn->tagLength == params->tagLength &&
+                memcmp(tempConn->tag, params->tag, params->tagLength) == 0);
+    } else if (dpiConn__get(tempConn, userName, userNameLength, password,
             passwordLength, pool->name, pool->nameLength, params, pool,
             error) < 0) {
         dpiConn__free(tempConn, error);
         return DPI_FAILURE;
     }
 
+    // homogeneous pools share their query information cache with all of
+    // their connections; otherwise each connection has its own cache
+    if (pool->queryInfoCache)
+        tempConn->queryInfoCache = pool->queryInfoCache;
+    else if (pool->queryInfoCacheSize > 0 &&
+            dpiStmt__createQueryInfoCache(pool->env, pool->queryInfoCacheSize,
+                    &tempConn->queryInfoCache, error) < 0) {
+        dpiConn__free(tempConn, error);
+        return DPI_FAILURE;
+    }
+
+    // the object type cache is kept with the session since the type
+    // descriptors it retains are pinned for the duration of the session; for
+    // pools managed by ODPI-C it is retained between uses of the session
+    // (along with the statement and temporary LOB caches) so only sessions
+    // that have not been used before need one to be created
+    if (pool->objectTypeCacheSize > 0 && !tempConn->objectTypeCache &&
+            dpiObjectType__createCache(pool->env, pool->objectTypeCacheSize,
+                    &tempConn->objectTypeCache, error) < 0) {
+        dpiConn__free(tempConn, error);
+        return DPI_FAILURE;
+    }
+
+    // count tag hits and misses and prepare sessions that do not have the
+    // requested tag, if applicable; this is done after the caches are
+    // attached since the callback may execute statements and look up types
+    if (params->tagLength > 0) {
+        dpiPool__updateStats(pool, (params->outTagFound) ?
+                DPI_POOL_STAT_NUM_TAG_HITS : DPI_POOL_STAT_NUM_TAG_MISSES, 1);
+        if (!params->outTagFound && pool->sessionFixupCallback &&
+                dpiPool__fixupSession(pool, tempConn, params, error) < 0) {
+            dpiConn__free(tempConn, error);
+            return DPI_FAILURE;
+        }
+    }
+
+    dpiPool__recordAcquireTime(pool,
+            dpiThread__getMonotonicTime() - startTime);
     *conn = tempConn;
     return DPI_SUCCESS;
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool__acquireSession() [INTERNAL]
+//   Acquire a session from a pool managed by ODPI-C. The most recently used
+// suitable idle session is returned, if one is available, since it is the
+// most likely to still be cached by the client and the server (see
+// dpiPool__findIdleSession() for which sessions are suitable). Otherwise, a
+// new session is created if the pool has not reached its maximum size.
+// Otherwise, unless the get mode forbids it, the calling thread is placed at
+// the end of the queue of waiting threads until a session is handed to it by
+// a thread releasing one, it is permitted to create a new session or the wait
+// timeout expires. Sessions are never pinged here; that is done by the
+// health check thread of the pool (see dpiPool__checkIdleSessions()). The tag
+// of the session, if any, is owned by the caller once the session has been
+// acquired.
+//-----------------------------------------------------------------------------
+static int dpiPool__acquireSession(dpiPool *pool,
+        const dpiConnCreateParams *params, dpiPoolSession *session,
+        dpiError *error)
+{
+    uint64_t deadline = 0, now;
+    dpiPoolWaiter waiter, *temp;
+    uint32_t pos;
+    int closing;
+
+    // use the most recently used suitable idle session, if one is available
+    dpiThread__acquireMutex(&pool->mutex);
+    if (pool->closing) {
+        dpiThread__releaseMutex(&pool->mutex);
+        return dpiError__set(error, "check pool", DPI_ERR_NOT_CONNECTED);
+    }
+    if (dpiPool__findIdleSession(pool, params, &pos)) {
+        *session = pool->idleSessions[pos];
+        pool->numIdleSessions--;
+        memmove(pool->idleSessions + pos, pool->idleSessions + pos + 1,
+                (pool->numIdleSessions - pos) * sizeof(dpiPoolSession));
+        dpiThread__releaseMutex(&pool->mutex);
+        return DPI_SUCCESS;
+    }
+
+    // if the pool has not reached its maximum size, reserve a place for a new
+    // session; otherwise, wait for a session to become available, if the get
+    // mode permits it
+    if (pool->numSessions < pool->maxSessions ||
+            pool->getMode == DPI_MODE_POOL_GET_FORCEGET) {
+        pool->numSessions++;
+        dpiThread__releaseMutex(&pool->mutex);
+    } else {
+        if (pool->getMode == DPI_MODE_POOL_GET_NOWAIT) {
+            dpiThread__releaseMutex(&pool->mutex);
+            return dpiError__set(error, "get session",
+                    DPI_ERR_NO_SESSION_AVAILABLE);
+        }
+        if (pool->maxWaiters > 0 && pool->numWaiters >= pool->maxWaiters) {
+            dpiThread__releaseMutex(&pool->mutex);
+            return dpiError__set(error, "wait for session",
+                    DPI_ERR_TOO_MANY_POOL_WAITERS, pool->maxWaiters);
+        }
+
+        // add the waiter to the end of the queue
+        dpiThread__initCondition(&waiter.condition);
+        waiter.session.handle = NULL;
+        waiter.canCreate = 0;
+        waiter.next = NULL;
+        if (pool->lastWaiter)
+            pool->lastWaiter->next = &waiter;
+        else pool->firstWaiter = &waiter;
+        pool->lastWaiter = &waiter;
+        pool->numWaiters++;
+        dpiPool__updateStats(pool, DPI_POOL_STAT_NUM_WAITS, 1);
+
+        // wait until a session is handed over, a session can be created, the
+        // pool is closed or the timeout expires
+        if (pool->waitTimeout > 0)
+            deadline = dpiThread__getMonotonicTime() +
+                    (uint64_t) pool->waitTimeout * 1000;
+        while (!waiter.session.handle && !waiter.canCreate &&
+                !pool->closing) {
+            if (deadline == 0) {
+                dpiThread__waitCondition(&waiter.condition, &pool->mutex, 0);
+                continue;
+            }
+            now = dpiThread__getMonotonicTime();
+            if (now >= deadline)
+                break;
+            dpiThread__waitCondition(&waiter.condition, &pool->mutex,
+                    (uint32_t) ((deadline - now + 999) / 1000));
+        }
+
+        // if nothing was handed over, the waiter is still in the queue and
+        // must be removed from it
+        if (!waiter.session.handle && !waiter.canCreate) {
+            if (pool->firstWaiter == &waiter) {
+                dpiPool__dequeueWaiter(pool);
+            } else {
+                for (temp = pool->firstWaiter; temp->next != &waiter;
+                        temp = temp->next);
+                temp->next = waiter.next;
+                if (pool->lastWaiter == &waiter)
+                    pool->lastWaiter = temp;
+                pool->numWaiters--;
+            }
+        }
+        closing = pool->closing;
+        dpiThread__releaseMutex(&pool->mutex);
+        dpiThread__destroyCondition(&waiter.condition);
+
+        // use the session that was handed over, if applicable
+        if (waiter.session.handle) {
+            *session = waiter.session;
+            return DPI_SUCCESS;
+        }
+        if (!waiter.canCreate) {
+            if (closing)
+                return dpiError__set(error, "check pool",
+                        DPI_ERR_NOT_CONNECTED);
+            dpiPool__updateStats(pool, DPI_POOL_STAT_NUM_WAIT_TIMEOUTS, 1);
+            return dpiError__set(error, "wait for session",
+                    DPI_ERR_POOL_WAIT_TIMEOUT, pool->waitTimeout);
+        }
+
+    }
+
+    // create a new (untagged) session in the place that was reserved for it
+    memset(session, 0, sizeof(dpiPoolSession));
+    if (dpiPool__createSession(pool, &session->handle, error) < 0) {
+        dpiThread__acquireMutex(&pool->mutex);
+        dpiPool__removeSession(pool);
+        dpiThread__releaseMutex(&pool->mutex);
+        return DPI_FAILURE;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool__checkConnected() [INTERNAL]
 //   Determine if the session pool is connected to the database. If not, an
@@ -60,9 +313,148 @@ static int dpiPool__checkConnected(dpiPool *pool, const char *fnName,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool__checkIdleSessions() [INTERNAL]
+//   Ping the sessions of a pool managed by ODPI-C that have been idle for at
+// least the ping interval and drop the ones that are no longer usable. A ping
+// interval of zero means that the sessions are pinged as often as the health
+// check thread runs, which is once every DPI_POOL_MIN_HEALTH_CHECK_PERIOD
+// seconds; sessions are never pinged when they are acquired, so acquiring a
+// session never waits for a ping. The sessions are removed from the bottom of
+// the stack of idle sessions while they are being checked so that they cannot
+// be acquired; the ones that are still usable are then handed to waiting
+// threads or returned to the bottom of the stack, which keeps the stack
+// ordered by the time the sessions were last used.
+//-----------------------------------------------------------------------------
+static void dpiPool__checkIdleSessions(dpiPool *pool, dpiError *error)
+{
+    uint32_t numSessions, numValid, numToInsert, i;
+    dpiPoolSession *sessions;
+    dpiPoolWaiter *waiter;
+    uint64_t interval;
+
+    // detach the sessions that have been idle for at least the ping interval
+    if (pool->pingInterval < 0)
+        return;
+    interval = (pool->pingInterval == 0) ? DPI_POOL_MIN_HEALTH_CHECK_PERIOD :
+            (uint64_t) pool->pingInterval;
+    interval *= 1000000;
+    dpiThread__acquireMutex(&pool->mutex);
+    numSessions = 0;
+    while (numSessions < pool->numIdleSessions &&
+            dpiThread__getMonotonicTime() -
+                    pool->idleSessions[numSessions].lastTimeUsed >= interval)
+        numSessions++;
+    sessions = (numSessions == 0) ? NULL :
+            dpiUtils__allocateMemory(pool->env, numSessions,
+                    sizeof(dpiPoolSession), 0);
+    if (!sessions) {
+        dpiThread__releaseMutex(&pool->mutex);
+        return;
+    }
+    memcpy(sessions, pool->idleSessions, numSessions * sizeof(dpiPoolSession));
+    pool->numIdleSessions -= numSessions;
+    memmove(pool->idleSessions, pool->idleSessions + numSessions,
+            pool->numIdleSessions * sizeof(dpiPoolSession));
+    dpiThread__releaseMutex(&pool->mutex);
+
+    // ping each of the sessions; drop the ones that are no longer usable
+    for (i = 0, numValid = 0; i < numSessions; i++) {
+        if (dpiPool__pingSession(pool, sessions[i].handle, error) < 0) {
+            dpiPool__updateStats(pool, DPI_POOL_STAT_NUM_PING_DROPS, 1);
+            dpiPool__dropSession(pool, &sessions[i], error);
+            dpiThread__acquireMutex(&pool->mutex);
+            dpiPool__removeSession(pool);
+            dpiThread__releaseMutex(&pool->mutex);
+        } else sessions[numValid++] = sessions[i];
+    }
+
+    // hand the usable sessions to waiting threads, if there are any, and
+    // return the rest to the bottom of the stack, if there is room
+    dpiThread__acquireMutex(&pool->mutex);
+    for (i = 0; i < numValid && !pool->closing; i++) {
+        waiter = dpiPool__dequeueWaiter(pool);
+        if (!waiter)
+            break;
+        waiter->session = sessions[i];
+        dpiThread__signalCondition(&waiter->condition);
+    }
+    numToInsert = numValid - i;
+    if (pool->closing)
+        numToInsert = 0;
+    else if (numToInsert > pool->maxSessions - pool->numIdleSessions)
+        numToInsert = pool->maxSessions - pool->numIdleSessions;
+    numValid -= numToInsert;
+    memmove(pool->idleSessions + numToInsert, pool->idleSessions,
+            pool->numIdleSessions * sizeof(dpiPoolSession));
+    memcpy(pool->idleSessions, sessions + numValid,
+            numToInsert * sizeof(dpiPoolSession));
+    pool->numIdleSessions += numToInsert;
+    for (numToInsert = i; numToInsert < numValid; numToInsert++)
+        dpiPool__removeSession(pool);
+    dpiThread__releaseMutex(&pool->mutex);
+
+    // drop any sessions that could not be retained
+    for (; i < numValid; i++)
+        dpiPool__dropSession(pool, &sessions[i], error);
+    dpiUtils__freeMemory(pool->env, sessions);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__closeSessions() [INTERNAL]
+//   Mark a pool managed by ODPI-C as closing, wake all of the threads waiting
+// for a session and drop all of the idle sessions. Sessions that are released
+// back to the pool after this are dropped as well.
+//-----------------------------------------------------------------------------
+static void dpiPool__closeSessions(dpiPool *pool, dpiError *error)
+{
+    uint32_t numIdleSessions, i;
+    dpiPoolWaiter *waiter;
+
+    // mark the pool as closing and wake all waiting threads
+    dpiThread__acquireMutex(&pool->mutex);
+    pool->closing = 1;
+    for (waiter = pool->firstWaiter; waiter; waiter = waiter->next)
+        dpiThread__signalCondition(&waiter->condition);
+    if (pool->healthCheckThreadStarted)
+        dpiThread__signalCondition(&pool->healthCheckCondition);
+    dpiThread__releaseMutex(&pool->mutex);
+
+    // wait for the health check thread to finish; any sessions it was
+    // checking are dropped since the pool is closing
+    if (pool->healthCheckThreadStarted) {
+        dpiThread__join(pool->healthCheckThread);
+        dpiThread__destroyCondition(&pool->healthCheckCondition);
+        pool->healthCheckThreadStarted = 0;
+    }
+
+    // wait for the threads still creating initial sessions to finish; the
+    // sessions they create are placed on the stack of idle sessions
+    for (i = 0; i < pool->numWarmupThreads; i++)
+        dpiThread__join(pool->warmupThreads[i]);
+    pool->numWarmupThreads = 0;
+
+    // detach the idle sessions
+    dpiThread__acquireMutex(&pool->mutex);
+    numIdleSessions = pool->numIdleSessions;
+    pool->numIdleSessions = 0;
+    pool->numSessions -= numIdleSessions;
+    dpiThread__releaseMutex(&pool->mutex);
+
+    // drop the idle sessions; no other thread will use the array of idle
+    // sessions now that the pool is marked as closing
+    for (i = 0; i < numIdleSessions; i++)
+        dpiPool__dropSession(pool, &pool->idleSessions[i], error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool__create() [INTERNAL]
-//   Internal method for creating a session pool.
+//   Internal method for creating a session pool. For pools managed by ODPI-C,
+// the OCI session pool is only used for creating sessions, so it starts out
+// empty and never waits; the sessions and the waiting threads are managed by
+// ODPI-C instead.
 //-----------------------------------------------------------------------------
 static int dpiPool__create(dpiPool *pool, const char *userName,
         uint32_t userNameLength, const char *password, uint32_t passwordLength,
@@ -79,6 +471,15 @@ static int dpiPool__create(dpiPool *pool, const char *userName,
     if (createParams->externalAuth && (userName || password))
         return dpiError__set(error, "check mixed credentials",
                 DPI_ERR_EXT_AUTH_WITH_CREDENTIALS);
+    if (createParams->managed && !createParams->homogeneous)
+        return dpiError__set(error, "check homogeneous",
+                DPI_ERR_MANAGED_POOL_NOT_HOMOGENEOUS);
+
+    // allocate the statistics counters
+    pool->stats = dpiUtils__allocateMemory(pool->env,
+            DPI_POOL_STATS_NUM_STRIPES, sizeof(dpiPoolStatsStripe), 1);
+    if (!pool->stats)
+        return dpiError__set(error, "allocate statistics", DPI_ERR_NO_MEMORY);
 
     // create the session pool handle
     status = OCIHandleAlloc(pool->env->handle, (dvoid**) &pool->handle,
@@ -112,14 +513,17 @@ static int dpiPool__create(dpiPool *pool, const char *userName,
     status = OCISessionPoolCreate(pool->env->handle, error->handle,
             pool->handle, (OraText**) &pool->name, &pool->nameLength,
             (text*) connectString, connectStringLength,
-            createParams->minSessions, createParams->maxSessions,
-            createParams->sessionIncrement, (text*) userName,
-            userNameLength, (text*) password, passwordLength, poolMode);
+            (createParams->managed) ? 0 : createParams->minSessions,
+            createParams->maxSessions,
+            (createParams->managed) ? 1 : createParams->sessionIncrement,
+            (text*) userName, userNameLength, (text*) password,
+            passwordLength, poolMode);
     if (dpiError__check(error, status, NULL, "create pool") < 0)
         return DPI_FAILURE;
 
     // set the get mode on the pool
-    getMode = (uint8_t) createParams->getMode;
+    getMode = (createParams->managed) ? DPI_MODE_POOL_GET_FORCEGET :
+            (uint8_t) createParams->getMode;
     status = OCIAttrSet(pool->handle, OCI_HTYPE_SPOOL, (dvoid*) &getMode, 0,
             OCI_ATTR_SPOOL_GETMODE, error->handle);
     if (dpiError__check(error, status, NULL, "set get mode") < 0)
@@ -130,6 +534,218 @@ static int dpiPool__create(dpiPool *pool, const char *userName,
     pool->externalAuth = createParams->externalAuth;
     pool->pingInterval = createParams->pingInterval;
     pool->pingTimeout = createParams->pingTimeout;
+    pool->queryInfoCacheSize = commonParams->queryInfoCacheSize;
+    pool->objectTypeCacheSize = commonParams->objectTypeCacheSize;
+    pool->sessionFixupCallback = createParams->sessionFixupCallback;
+    pool->sessionFixupContext = createParams->sessionFixupContext;
+
+    // create the query information cache shared by all connections, if
+    // applicable; this is only possible for homogeneous pools
+    if (pool->homogeneous && pool->queryInfoCacheSize > 0 &&
+            dpiStmt__createQueryInfoCache(pool->env, pool->queryInfoCacheSize,
+                    &pool->queryInfoCache, error) < 0)
+        return DPI_FAILURE;
+
+    // prepare pools managed by ODPI-C and create their initial sessions
+    if (createParams->managed) {
+        if (createParams->maxSessions > 0) {
+            pool->idleSessions = dpiUtils__allocateMemory(pool->env,
+                    createParams->maxSessions, sizeof(dpiPoolSession), 0);
+            if (!pool->idleSessions)
+                return dpiError__set(error, "allocate idle sessions",
+                        DPI_ERR_NO_MEMORY);
+        }
+        dpiThread__initMutex(&pool->mutex);
+        dpiThread__initCondition(&pool->warmupCondition);
+        pool->managed = 1;
+        pool->getMode = createParams->getMode;
+        pool->maxSessions = createParams->maxSessions;
+        pool->minSessions = (createParams->minSessions < pool->maxSessions) ?
+                createParams->minSessions : pool->maxSessions;
+        pool->waitTimeout = createParams->waitTimeout;
+        pool->maxWaiters = createParams->maxWaiters;
+        if (dpiPool__warmup(pool, createParams->warmupThreads,
+                createParams->warmupReadyPercent, error) < 0)
+            return DPI_FAILURE;
+
+        // start the thread which checks the health of idle sessions
+        if (pool->pingInterval >= 0) {
+            dpiThread__initCondition(&pool->healthCheckCondition);
+            if (dpiThread__create(pool->env, &pool->healthCheckThread,
+                    (dpiThreadProc) dpiPool__healthCheckThread, pool) < 0) {
+                dpiThread__destroyCondition(&pool->healthCheckCondition);
+                return dpiError__set(error, "start health check thread",
+                        DPI_ERR_CREATE_THREAD);
+            }
+            pool->healthCheckThreadStarted = 1;
+        }
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__createSession() [INTERNAL]
+//   Create a new session for a pool managed by ODPI-C using the OCI session
+// pool.
+//-----------------------------------------------------------------------------
+static int dpiPool__createSession(dpiPool *pool, OCISvcCtx **handle,
+        dpiError *error)
+{
+    uint32_t mode = OCI_SESSGET_SPOOL;
+    uint64_t startTime;
+    sword status;
+
+    if (pool->externalAuth)
+        mode |= OCI_SESSGET_CREDEXT;
+    startTime = dpiThread__getMonotonicTime();
+    status = OCISessionGet(pool->env->handle, error->handle, handle, NULL,
+            (text*) pool->name, pool->nameLength, NULL, 0, NULL, NULL, NULL,
+            mode);
+    if (dpiError__check(error, status, NULL, "create session") < 0)
+        return DPI_FAILURE;
+    dpiPool__updateStats(pool, DPI_POOL_STAT_NUM_SESSIONS_CREATED, 1);
+    dpiPool__updateStats(pool, DPI_POOL_STAT_SESSION_CREATE_TIME,
+            (int64_t) (dpiThread__getMonotonicTime() - startTime));
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__dequeueWaiter() [INTERNAL]
+//   Remove the first waiter from the queue of threads waiting for a session
+// and return it, or return NULL if no threads are waiting. The pool mutex must
+// be held by the caller.
+//-----------------------------------------------------------------------------
+static dpiPoolWaiter *dpiPool__dequeueWaiter(dpiPool *pool)
+{
+    dpiPoolWaiter *waiter;
+
+    waiter = pool->firstWaiter;
+    if (waiter) {
+        pool->firstWaiter = waiter->next;
+        if (!pool->firstWaiter)
+            pool->lastWaiter = NULL;
+        pool->numWaiters--;
+    }
+    return waiter;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__dropSession() [INTERNAL]
+//   Release a session of a pool managed by ODPI-C back to the OCI session pool
+// and drop it. Its tag and the caches it retains, if any, are freed first.
+//-----------------------------------------------------------------------------
+static int dpiPool__dropSession(dpiPool *pool, dpiPoolSession *session,
+        dpiError *error)
+{
+    sword status;
+
+    dpiPool__freeSessionCaches(pool, session, 0, error);
+    if (session->tag) {
+        dpiUtils__freeMemory(pool->env, session->tag);
+        session->tag = NULL;
+    }
+    status = OCISessionRelease(session->handle, error->handle, NULL, 0,
+            OCI_SESSRLS_DROPSESS);
+    return dpiError__check(error, status, NULL, "drop session");
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__findIdleSession() [INTERNAL]
+//   Search the stack of idle sessions of a pool managed by ODPI-C for the
+// session to return to a thread acquiring a session, starting with the most
+// recently used session. A session with the requested tag is preferred,
+// followed by an untagged session. A session with a different tag is only
+// returned if no tag was requested, if any tag is acceptable or if the pool
+// cannot create a new session; otherwise, a new session is created instead
+// so that the state established for the other tags is retained. Returns 1 if
+// a session was found and 0 otherwise. The pool mutex must be held by the
+// caller.
+//-----------------------------------------------------------------------------
+static int dpiPool__findIdleSession(dpiPool *pool,
+        const dpiConnCreateParams *params, uint32_t *pos)
+{
+    uint32_t untaggedPos = 0, i;
+    dpiPoolSession *session;
+    int foundUntagged = 0;
+
+    if (pool->numIdleSessions == 0)
+        return 0;
+    for (i = pool->numIdleSessions; i > 0; i--) {
+        session = &pool->idleSessions[i - 1];
+        if (params->tagLength > 0 && session->tagLength == params->tagLength &&
+                memcmp(session->tag, params->tag, params->tagLength) == 0) {
+            *pos = i - 1;
+            return 1;
+        }
+        if (session->tagLength == 0 && !foundUntagged) {
+            untaggedPos = i - 1;
+            foundUntagged = 1;
+            if (params->tagLength == 0)
+                break;
+        }
+    }
+    if (foundUntagged) {
+        *pos = untaggedPos;
+        return 1;
+    }
+    if (params->tagLength == 0 || params->matchAnyTag ||
+            (pool->numSessions >= pool->maxSessions &&
+            pool->getMode != DPI_MODE_POOL_GET_FORCEGET)) {
+        *pos = pool->numIdleSessions - 1;
+        return 1;
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__fixupSession() [INTERNAL]
+//   Call the session fixup callback of the pool for a session that was
+// acquired without the requested tag and, if it succeeds, give the session
+// the requested tag so that the callback is not called again for it. The
+// session is returned to the pool with that tag unless it is explicitly
+// retagged when the connection is closed. If the callback fails, the session
+// is marked to be dropped since its state is unknown.
+//-----------------------------------------------------------------------------
+static int dpiPool__fixupSession(dpiPool *pool, dpiConn *conn,
+        dpiConnCreateParams *params, dpiError *error)
+{
+    const char *fnName;
+    char *tag;
+    int status;
+
+    // call the callback; it may call public functions on this thread, so the
+    // name of the function being executed is restored afterwards
+    fnName = error->buffer->fnName;
+    dpiPool__updateStats(pool, DPI_POOL_STAT_NUM_SESSION_FIXUPS, 1);
+    status = (*pool->sessionFixupCallback)(pool->sessionFixupContext, conn,
+            params->tag, params->tagLength, params->outTag,
+            params->outTagLength);
+    error->buffer->fnName = fnName;
+    if (status < 0) {
+        conn->dropSession = 1;
+        return dpiError__set(error, "fixup session",
+                DPI_ERR_SESSION_FIXUP_FAILED);
+    }
+
+    // tag the session with the requested tag
+    tag = dpiUtils__allocateMemory(pool->env, 1, params->tagLength, 0);
+    if (!tag) {
+        conn->dropSession = 1;
+        return dpiError__set(error, "allocate tag", DPI_ERR_NO_MEMORY);
+    }
+    memcpy(tag, params->tag, params->tagLength);
+    if (conn->tag)
+        dpiUtils__freeMemory(pool->env, conn->tag);
+    conn->tag = tag;
+    conn->tagLength = params->tagLength;
+    params->outTag = conn->tag;
+    params->outTagLength = conn->tagLength;
     return DPI_SUCCESS;
 }
 
@@ -140,16 +756,82 @@ static int dpiPool__create(dpiPool *pool, const char *userName,
 //-----------------------------------------------------------------------------
 void dpiPool__free(dpiPool *pool, dpiError *error)
 {
+    dpiGen__updateMemoryStats(pool, -1);
+    if (pool->managed)
+        dpiPool__closeSessions(pool, error);
     if (pool->handle) {
         OCISessionPoolDestroy(pool->handle, error->handle, OCI_SPD_FORCE);
         OCIHandleFree(pool->handle, OCI_HTYPE_SPOOL);
         pool->handle = NULL;
     }
+    if (pool->queryInfoCache) {
+        dpiStmt__freeQueryInfoCache(pool->env, pool->queryInfoCache);
+        pool->queryInfoCache = NULL;
+    }
+    if (pool->idleSessions) {
+        dpiUtils__freeMemory(pool->env, pool->idleSessions);
+        pool->idleSessions = NULL;
+    }
+    if (pool->stats) {
+        dpiUtils__freeMemory(pool->env, pool->stats);
+        pool->stats = NULL;
+    }
+    if (pool->warmupThreads) {
+        dpiUtils__freeMemory(pool->env, pool->warmupThreads);
+        pool->warmupThreads = NULL;
+    }
+    if (pool->managed) {
+        dpiThread__destroyCondition(&pool->warmupCondition);
+        dpiThread__destroyMutex(&pool->mutex);
+        pool->managed = 0;
+    }
     if (pool->env) {
         dpiEnv__free(pool->env, error);
         pool->env = NULL;
     }
-    free(pool);
+    dpiGen__free(pool, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__freeSessionCaches() [INTERNAL]
+//   Free the caches retained by a session of a pool managed by ODPI-C between
+// uses (see dpiConn__detachCaches()). If the session has already been ended
+// by OCI (the pool was closed forcibly), only the memory is freed since the
+// statements and temporary LOBs of the session are no longer valid.
+//-----------------------------------------------------------------------------
+static void dpiPool__freeSessionCaches(dpiPool *pool,
+        dpiPoolSession *session, int sessionEnded, dpiError *error)
+{
+    uint32_t i;
+
+    if (session->stmtCache) {
+        for (i = 0; i < session->numStmtCacheEntries; i++) {
+            if (sessionEnded)
+                session->stmtCache[i].handle = NULL;
+            dpiStmt__releaseCacheEntry(pool->env, &session->stmtCache[i],
+                    error);
+        }
+        dpiUtils__freeMemory(pool->env, session->stmtCache);
+        session->stmtCache = NULL;
+        session->numStmtCacheEntries = 0;
+    }
+    if (session->tempLobCache) {
+        for (i = 0; i < session->numTempLobCacheEntries; i++) {
+            if (!sessionEnded)
+                OCILobFreeTemporary(session->handle, error->handle,
+                        session->tempLobCache[i].locator);
+            OCIDescriptorFree(session->tempLobCache[i].locator,
+                    OCI_DTYPE_LOB);
+        }
+        dpiUtils__freeMemory(pool->env, session->tempLobCache);
+        session->tempLobCache = NULL;
+        session->numTempLobCacheEntries = 0;
+    }
+    if (session->objectTypeCache) {
+        dpiObjectType__freeCache(pool->env, session->objectTypeCache, error);
+        session->objectTypeCache = NULL;
+    }
 }
 
 
@@ -169,6 +851,28 @@ static int dpiPool__getAttributeUint(dpiPool *pool, uint32_t attribute,
     if (dpiPool__checkConnected(pool, fnName, &error) < 0)
         return DPI_FAILURE;
 
+    // pools managed by ODPI-C maintain some of the values themselves
+    if (pool->managed) {
+        switch (attribute) {
+            case OCI_ATTR_SPOOL_BUSY_COUNT:
+                dpiThread__acquireMutex(&pool->mutex);
+                *value = pool->numSessions - pool->numIdleSessions;
+                dpiThread__releaseMutex(&pool->mutex);
+                return DPI_SUCCESS;
+            case OCI_ATTR_SPOOL_GETMODE:
+                *value = pool->getMode;
+                return DPI_SUCCESS;
+            case OCI_ATTR_SPOOL_OPEN_COUNT:
+                *value = pool->numSessions;
+                return DPI_SUCCESS;
+            case OCI_ATTR_SPOOL_TIMEOUT:
+                *value = pool->idleTimeout;
+                return DPI_SUCCESS;
+            default:
+                break;
+        }
+    }
+
     // determine pointer to pass (OCI uses different sizes)
     switch (attribute) {
         case OCI_ATTR_SPOOL_GETMODE:
@@ -202,6 +906,240 @@ static int dpiPool__getAttributeUint(dpiPool *pool, uint32_t attribute,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool__getStatsStripe() [INTERNAL]
+//   Return the set of statistics counters updated by the calling thread. A
+// set is assigned to each thread in turn the first time it records a
+// statistic. If native thread local variables are not available, all threads
+// share the first set.
+//-----------------------------------------------------------------------------
+static dpiPoolStatsStripe *dpiPool__getStatsStripe(dpiPool *pool)
+{
+#ifdef DPI_THREAD_LOCAL
+    if (dpiPoolStatsStripeNum == 0)
+        dpiPoolStatsStripeNum = (uint32_t)
+                (DPI_ATOMIC_ADD_64(&dpiPoolStatsNumThreads, 1) %
+                DPI_POOL_STATS_NUM_STRIPES) + 1;
+    return &pool->stats[dpiPoolStatsStripeNum - 1];
+#else
+    return pool->stats;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__healthCheckThread() [INTERNAL]
+//   Thread procedure which periodically checks the health of the idle
+// sessions of a pool managed by ODPI-C so that sessions which are no longer
+// usable are discarded before an application acquires them. Idle sessions
+// that have exceeded the idle timeout are also discarded so that this does
+// not depend on sessions being released to the pool.
+//-----------------------------------------------------------------------------
+static void dpiPool__healthCheckThread(dpiPool *pool)
+{
+    uint32_t periodMs;
+    dpiError error;
+
+    if (dpiGlobal__initError("dpiPool_create", &error) < 0 ||
+            dpiEnv__initError(pool->env, &error) < 0)
+        return;
+    if (pool->pingInterval == 0)
+        periodMs = DPI_POOL_MIN_HEALTH_CHECK_PERIOD * 1000;
+    else if (pool->pingInterval > DPI_POOL_MAX_HEALTH_CHECK_PERIOD)
+        periodMs = DPI_POOL_MAX_HEALTH_CHECK_PERIOD * 1000;
+    else periodMs = (uint32_t) pool->pingInterval * 1000;
+    while (1) {
+        dpiThread__acquireMutex(&pool->mutex);
+        if (!pool->closing)
+            dpiThread__waitCondition(&pool->healthCheckCondition,
+                    &pool->mutex, periodMs);
+        if (pool->closing) {
+            dpiThread__releaseMutex(&pool->mutex);
+            break;
+        }
+        dpiThread__releaseMutex(&pool->mutex);
+        dpiPool__checkIdleSessions(pool, &error);
+        dpiPool__trimIdleSessions(pool, &error);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__isDestroyed() [INTERNAL]
+//   Return whether the OCI session pool of a pool managed by ODPI-C has been
+// destroyed while sessions were still in use (see dpiPool_close()).
+//-----------------------------------------------------------------------------
+int dpiPool__isDestroyed(dpiPool *pool)
+{
+    int destroyed;
+
+    if (!pool->managed)
+        return 0;
+    dpiThread__acquireMutex(&pool->mutex);
+    destroyed = pool->destroyed;
+    dpiThread__releaseMutex(&pool->mutex);
+    return destroyed;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__pingSession() [INTERNAL]
+//   Ping an idle session of a pool managed by ODPI-C to determine if it is
+// still usable. The receive timeout is set to the ping timeout of the pool
+// for the duration of the ping so that an unresponsive database does not
+// block the thread checking the health of the pool.
+//-----------------------------------------------------------------------------
+static int dpiPool__pingSession(dpiPool *pool, OCISvcCtx *handle,
+        dpiError *error)
+{
+#ifdef OCI_ATTR_BREAK_ON_NET_TIMEOUT
+    uint8_t savedBreakOnTimeout, breakOnTimeout;
+#endif
+    uint32_t savedTimeout;
+    void *serverHandle;
+    sword status;
+
+    // acquire the server handle
+    status = OCIAttrGet(handle, OCI_HTYPE_SVCCTX, (dvoid**) &serverHandle, 0,
+            OCI_ATTR_SERVER, error->handle);
+    if (dpiError__check(error, status, NULL, "get server handle") < 0)
+        return DPI_FAILURE;
+
+    // set parameters to ensure that the ping does not take too long to
+    // complete; keep original values
+    OCIAttrGet(serverHandle, OCI_HTYPE_SERVER, &savedTimeout, 0,
+            OCI_ATTR_RECEIVE_TIMEOUT, error->handle);
+    OCIAttrSet(serverHandle, OCI_HTYPE_SERVER, &pool->pingTimeout, 0,
+            OCI_ATTR_RECEIVE_TIMEOUT, error->handle);
+#ifdef OCI_ATTR_BREAK_ON_NET_TIMEOUT
+    OCIAttrGet(serverHandle, OCI_HTYPE_SERVER, &savedBreakOnTimeout, 0,
+            OCI_ATTR_BREAK_ON_NET_TIMEOUT, error->handle);
+    breakOnTimeout = 0;
+    OCIAttrSet(serverHandle, OCI_HTYPE_SERVER, &breakOnTimeout, 0,
+            OCI_ATTR_BREAK_ON_NET_TIMEOUT, error->handle);
+#endif
+
+    // perform the ping and restore original network parameters
+    status = OCIPing(handle, error->handle, OCI_DEFAULT);
+    if (status != OCI_SUCCESS)
+        return dpiError__check(error, status, NULL, "ping");
+    OCIAttrSet(serverHandle, OCI_HTYPE_SERVER, &savedTimeout, 0,
+            OCI_ATTR_RECEIVE_TIMEOUT, error->handle);
+#ifdef OCI_ATTR_BREAK_ON_NET_TIMEOUT
+    OCIAttrSet(serverHandle, OCI_HTYPE_SERVER, &savedBreakOnTimeout, 0,
+            OCI_ATTR_BREAK_ON_NET_TIMEOUT, error->handle);
+#endif
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__recordAcquireTime() [INTERNAL]
+//   Record the time (in microseconds) taken to acquire a connection from the
+// pool. The histogram is log-linear: values below the number of sub-buckets
+// have a bucket of their own and each following power of two is divided
+// into that number of equally sized buckets. Values too large for the
+// histogram are placed in the last bucket.
+//-----------------------------------------------------------------------------
+static void dpiPool__recordAcquireTime(dpiPool *pool, uint64_t elapsed)
+{
+    uint32_t bucketNum, exponent;
+    dpiPoolStatsStripe *stripe;
+    uint64_t value;
+
+    if (!pool->stats)
+        return;
+    bucketNum = (uint32_t) elapsed;
+    if (elapsed >= DPI_POOL_STATS_SUB_BUCKETS) {
+        for (value = elapsed, exponent = 0;
+                value >= 2 * DPI_POOL_STATS_SUB_BUCKETS; value >>= 1)
+            exponent++;
+        bucketNum = (exponent + 1) * DPI_POOL_STATS_SUB_BUCKETS +
+                (uint32_t) value - DPI_POOL_STATS_SUB_BUCKETS;
+        if (bucketNum >= DPI_POOL_STATS_NUM_BUCKETS)
+            bucketNum = DPI_POOL_STATS_NUM_BUCKETS - 1;
+    }
+    stripe = dpiPool__getStatsStripe(pool);
+    DPI_ATOMIC_ADD_64(&stripe->acquireTimeBuckets[bucketNum], 1);
+    DPI_ATOMIC_ADD_64(&stripe->counters[DPI_POOL_STAT_NUM_ACQUIRES], 1);
+    DPI_ATOMIC_ADD_64(&stripe->counters[DPI_POOL_STAT_ACQUIRE_TIME],
+            (int64_t) elapsed);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__releaseSession() [INTERNAL]
+//   Release a session back to a pool managed by ODPI-C. If a thread is waiting
+// for a session, the session is handed to it directly; otherwise, it is
+// placed on top of the stack of idle sessions. Sessions that need to be
+// dropped (or that cannot be retained) are dropped instead and, if a thread is
+// waiting for a session, it is permitted to create a new one in its place.
+// If the pool has been closed forcibly, the OCI session pool has ended the
+// session already so it is simply discarded. The pool takes ownership of the
+// tag of the session, if any.
+//-----------------------------------------------------------------------------
+int dpiPool__releaseSession(dpiPool *pool, dpiPoolSession *session,
+        int drop, dpiError *error)
+{
+    dpiPoolWaiter *waiter;
+
+    dpiThread__acquireMutex(&pool->mutex);
+    if (pool->destroyed) {
+        pool->numSessions--;
+        dpiThread__releaseMutex(&pool->mutex);
+        dpiPool__freeSessionCaches(pool, session, 1, error);
+        if (session->tag) {
+            dpiUtils__freeMemory(pool->env, session->tag);
+            session->tag = NULL;
+        }
+        return DPI_SUCCESS;
+    }
+    if (!drop && !pool->closing) {
+
+        // hand the session to the first waiting thread, if there is one
+        waiter = dpiPool__dequeueWaiter(pool);
+        if (waiter) {
+            waiter->session = *session;
+            dpiThread__signalCondition(&waiter->condition);
+            dpiThread__releaseMutex(&pool->mutex);
+            return DPI_SUCCESS;
+        }
+
+        // otherwise, place it on top of the stack of idle sessions
+        if (pool->numIdleSessions < pool->maxSessions) {
+            session->lastTimeUsed = dpiThread__getMonotonicTime();
+            pool->idleSessions[pool->numIdleSessions++] = *session;
+            dpiThread__releaseMutex(&pool->mutex);
+            dpiPool__trimIdleSessions(pool, error);
+            return DPI_SUCCESS;
+        }
+
+    }
+    dpiPool__removeSession(pool);
+    dpiThread__releaseMutex(&pool->mutex);
+    return dpiPool__dropSession(pool, session, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__removeSession() [INTERNAL]
+//   Account for a session of a pool managed by ODPI-C that has been (or is
+// about to be) dropped. If a thread is waiting for a session, it is permitted
+// to create a new session in its place instead. The pool mutex must be held
+// by the caller.
+//-----------------------------------------------------------------------------
+static void dpiPool__removeSession(dpiPool *pool)
+{
+    dpiPoolWaiter *waiter;
+
+    waiter = (pool->closing) ? NULL : dpiPool__dequeueWaiter(pool);
+    if (waiter) {
+        waiter->canCreate = 1;
+        dpiThread__signalCondition(&waiter->condition);
+    } else pool->numSessions--;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool__setAttributeUint() [INTERNAL]
 //   Set the value of the OCI attribute as an unsigned integer.
@@ -218,6 +1156,21 @@ static int dpiPool__setAttributeUint(dpiPool *pool, uint32_t attribute,
     if (dpiPool__checkConnected(pool, fnName, &error) < 0)
         return DPI_FAILURE;
 
+    // pools managed by ODPI-C maintain some of the values themselves
+    if (pool->managed) {
+        switch (attribute) {
+            case OCI_ATTR_SPOOL_GETMODE:
+                pool->getMode = (dpiPoolGetMode) value;
+                return DPI_SUCCESS;
+            case OCI_ATTR_SPOOL_TIMEOUT:
+                pool->idleTimeout = value;
+                dpiPool__trimIdleSessions(pool, &error);
+                return DPI_SUCCESS;
+            default:
+                break;
+        }
+    }
+
     // determine pointer to pass (OCI uses different sizes)
     switch (attribute) {
         case OCI_ATTR_SPOOL_GETMODE:
@@ -246,6 +1199,194 @@ static int dpiPool__setAttributeUint(dpiPool *pool, uint32_t attribute,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool__trimIdleSessions() [INTERNAL]
+//   Drop the sessions of a pool managed by ODPI-C that have been idle for
+// longer than the idle timeout, as long as the pool retains at least its
+// minimum number of sessions. The least recently used sessions are at the
+// bottom of the stack of idle sessions so they are examined first. Errors
+// are ignored since the sessions are being discarded anyway.
+//-----------------------------------------------------------------------------
+static void dpiPool__trimIdleSessions(dpiPool *pool, dpiError *error)
+{
+    dpiPoolSession session;
+    uint64_t idleTimeout;
+
+    while (1) {
+        session.handle = NULL;
+        dpiThread__acquireMutex(&pool->mutex);
+        idleTimeout = (uint64_t) pool->idleTimeout * 1000000;
+        if (idleTimeout > 0 && pool->numIdleSessions > 0 &&
+                pool->numSessions > pool->minSessions &&
+                dpiThread__getMonotonicTime() -
+                        pool->idleSessions[0].lastTimeUsed >= idleTimeout) {
+            session = pool->idleSessions[0];
+            pool->numIdleSessions--;
+            memmove(pool->idleSessions, pool->idleSessions + 1,
+                    pool->numIdleSessions * sizeof(dpiPoolSession));
+            dpiPool__removeSession(pool);
+        }
+        dpiThread__releaseMutex(&pool->mutex);
+        if (!session.handle)
+            break;
+        dpiPool__dropSession(pool, &session, error);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__updateStats() [INTERNAL]
+//   Update one of the statistics counters of the pool. No lock is acquired;
+// the counter is updated atomically in the set of counters assigned to the
+// calling thread.
+//-----------------------------------------------------------------------------
+void dpiPool__updateStats(dpiPool *pool, dpiPoolStatNum statNum,
+        int64_t delta)
+{
+    dpiPoolStatsStripe *stripe;
+
+    if (!pool->stats)
+        return;
+    stripe = dpiPool__getStatsStripe(pool);
+    DPI_ATOMIC_ADD_64(&stripe->counters[statNum], delta);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__warmup() [INTERNAL]
+//   Create the initial sessions of a pool managed by ODPI-C. The sessions are
+// created concurrently by the calling thread and a number of additional
+// threads since most of the time required is spent waiting for the database.
+// The calling thread returns as soon as the requested percentage of the
+// initial sessions is ready; the additional threads continue in the
+// background until the pool has reached its minimum number of sessions and
+// are joined when the pool is closed.
+//-----------------------------------------------------------------------------
+static int dpiPool__warmup(dpiPool *pool, uint32_t numThreads,
+        uint32_t readyPercent, dpiError *error)
+{
+    uint32_t numReady, i;
+
+    // determine the number of sessions that must be ready before returning
+    if (readyPercent > 100)
+        readyPercent = 100;
+    numReady = (uint32_t) (((uint64_t) pool->minSessions * readyPercent +
+            99) / 100);
+
+    // start the additional threads; unless no sessions need to be ready,
+    // the calling thread counts as one of the threads creating sessions
+    if (numThreads == 0)
+        numThreads = 1;
+    if (numThreads > pool->minSessions)
+        numThreads = pool->minSessions;
+    if (numReady > 0 && numThreads > 0)
+        numThreads--;
+    if (numThreads > 0) {
+        pool->warmupThreads = dpiUtils__allocateMemory(pool->env, numThreads,
+                sizeof(dpiThreadHandle), 0);
+        if (!pool->warmupThreads)
+            return dpiError__set(error, "allocate warmup threads",
+                    DPI_ERR_NO_MEMORY);
+        for (i = 0; i < numThreads; i++) {
+            if (dpiThread__create(pool->env, &pool->warmupThreads[i],
+                    (dpiThreadProc) dpiPool__warmupThread, pool) < 0)
+                break;
+            pool->numWarmupThreads++;
+        }
+    }
+
+    if (numReady == 0)
+        return DPI_SUCCESS;
+    return dpiPool__warmupSessions(pool, numReady, error);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__warmupSessions() [INTERNAL]
+//   Create sessions for a pool managed by ODPI-C until the pool has reached
+// its minimum number of sessions. This is called concurrently by each of the
+// threads creating the initial sessions of the pool. The thread creating the
+// pool passes the number of sessions that must be ready before the pool is
+// returned to the application; it returns as soon as that many sessions are
+// idle, waiting for sessions being created by other threads if needed, and
+// takes over the creation of sessions that other threads failed to create
+// so that any error is reported to the caller. Sessions created once threads
+// are waiting for a session are handed to them directly.
+//-----------------------------------------------------------------------------
+static int dpiPool__warmupSessions(dpiPool *pool, uint32_t numReady,
+        dpiError *error)
+{
+    dpiPoolSession session;
+    dpiPoolWaiter *waiter;
+
+    memset(&session, 0, sizeof(dpiPoolSession));
+    while (1) {
+
+        // reserve a place for the new session, if one is still needed
+        dpiThread__acquireMutex(&pool->mutex);
+        if (numReady > 0) {
+            while (!pool->closing && pool->numIdleSessions < numReady &&
+                    pool->numSessions >= pool->minSessions)
+                dpiThread__waitCondition(&pool->warmupCondition,
+                        &pool->mutex, 0);
+            if (pool->numIdleSessions >= numReady) {
+                dpiThread__releaseMutex(&pool->mutex);
+                break;
+            }
+        }
+        if (pool->closing || pool->numSessions >= pool->minSessions) {
+            dpiThread__releaseMutex(&pool->mutex);
+            break;
+        }
+        pool->numSessions++;
+        dpiThread__releaseMutex(&pool->mutex);
+
+        // create the session; if this fails, release the place that was
+        // reserved so that the thread creating the pool can use it
+        if (dpiPool__createSession(pool, &session.handle, error) < 0) {
+            dpiThread__acquireMutex(&pool->mutex);
+            dpiPool__removeSession(pool);
+            dpiThread__broadcastCondition(&pool->warmupCondition);
+            dpiThread__releaseMutex(&pool->mutex);
+            return DPI_FAILURE;
+        }
+
+        // hand the session to a waiting thread or place it on the stack of
+        // idle sessions
+        dpiThread__acquireMutex(&pool->mutex);
+        waiter = (pool->closing) ? NULL : dpiPool__dequeueWaiter(pool);
+        if (waiter) {
+            waiter->session = session;
+            dpiThread__signalCondition(&waiter->condition);
+        } else {
+            session.lastTimeUsed = dpiThread__getMonotonicTime();
+            pool->idleSessions[pool->numIdleSessions++] = session;
+        }
+        dpiThread__broadcastCondition(&pool->warmupCondition);
+        dpiThread__releaseMutex(&pool->mutex);
+
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiPool__warmupThread() [INTERNAL]
+//   Thread procedure used for creating the initial sessions of a pool managed
+// by ODPI-C. Each thread acquires its own error handle.
+//-----------------------------------------------------------------------------
+static void dpiPool__warmupThread(dpiPool *pool)
+{
+    dpiError error;
+
+    if (dpiGlobal__initError("dpiPool_create", &error) < 0 ||
+            dpiEnv__initError(pool->env, &error) < 0)
+        return;
+    dpiPool__warmupSessions(pool, 0, &error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool_acquireConnection() [PUBLIC]
 //   Acquire a connection from the pool.
@@ -300,7 +1441,34 @@ int dpiPool_close(dpiPool *pool, dpiPoolCloseMode mode)
 
     if (dpiPool__checkConnected(pool, __func__, &error) < 0)
         return DPI_FAILURE;
-    status = OCISessionPoolDestroy(pool->handle, error.handle, mode);
+
+    // pools managed by ODPI-C hold all of their sessions, even idle ones, so
+    // the check for busy sessions must be made here and the idle sessions
+    // must be dropped before the OCI session pool is destroyed; the pool is
+    // marked as closing while the mutex is still held so that no session can
+    // be acquired once the check has been made
+    if (pool->managed) {
+        dpiThread__acquireMutex(&pool->mutex);
+        if (!(mode & DPI_MODE_POOL_CLOSE_FORCE) &&
+                pool->numSessions > pool->numIdleSessions) {
+            dpiThread__releaseMutex(&pool->mutex);
+            return dpiError__set(&error, "check busy sessions",
+                    DPI_ERR_POOL_HAS_BUSY_SESSIONS);
+        }
+        pool->closing = 1;
+        dpiThread__releaseMutex(&pool->mutex);
+        dpiPool__closeSessions(pool, &error);
+
+        // the OCI session pool is destroyed while the mutex is held so that
+        // sessions still in use are not released at the same time; once it
+        // has been destroyed, those sessions are no longer valid and must not
+        // be released to OCI
+        dpiThread__acquireMutex(&pool->mutex);
+        status = OCISessionPoolDestroy(pool->handle, error.handle, mode);
+        if (status == OCI_SUCCESS || status == OCI_SUCCESS_WITH_INFO)
+            pool->destroyed = 1;
+        dpiThread__releaseMutex(&pool->mutex);
+    } else status = OCISessionPoolDestroy(pool->handle, error.handle, mode);
     if (dpiError__check(&error, status, NULL, "destroy pool") < 0)
         return DPI_FAILURE;
     OCIHandleFree(pool->handle, OCI_HTYPE_SPOOL);
@@ -323,6 +1491,7 @@ int dpiPool_create(const dpiContext *context, const char *userName,
     dpiPoolCreateParams localCreateParams;
     dpiPool *tempPool;
     dpiError error;
+    dpiEnv *env;
 
     // validate context
     if (dpiContext__startPublicFn(context, __func__, &error) < 0)
@@ -347,9 +1516,14 @@ int dpiPool_create(const dpiContext *context, const char *userName,
         createParams = &localCreateParams;
     }
 
-    // allocate memory for pool
-    if (dpiGen__allocate(DPI_HTYPE_POOL, NULL, (void**) &tempPool, &error) < 0)
+    // allocate memory for environment and pool
+    if (dpiEnv__allocate(commonParams->allocator, &env, &error) < 0)
         return DPI_FAILURE;
+    if (dpiGen__allocate(DPI_HTYPE_POOL, env, (void**) &tempPool,
+            &error) < 0) {
+        dpiEnv__free(env, &error);
+        return DPI_FAILURE;
+    }
 
     // initialize environment
     if (dpiEnv__init(tempPool->env, context, commonParams, &error) < 0) {
@@ -428,6 +1602,22 @@ int dpiPool_getMaxLifetimeSession(dpiPool *pool, uint32_t *value)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool_getMemoryStats() [PUBLIC]
+//   Return memory statistics for the pool and all connections acquired from
+// it, along with the handles created from those connections.
+//-----------------------------------------------------------------------------
+int dpiPool_getMemoryStats(dpiPool *pool, dpiMemoryStats *stats)
+{
+    dpiError error;
+
+    if (dpiGen__startPublicFn(pool, DPI_HTYPE_POOL, __func__, &error) < 0)
+        return DPI_FAILURE;
+    dpiUtils__getMemoryStats(pool->env->memoryCounters, stats);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool_getOpenCount() [PUBLIC]
 //   Return the pool's open count.
@@ -439,6 +1629,52 @@ int dpiPool_getOpenCount(dpiPool *pool, uint32_t *value)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiPool_getStats() [PUBLIC]
+//   Return the acquire time and session statistics of the pool. The sets of
+// counters updated by each thread are summed without acquiring a lock so the
+// values returned may not reflect acquires that are still in progress.
+//-----------------------------------------------------------------------------
+int dpiPool_getStats(dpiPool *pool, dpiPoolStats *stats)
+{
+    int64_t counters[DPI_POOL_STAT_MAX];
+    dpiPoolStatsStripe *stripe;
+    uint32_t i, j;
+    dpiError error;
+
+    if (dpiPool__checkConnected(pool, __func__, &error) < 0)
+        return DPI_FAILURE;
+    if (!stats)
+        return dpiError__set(&error, "check stats",
+                DPI_ERR_NULL_POINTER_PARAMETER, "stats");
+    memset(counters, 0, sizeof(counters));
+    memset(stats, 0, sizeof(dpiPoolStats));
+    for (i = 0; i < DPI_POOL_STATS_NUM_STRIPES; i++) {
+        stripe = &pool->stats[i];
+        for (j = 0; j < DPI_POOL_STAT_MAX; j++)
+            counters[j] += stripe->counters[j];
+        for (j = 0; j < DPI_POOL_STATS_NUM_BUCKETS; j++)
+            stats->acquireTimeBuckets[j] +=
+                    (uint64_t) stripe->acquireTimeBuckets[j];
+    }
+    stats->numAcquires = (uint64_t) counters[DPI_POOL_STAT_NUM_ACQUIRES];
+    stats->acquireTime = (uint64_t) counters[DPI_POOL_STAT_ACQUIRE_TIME];
+    stats->numWaits = (uint64_t) counters[DPI_POOL_STAT_NUM_WAITS];
+    stats->numWaitTimeouts =
+            (uint64_t) counters[DPI_POOL_STAT_NUM_WAIT_TIMEOUTS];
+    stats->numSessionsCreated =
+            (uint64_t) counters[DPI_POOL_STAT_NUM_SESSIONS_CREATED];
+    stats->sessionCreateTime =
+            (uint64_t) counters[DPI_POOL_STAT_SESSION_CREATE_TIME];
+    stats->numPingDrops = (uint64_t) counters[DPI_POOL_STAT_NUM_PING_DROPS];
+    stats->numTagHits = (uint64_t) counters[DPI_POOL_STAT_NUM_TAG_HITS];
+    stats->numTagMisses = (uint64_t) counters[DPI_POOL_STAT_NUM_TAG_MISSES];
+    stats->numSessionFixups =
+            (uint64_t) counters[DPI_POOL_STAT_NUM_SESSION_FIXUPS];
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiPool_getStmtCacheSize() [PUBLIC]
 //   Return the pool's default statement cache size.
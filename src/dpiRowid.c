@@ -46,15 +46,16 @@ int dpiRowid__allocate(dpiConn *conn, dpiRowid **rowid, dpiError *error)
 //-----------------------------------------------------------------------------
 void dpiRowid__free(dpiRowid *rowid, dpiError *error)
 {
+    dpiGen__updateMemoryStats(rowid, -1);
     if (rowid->handle) {
         OCIDescriptorFree(rowid->handle, OCI_DTYPE_ROWID);
         rowid->handle = NULL;
     }
     if (rowid->buffer) {
-        free(rowid->buffer);
+        dpiUtils__freeMemory(rowid->env, rowid->buffer);
         rowid->buffer = NULL;
     }
-    free(rowid);
+    dpiGen__free(rowid, error);
 }
 
 
@@ -91,7 +92,8 @@ int dpiRowid_getStringValue(dpiRowid *rowid, const char **value,
                 error.handle);
 
         // allocate and populate buffer containing string representation
-        rowid->buffer = malloc(rowid->bufferLength);
+        rowid->buffer = dpiUtils__allocateMemory(rowid->env, 1,
+                rowid->bufferLength, 0);
         if (!rowid->buffer)
             return dpiError__set(&error, "allocate buffer", DPI_ERR_NO_MEMORY);
         status = OCIRowidToChar(rowid->handle, (OraText*) rowid->buffer,
@@ -102,9 +104,10 @@ int dpiRowid_getStringValue(dpiRowid *rowid, const char **value,
         // UTF-16 is not handled properly (data is returned as ASCII instead)
         // adjust the buffer to use the correct encoding
         if (rowid->env->charsetId == DPI_CHARSET_ID_UTF16) {
-            adjustedBuffer = malloc(rowid->bufferLength * 2);
+            adjustedBuffer = dpiUtils__allocateMemory(rowid->env, 2,
+                    rowid->bufferLength, 0);
             if (!adjustedBuffer) {
-                free(rowid->buffer);
+                dpiUtils__freeMemory(rowid->env, rowid->buffer);
                 rowid->bufferLength = 0;
                 rowid->buffer = NULL;
                 return DPI_FAILURE;
@@ -113,7 +116,7 @@ int dpiRowid_getStringValue(dpiRowid *rowid, const char **value,
             targetPtr = (uint16_t*) adjustedBuffer;
             for (i = 0; i < rowid->bufferLength; i++)
                 *targetPtr++ = *sourcePtr++;
-            free(rowid->buffer);
+            dpiUtils__freeMemory(rowid->env, rowid->buffer);
             rowid->buffer = adjustedBuffer;
             rowid->bufferLength *= 2;
         }
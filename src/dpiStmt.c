@@ -17,14 +17,29 @@
 #include "dpiImpl.h"
 
 // forward declarations of internal functions only used in this file
+static int dpiStmt__canReuseBindVar(dpiVar *var,
+        dpiNativeTypeNum nativeTypeNum, dpiData *data);
+static int dpiStmt__createBindVar(dpiStmt *stmt,
+        dpiNativeTypeNum nativeTypeNum, dpiData *data, dpiVar **var,
+        uint32_t pos, const char *name, uint32_t nameLength, dpiError *error);
+static dpiBindVar *dpiStmt__findBindVar(dpiStmt *stmt, uint32_t pos,
+        const char *name, uint32_t nameLength);
 static int dpiStmt__getQueryInfo(dpiStmt *stmt, uint32_t pos,
         dpiQueryInfo *info, dpiError *error);
 static int dpiStmt__getQueryInfoFromParam(dpiStmt *stmt, OCIParam *param,
         dpiQueryInfo *info, dpiError *error);
+static int dpiStmt__isCacheable(dpiStmt *stmt);
+static int dpiStmt__lookupQueryInfo(dpiStmt *stmt, const char *sql,
+        uint32_t sqlLength, uint32_t numQueryVars, dpiError *error);
+static int dpiStmt__postExecute(dpiStmt *stmt, uint32_t numIters,
+        uint32_t mode, int reExecute, sword status, dpiError *error);
 static int dpiStmt__postFetch(dpiStmt *stmt, dpiError *error);
+static int dpiStmt__preExecute(dpiStmt *stmt, dpiError *error);
 static int dpiStmt__preFetch(dpiStmt *stmt, dpiError *error);
 static int dpiStmt__reExecute(dpiStmt *stmt, uint32_t numIters,
         dpiExecMode mode, dpiError *error);
+static int dpiStmt__returnToCache(dpiStmt *stmt, const char *tag,
+        uint32_t tagLength, dpiError *error);
 
 
 //-----------------------------------------------------------------------------
@@ -41,6 +56,7 @@ int dpiStmt__allocate(dpiConn *conn, int scrollable, dpiStmt **stmt,
     if (dpiGen__allocate(DPI_HTYPE_STMT, conn->env, (void**) &tempStmt,
             error) < 0)
         return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempStmt, conn->memoryCounters);
     if (dpiGen__setRefCount(conn, error, 1) < 0) {
         dpiStmt__free(tempStmt, error);
         return DPI_FAILURE;
@@ -63,7 +79,7 @@ static int dpiStmt__bind(dpiStmt *stmt, dpiVar *var, int addReference,
 {
     dpiBindVar *bindVars, *entry;
     OCIBind *bindHandle = NULL;
-    int found, dynamicBind;
+    int dynamicBind;
     sword status;
     uint32_t i;
 
@@ -73,19 +89,10 @@ static int dpiStmt__bind(dpiStmt *stmt, dpiVar *var, int addReference,
                 DPI_ERR_NOT_SUPPORTED);
 
     // check to see if the bind position or name has already been bound
-    found = 0;
-    for (i = 0; i < stmt->numBindVars; i++) {
-        entry = &stmt->bindVars[i];
-        if (entry->pos == pos && entry->nameLength == nameLength) {
-            if (nameLength > 0 && strncmp(entry->name, name, nameLength) != 0)
-                continue;
-            found = 1;
-            break;
-        }
-    }
+    entry = dpiStmt__findBindVar(stmt, pos, name, nameLength);
 
     // if already found, use that entry
-    if (found) {
+    if (entry) {
 
         // if already bound, no need to bind a second time
         if (entry->var == var)
@@ -95,6 +102,7 @@ static int dpiStmt__bind(dpiStmt *stmt, dpiVar *var, int addReference,
         else if (entry->var) {
             dpiGen__setRefCount(entry->var, error, -1);
             entry->var = NULL;
+            entry->isAutoCreated = 0;
         }
 
     // if not found, add to the list of bind variables
@@ -102,14 +110,15 @@ static int dpiStmt__bind(dpiStmt *stmt, dpiVar *var, int addReference,
 
         // allocate memory for additional bind variables, if needed
         if (stmt->numBindVars == stmt->allocatedBindVars) {
-            bindVars = calloc(stmt->allocatedBindVars + 8, sizeof(dpiBindVar));
+            bindVars = dpiUtils__allocateMemory(stmt->env,
+                    stmt->allocatedBindVars + 8, sizeof(dpiBindVar), 1);
             if (!bindVars)
                 return dpiError__set(error, "allocate bind vars",
                         DPI_ERR_NO_MEMORY);
             if (stmt->bindVars) {
                 for (i = 0; i < stmt->numBindVars; i++)
                     bindVars[i] = stmt->bindVars[i];
-                free(stmt->bindVars);
+                dpiUtils__freeMemory(stmt->env, stmt->bindVars);
             }
             stmt->bindVars = bindVars;
             stmt->allocatedBindVars += 8;
@@ -119,8 +128,10 @@ static int dpiStmt__bind(dpiStmt *stmt, dpiVar *var, int addReference,
         entry = &stmt->bindVars[stmt->numBindVars];
         entry->var = NULL;
         entry->pos = pos;
+        entry->isAutoCreated = 0;
         if (name) {
-            entry->name = malloc(nameLength);
+            entry->name = dpiUtils__allocateMemory(stmt->env, 1, nameLength,
+                    0);
             if (!entry->name)
                 return dpiError__set(error, "allocate memory for name",
                         DPI_ERR_NO_MEMORY);
@@ -208,6 +219,170 @@ static int dpiStmt__bind(dpiStmt *stmt, dpiVar *var, int addReference,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__bindValue() [INTERNAL]
+//   Bind a value to the statement using either a position or a name. The
+// variable created to hold the value is retained by the statement and its
+// value is overwritten in place on subsequent calls when the native type and
+// size still fit; since the buffer address does not change, the OCI bind does
+// not need to be performed again. Otherwise, a new variable is created and
+// bound.
+//-----------------------------------------------------------------------------
+static int dpiStmt__bindValue(dpiStmt *stmt, uint32_t pos, const char *name,
+        uint32_t nameLength, dpiNativeTypeNum nativeTypeNum, dpiData *data,
+        dpiError *error)
+{
+    dpiBindVar *entry;
+    dpiVar *var;
+
+    // reuse the variable previously created for this bind, if possible
+    entry = dpiStmt__findBindVar(stmt, pos, name, nameLength);
+    if (entry && entry->isAutoCreated && entry->var &&
+            dpiStmt__canReuseBindVar(entry->var, nativeTypeNum, data))
+        return dpiVar__copyData(entry->var, 0, data, error);
+
+    // otherwise, create a new variable and bind it to the statement
+    if (dpiStmt__createBindVar(stmt, nativeTypeNum, data, &var, pos, name,
+            nameLength, error) < 0)
+        return DPI_FAILURE;
+    entry = dpiStmt__findBindVar(stmt, pos, name, nameLength);
+    if (entry)
+        entry->isAutoCreated = 1;
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__cacheQueryInfo() [INTERNAL]
+//   Add the query information for the statement to the query information
+// cache so that subsequent executions of the same SQL can avoid describing
+// each of the columns. Queries containing object columns are not cached since
+// object types are specific to a connection. Failure to cache the information
+// is not considered an error.
+//-----------------------------------------------------------------------------
+static void dpiStmt__cacheQueryInfo(dpiStmt *stmt, const char *sql,
+        uint32_t sqlLength, dpiError *error)
+{
+    dpiQueryInfoCache *cache = stmt->conn->queryInfoCache;
+    dpiQueryInfoCacheEntry entry, evictedEntry;
+    size_t namesLength, infoLength;
+    int evicted = 0, found = 0;
+    dpiQueryInfo *info;
+    char *names;
+    uint32_t i;
+
+    // determine the amount of memory required for the column names
+    namesLength = 0;
+    for (i = 0; i < stmt->numQueryVars; i++) {
+        if (stmt->queryInfo[i].objectType)
+            return;
+        namesLength += stmt->queryInfo[i].nameLength;
+    }
+
+    // copy the query information and the column names into a single block of
+    // memory so that it can be copied in one operation when used
+    infoLength = stmt->numQueryVars * sizeof(dpiQueryInfo);
+    entry.queryInfoSize = infoLength + namesLength;
+    entry.queryInfo = dpiUtils__allocateMemory(stmt->env, 1,
+            entry.queryInfoSize, 0);
+    if (!entry.queryInfo)
+        return;
+    memcpy(entry.queryInfo, stmt->queryInfo, infoLength);
+    names = (char*) entry.queryInfo + infoLength;
+    for (i = 0; i < stmt->numQueryVars; i++) {
+        info = &entry.queryInfo[i];
+        if (info->nameLength > 0)
+            memcpy(names, info->name, info->nameLength);
+        info->name = names;
+        names += info->nameLength;
+    }
+    entry.numQueryVars = stmt->numQueryVars;
+    entry.sql = dpiUtils__allocateMemory(stmt->env, 1, sqlLength, 0);
+    if (!entry.sql) {
+        dpiUtils__freeMemory(stmt->env, entry.queryInfo);
+        return;
+    }
+    memcpy(entry.sql, sql, sqlLength);
+    entry.sqlLength = sqlLength;
+
+    // add the entry to the cache unless another statement has already done
+    // so, evicting the least recently used entry if the cache is full
+    if (dpiEnv__acquireMutex(stmt->env, error) < 0) {
+        dpiUtils__freeMemory(stmt->env, entry.queryInfo);
+        dpiUtils__freeMemory(stmt->env, entry.sql);
+        return;
+    }
+    for (i = 0; i < cache->numEntries; i++) {
+        if (cache->entries[i].sqlLength == sqlLength &&
+                memcmp(cache->entries[i].sql, sql, sqlLength) == 0) {
+            found = 1;
+            break;
+        }
+    }
+    if (!found) {
+        if (cache->numEntries == cache->capacity) {
+            evictedEntry = cache->entries[0];
+            cache->numEntries--;
+            memmove(cache->entries, cache->entries + 1,
+                    cache->numEntries * sizeof(dpiQueryInfoCacheEntry));
+            evicted = 1;
+        }
+        cache->entries[cache->numEntries++] = entry;
+    }
+    dpiEnv__releaseMutex(stmt->env, error);
+
+    // free the entry that was not added or the entry that was evicted
+    if (found) {
+        dpiUtils__freeMemory(stmt->env, entry.queryInfo);
+        dpiUtils__freeMemory(stmt->env, entry.sql);
+    }
+    if (evicted) {
+        dpiUtils__freeMemory(stmt->env, evictedEntry.queryInfo);
+        dpiUtils__freeMemory(stmt->env, evictedEntry.sql);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__canCacheVar() [INTERNAL]
+//   Return a boolean indicating if the variable can be retained in the
+// statement cache. While cached, variables give up their reference to the
+// connection so only variables referenced solely by the statement and which
+// do not reference any other handles are retained.
+//-----------------------------------------------------------------------------
+static int dpiStmt__canCacheVar(dpiStmt *stmt, dpiVar *var)
+{
+    return (var->refCount == 1 && var->conn == stmt->conn &&
+            !var->references && !var->objectType);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__canReuseBindVar() [INTERNAL]
+//   Return a boolean indicating if the variable that was created for a bind
+// value can hold the new value that is being bound.
+//-----------------------------------------------------------------------------
+static int dpiStmt__canReuseBindVar(dpiVar *var,
+        dpiNativeTypeNum nativeTypeNum, dpiData *data)
+{
+    if (var->nativeTypeNum != nativeTypeNum)
+        return 0;
+    if (data->isNull)
+        return 1;
+    switch (nativeTypeNum) {
+        case DPI_NATIVE_TYPE_BYTES:
+            return (var->isDynamic ||
+                    data->value.asBytes.length <= var->sizeInBytes);
+        case DPI_NATIVE_TYPE_OBJECT:
+            return (data->value.asObject &&
+                    data->value.asObject->type == var->objectType);
+        default:
+            break;
+    }
+    return 1;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__checkOpen() [INTERNAL]
 //   Determine if the statement is open and available for use.
@@ -221,6 +396,9 @@ static int dpiStmt__checkOpen(dpiStmt *stmt, const char *fnName,
         return dpiError__set(error, "check closed", DPI_ERR_STMT_CLOSED);
     if (!stmt->conn->handle)
         return dpiError__set(error, "check connection", DPI_ERR_NOT_CONNECTED);
+    if (stmt->conn->asyncOp != DPI_ASYNC_OP_NONE)
+        return dpiError__set(error, "check async operation",
+                DPI_ERR_ASYNC_OPERATION_PENDING);
     if (stmt->statementType == 0 && dpiStmt__init(stmt, error) < 0)
         return DPI_FAILURE;
     return DPI_SUCCESS;
@@ -234,7 +412,7 @@ static int dpiStmt__checkOpen(dpiStmt *stmt, const char *fnName,
 static void dpiStmt__clearBatchErrors(dpiStmt *stmt, dpiError *error)
 {
     if (stmt->batchErrors) {
-        free(stmt->batchErrors);
+        dpiUtils__freeMemory(stmt->env, stmt->batchErrors);
         stmt->batchErrors = NULL;
     }
     stmt->numBatchErrors = 0;
@@ -253,9 +431,10 @@ static void dpiStmt__clearBindVars(dpiStmt *stmt, dpiError *error)
         for (i = 0; i < stmt->numBindVars; i++) {
             dpiGen__setRefCount(stmt->bindVars[i].var, error, -1);
             if (stmt->bindVars[i].name)
-                free( (void*) stmt->bindVars[i].name);
+                dpiUtils__freeMemory(stmt->env,
+                        (void*) stmt->bindVars[i].name);
         }
-        free(stmt->bindVars);
+        dpiUtils__freeMemory(stmt->env, stmt->bindVars);
         stmt->bindVars = NULL;
     }
     stmt->numBindVars = 0;
@@ -282,11 +461,11 @@ static void dpiStmt__clearQueryVars(dpiStmt *stmt, dpiError *error)
                 stmt->queryInfo[i].objectType = NULL;
             }
         }
-        free(stmt->queryVars);
+        dpiUtils__freeMemory(stmt->env, stmt->queryVars);
         stmt->queryVars = NULL;
     }
     if (stmt->queryInfo) {
-        free(stmt->queryInfo);
+        dpiUtils__freeMemory(stmt->env, stmt->queryInfo);
         stmt->queryInfo = NULL;
     }
     stmt->numQueryVars = 0;
@@ -296,19 +475,31 @@ static void dpiStmt__clearQueryVars(dpiStmt *stmt, dpiError *error)
 //-----------------------------------------------------------------------------
 // dpiStmt__close() [INTERNAL]
 //   Internal method used for closing the statement. If the statement is marked
-// as needing to be dropped from the statement cache that is done as well. This
-// is called from dpiStmt_close() where errors are expected to be propagated
-// and from dpiStmt__free() where errors are ignored.
+// as needing to be dropped from the statement cache that is done as well. A
+// statement that cannot be returned to the connection's statement cache is
+// released instead. This is called from dpiStmt_close() where errors are
+// expected to be propagated and from dpiStmt__free() where errors are ignored.
 //-----------------------------------------------------------------------------
 static int dpiStmt__close(dpiStmt *stmt, const char *tag,
         uint32_t tagLength, int propagateErrors, dpiError *error)
 {
+    int cached = 0;
     uint32_t mode;
     sword status;
 
+    if (stmt->conn && stmt->conn->asyncStmt == stmt)
+        dpiConn__cancelAsync(stmt->conn, error);
     dpiStmt__clearBatchErrors(stmt, error);
-    dpiStmt__clearBindVars(stmt, error);
-    dpiStmt__clearQueryVars(stmt, error);
+
+    // return the statement to the cache, if possible; if that fails, the
+    // statement still owns all of its resources and is released normally
+    if (dpiStmt__isCacheable(stmt) &&
+            dpiStmt__returnToCache(stmt, tag, tagLength, error) == DPI_SUCCESS)
+        cached = 1;
+    if (!cached) {
+        dpiStmt__clearBindVars(stmt, error);
+        dpiStmt__clearQueryVars(stmt, error);
+    }
     if (stmt->handle) {
         if (stmt->isOwned)
             status = OCIHandleFree(stmt->handle, OCI_HTYPE_STMT);
@@ -323,6 +514,14 @@ static int dpiStmt__close(dpiStmt *stmt, const char *tag,
                 "close statement") < 0)
             return DPI_FAILURE;
     }
+    if (stmt->sql) {
+        dpiUtils__freeMemory(stmt->env, stmt->sql);
+        stmt->sql = NULL;
+    }
+    if (stmt->tag) {
+        dpiUtils__freeMemory(stmt->env, stmt->tag);
+        stmt->tag = NULL;
+    }
     if (stmt->conn) {
         dpiGen__setRefCount(stmt->conn, error, -1);
         stmt->conn = NULL;
@@ -332,6 +531,35 @@ static int dpiStmt__close(dpiStmt *stmt, const char *tag,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__completeFetch() [INTERNAL]
+//   Performs the work that needs to be done once the call to OCI fetching
+// rows has completed with the given status.
+//-----------------------------------------------------------------------------
+static int dpiStmt__completeFetch(dpiStmt *stmt, sword status,
+        dpiError *error)
+{
+    // check the status of the fetch
+    if (status == OCI_NO_DATA)
+        stmt->hasRowsToFetch = 0;
+    else if (dpiError__check(error, status, stmt->conn, "fetch") < 0)
+        return DPI_FAILURE;
+
+    // determine the number of rows fetched into buffers
+    status = OCIAttrGet(stmt->handle, OCI_HTYPE_STMT, &stmt->bufferRowCount, 0,
+            OCI_ATTR_ROWS_FETCHED, error->handle);
+    if (dpiError__check(error, status, stmt->conn, "get rows fetched") < 0)
+        return DPI_FAILURE;
+
+    // set buffer row info
+    stmt->bufferMinRow = stmt->rowCount + 1;
+    stmt->bufferRowIndex = 0;
+
+    // perform post-fetch activities required
+    return dpiStmt__postFetch(stmt, error);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__createBindVar() [INTERNAL]
 //   Create a bind variable given a value to bind.
@@ -402,6 +630,34 @@ static int dpiStmt__createBindVar(dpiStmt *stmt,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__createQueryInfoCache() [INTERNAL]
+//   Create a cache of query information keyed by SQL text, capable of holding
+// the specified number of entries.
+//-----------------------------------------------------------------------------
+int dpiStmt__createQueryInfoCache(dpiEnv *env, uint32_t capacity,
+        dpiQueryInfoCache **cache, dpiError *error)
+{
+    dpiQueryInfoCache *tempCache;
+
+    tempCache = dpiUtils__allocateMemory(env, 1, sizeof(dpiQueryInfoCache),
+            1);
+    if (!tempCache)
+        return dpiError__set(error, "allocate query info cache",
+                DPI_ERR_NO_MEMORY);
+    tempCache->entries = dpiUtils__allocateMemory(env, capacity,
+            sizeof(dpiQueryInfoCacheEntry), 1);
+    if (!tempCache->entries) {
+        dpiUtils__freeMemory(env, tempCache);
+        return dpiError__set(error, "allocate query info cache entries",
+                DPI_ERR_NO_MEMORY);
+    }
+    tempCache->capacity = capacity;
+    *cache = tempCache;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__createQueryVars() [INTERNAL]
 //   Create space for the number of query variables required to support the
@@ -409,8 +665,9 @@ static int dpiStmt__createBindVar(dpiStmt *stmt,
 //-----------------------------------------------------------------------------
 static int dpiStmt__createQueryVars(dpiStmt *stmt, dpiError *error)
 {
-    uint32_t numQueryVars, i;
+    uint32_t numQueryVars, sqlLength, i;
     sword status;
+    char *sql;
 
     // determine number of query variables
     status = OCIAttrGet(stmt->handle, OCI_HTYPE_STMT, (dvoid*) &numQueryVars,
@@ -424,24 +681,53 @@ static int dpiStmt__createQueryVars(dpiStmt *stmt, dpiError *error)
 
     // allocate space for the query vars, if needed
     if (numQueryVars != stmt->numQueryVars) {
-        stmt->queryVars = calloc(numQueryVars, sizeof(dpiVar*));
+        stmt->queryVars = dpiUtils__allocateMemory(stmt->env, numQueryVars,
+                sizeof(dpiVar*), 1);
         if (!stmt->queryVars)
             return dpiError__set(error, "allocate query vars",
                     DPI_ERR_NO_MEMORY);
-        stmt->queryInfo = calloc(numQueryVars, sizeof(dpiQueryInfo));
-        if (!stmt->queryInfo) {
-            dpiStmt__clearQueryVars(stmt, error);
-            return dpiError__set(error, "allocate query info",
-                    DPI_ERR_NO_MEMORY);
-        }
-        stmt->numQueryVars = numQueryVars;
-        for (i = 0; i < numQueryVars; i++) {
-            if (dpiStmt__getQueryInfo(stmt, i + 1, &stmt->queryInfo[i],
-                    error) < 0) {
+
+        // check the query information cache, if one is being used
+        sql = NULL;
+        sqlLength = 0;
+        if (stmt->conn->queryInfoCache && !stmt->isOwned) {
+            status = OCIAttrGet(stmt->handle, OCI_HTYPE_STMT, &sql,
+                    &sqlLength, OCI_ATTR_STATEMENT, error->handle);
+            if (dpiError__check(error, status, stmt->conn,
+                    "get statement") < 0) {
+                dpiStmt__clearQueryVars(stmt, error);
+                return DPI_FAILURE;
+            }
+            if (sql && sqlLength > 0 && dpiStmt__lookupQueryInfo(stmt, sql,
+                    sqlLength, numQueryVars, error) < 0) {
                 dpiStmt__clearQueryVars(stmt, error);
                 return DPI_FAILURE;
             }
         }
+
+        // if not found in the cache, describe each of the columns and add
+        // the results to the cache, if applicable
+        if (stmt->queryInfo)
+            stmt->numQueryVars = numQueryVars;
+        else {
+            stmt->queryInfo = dpiUtils__allocateMemory(stmt->env,
+                    numQueryVars, sizeof(dpiQueryInfo), 1);
+            if (!stmt->queryInfo) {
+                dpiStmt__clearQueryVars(stmt, error);
+                return dpiError__set(error, "allocate query info",
+                        DPI_ERR_NO_MEMORY);
+            }
+            stmt->numQueryVars = numQueryVars;
+            for (i = 0; i < numQueryVars; i++) {
+                if (dpiStmt__getQueryInfo(stmt, i + 1, &stmt->queryInfo[i],
+                        error) < 0) {
+                    dpiStmt__clearQueryVars(stmt, error);
+                    return DPI_FAILURE;
+                }
+            }
+            if (sql && sqlLength > 0)
+                dpiStmt__cacheQueryInfo(stmt, sql, sqlLength, error);
+        }
     }
 
     // indicate start of fetch
@@ -460,6 +746,7 @@ static int dpiStmt__createQueryVars(dpiStmt *stmt, dpiError *error)
 int dpiStmt__define(dpiStmt *stmt, uint32_t pos, dpiVar *var, dpiError *error)
 {
     OCIDefine *defineHandle = NULL;
+    boolean lobPrefetchLength = 1;
     sword status;
 
     // no need to perform define if variable is unchanged
@@ -487,6 +774,19 @@ int dpiStmt__define(dpiStmt *stmt, uint32_t pos, dpiVar *var, dpiError *error)
             return DPI_FAILURE;
     }
 
+    // for LOBs, prefetch the length along with the locator so that it can be
+    // determined without a round trip
+    if (var->type->oracleType == SQLT_CLOB ||
+            var->type->oracleType == SQLT_BLOB ||
+            var->type->oracleType == SQLT_BFILE) {
+        status = OCIAttrSet(defineHandle, OCI_HTYPE_DEFINE,
+                (dvoid*) &lobPrefetchLength, 0, OCI_ATTR_LOBPREFETCH_LENGTH,
+                error->handle);
+        if (dpiError__check(error, status, stmt->conn,
+                "set LOB prefetch length") < 0)
+            return DPI_FAILURE;
+    }
+
     // define objects, if applicable
     if (var->objectIndicator) {
         status = OCIDefineObject(defineHandle, error->handle,
@@ -525,88 +825,21 @@ int dpiStmt__define(dpiStmt *stmt, uint32_t pos, dpiVar *var, dpiError *error)
 static int dpiStmt__execute(dpiStmt *stmt, uint32_t numIters,
         uint32_t mode, int reExecute, dpiError *error)
 {
-    uint32_t prefetchSize, i, j;
     sword status;
-    dpiVar *var;
-
-    // for all bound variables, transfer data from dpiData structure to Oracle
-    // buffer structures
-    for (i = 0; i < stmt->numBindVars; i++) {
-        var = stmt->bindVars[i].var;
-        for (j = 0; j < var->maxArraySize; j++) {
-            if (dpiVar__setValue(var, j, &var->externalData[j], error) < 0)
-                return DPI_FAILURE;
-        }
-        if (stmt->isReturning || var->isDynamic)
-            var->error = error;
-    }
-
-    // for queries, set the prefetch rows to the fetch array size in order to
-    // avoid the network round trip for the first fetch
-    if (stmt->statementType == OCI_STMT_SELECT) {
-        status = OCIAttrSet(stmt->handle, OCI_HTYPE_STMT,
-                &stmt->fetchArraySize, sizeof(stmt->fetchArraySize),
-                OCI_ATTR_PREFETCH_ROWS, error->handle);
-        if (dpiError__check(error, status, stmt->conn,
-                "set prefetch rows") < 0)
-            return DPI_FAILURE;
-    }
 
-    // clear batch errors from any previous execution
-    dpiStmt__clearBatchErrors(stmt, error);
+    // perform any pre-execute activities required
+    if (dpiStmt__preExecute(stmt, error) < 0)
+        return DPI_FAILURE;
 
     // adjust mode for scrollable cursors
     if (stmt->scrollable)
         mode |= OCI_STMT_SCROLLABLE_READONLY;
 
-    // perform execution
-    // re-execute statement for ORA-01007: variable not in select list
-    // drop statement from cache for all but ORA-00001: unique key violated
+    // perform execution and any post-execute activities required
     status = OCIStmtExecute(stmt->conn->handle, stmt->handle, error->handle,
             numIters, 0, 0, 0, mode);
-    if (dpiError__check(error, status, stmt->conn, "execute") < 0) {
-        OCIAttrGet(stmt->handle, OCI_HTYPE_STMT, &error->buffer->offset, 0,
-                OCI_ATTR_PARSE_ERROR_OFFSET, error->handle);
-        if (reExecute && error->buffer->code == 1007)
-            return dpiStmt__reExecute(stmt, numIters, mode, error);
-        else if (error->buffer->code != 1)
-            stmt->deleteFromCache = 1;
-        return DPI_FAILURE;
-    }
-
-    // for all bound variables, transfer data from Oracle buffer structures to
-    // dpiData structures; OCI doesn't provide a way of knowing if a variable
-    // is an out variable so do this for all of them when this is a possibility
-    if (stmt->isReturning || stmt->statementType == OCI_STMT_BEGIN ||
-            stmt->statementType == OCI_STMT_DECLARE ||
-            stmt->statementType == OCI_STMT_CALL) {
-        for (i = 0; i < stmt->numBindVars; i++) {
-            var = stmt->bindVars[i].var;
-            for (j = 0; j < var->maxArraySize; j++) {
-                if (dpiVar__getValue(var, j, &var->externalData[j],
-                        error) < 0)
-                    return DPI_FAILURE;
-            }
-            var->error = NULL;
-        }
-    }
-
-    // determine number of query columns (for queries)
-    // reset prefetch rows to 0 as subsequent fetches can fetch directly into
-    // the defined fetch areas
-    if (stmt->statementType == OCI_STMT_SELECT) {
-        if (dpiStmt__createQueryVars(stmt, error) < 0)
-            return DPI_FAILURE;
-        prefetchSize = 0;
-        status = OCIAttrSet(stmt->handle, OCI_HTYPE_STMT, &prefetchSize,
-                sizeof(prefetchSize), OCI_ATTR_PREFETCH_ROWS,
-                error->handle);
-        if (dpiError__check(error, status, stmt->conn,
-                "reset prefetch rows") < 0)
-            return DPI_FAILURE;
-    }
-
-    return DPI_SUCCESS;
+    return dpiStmt__postExecute(stmt, numIters, mode, reExecute, status,
+            error);
 }
 
 
@@ -622,29 +855,33 @@ static int dpiStmt__fetch(dpiStmt *stmt, dpiError *error)
     if (dpiStmt__preFetch(stmt, error) < 0)
         return DPI_FAILURE;
 
-    // perform fetch
+    // perform fetch and any post-fetch activities required
     status = OCIStmtFetch2(stmt->handle, error->handle,
             stmt->fetchArraySize, OCI_FETCH_NEXT, 0, OCI_DEFAULT);
-    if (status == OCI_NO_DATA)
-        stmt->hasRowsToFetch = 0;
-    else if (dpiError__check(error, status, stmt->conn, "fetch") < 0)
-        return DPI_FAILURE;
-
-    // determine the number of rows fetched into buffers
-    status = OCIAttrGet(stmt->handle, OCI_HTYPE_STMT, &stmt->bufferRowCount, 0,
-            OCI_ATTR_ROWS_FETCHED, error->handle);
-    if (dpiError__check(error, status, stmt->conn, "get rows fetched") < 0)
-        return DPI_FAILURE;
+    return dpiStmt__completeFetch(stmt, status, error);
+}
 
-    // set buffer row info
-    stmt->bufferMinRow = stmt->rowCount + 1;
-    stmt->bufferRowIndex = 0;
 
-    // perform post-fetch activities required
-    if (dpiStmt__postFetch(stmt, error) < 0)
-        return DPI_FAILURE;
+//-----------------------------------------------------------------------------
+// dpiStmt__findBindVar() [INTERNAL]
+//   Return the entry for the specified bind position or name, or NULL if the
+// position or name has not been bound yet.
+//-----------------------------------------------------------------------------
+static dpiBindVar *dpiStmt__findBindVar(dpiStmt *stmt, uint32_t pos,
+        const char *name, uint32_t nameLength)
+{
+    dpiBindVar *entry;
+    uint32_t i;
 
-    return DPI_SUCCESS;
+    for (i = 0; i < stmt->numBindVars; i++) {
+        entry = &stmt->bindVars[i];
+        if (entry->pos == pos && entry->nameLength == nameLength) {
+            if (nameLength > 0 && strncmp(entry->name, name, nameLength) != 0)
+                continue;
+            return entry;
+        }
+    }
+    return NULL;
 }
 
 
@@ -654,8 +891,9 @@ static int dpiStmt__fetch(dpiStmt *stmt, dpiError *error)
 //-----------------------------------------------------------------------------
 void dpiStmt__free(dpiStmt *stmt, dpiError *error)
 {
+    dpiGen__updateMemoryStats(stmt, -1);
     dpiStmt__close(stmt, NULL, 0, 0, error);
-    free(stmt);
+    dpiGen__free(stmt, error);
 }
 
 
@@ -680,7 +918,8 @@ static int dpiStmt__getBatchErrors(dpiStmt *stmt, dpiError *error)
         return DPI_FAILURE;
 
     // allocate memory for the batch errors
-    stmt->batchErrors = calloc(stmt->numBatchErrors, sizeof(dpiErrorBuffer));
+    stmt->batchErrors = dpiUtils__allocateMemory(stmt->env,
+            stmt->numBatchErrors, sizeof(dpiErrorBuffer), 1);
     if (!stmt->batchErrors) {
         stmt->numBatchErrors = 0;
         return dpiError__set(error, "allocate errors", DPI_ERR_NO_MEMORY);
@@ -751,6 +990,49 @@ static int dpiStmt__getBatchErrors(dpiStmt *stmt, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__freeQueryInfoCache() [INTERNAL]
+//   Free the query information cache and all of its entries.
+//-----------------------------------------------------------------------------
+void dpiStmt__freeQueryInfoCache(dpiEnv *env, dpiQueryInfoCache *cache)
+{
+    uint32_t i;
+
+    for (i = 0; i < cache->numEntries; i++) {
+        dpiUtils__freeMemory(env, cache->entries[i].queryInfo);
+        dpiUtils__freeMemory(env, cache->entries[i].sql);
+    }
+    dpiUtils__freeMemory(env, cache->entries);
+    dpiUtils__freeMemory(env, cache);
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__getBufferedRows() [INTERNAL]
+//   Return up to the requested number of rows from those that have already
+// been fetched into buffers.
+//-----------------------------------------------------------------------------
+static void dpiStmt__getBufferedRows(dpiStmt *stmt, uint32_t maxRows,
+        uint32_t *bufferRowIndex, uint32_t *numRowsFetched, int *moreRows)
+{
+    if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
+        *moreRows = 0;
+        *bufferRowIndex = 0;
+        *numRowsFetched = 0;
+        return;
+    }
+    *bufferRowIndex = stmt->bufferRowIndex;
+    *numRowsFetched = stmt->bufferRowCount - stmt->bufferRowIndex;
+    *moreRows = stmt->hasRowsToFetch;
+    if (*numRowsFetched > maxRows) {
+        *numRowsFetched = maxRows;
+        *moreRows = 1;
+    }
+    stmt->bufferRowIndex += *numRowsFetched;
+    stmt->rowCount += *numRowsFetched;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__getQueryInfo() [INTERNAL]
 //   Get query information for the position in question.
@@ -863,43 +1145,215 @@ static int dpiStmt__getQueryInfoFromParam(dpiStmt *stmt, OCIParam *param,
         return DPI_FAILURE;
     info->nullOk = ociNullOk;
 
-    // determine object type, if applicable
-    if (ociDataType == SQLT_NTY) {
-        if (dpiObjectType__allocate(stmt->conn, param, OCI_ATTR_TYPE_NAME,
-                &info->objectType, error) < 0)
-            return DPI_FAILURE;
+    // determine object type, if applicable
+    if (ociDataType == SQLT_NTY) {
+        if (dpiObjectType__allocate(stmt->conn, param, OCI_ATTR_TYPE_NAME,
+                &info->objectType, error) < 0)
+            return DPI_FAILURE;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__init() [INTERNAL]
+//   Initialize the statement for use. This is needed when preparing a
+// statement for use and when returning a REF cursor.
+//-----------------------------------------------------------------------------
+int dpiStmt__init(dpiStmt *stmt, dpiError *error)
+{
+    sword status;
+
+    // get statement type
+    status = OCIAttrGet(stmt->handle, OCI_HTYPE_STMT,
+            (dvoid*) &stmt->statementType, 0, OCI_ATTR_STMT_TYPE,
+            error->handle);
+    if (dpiError__check(error, status, stmt->conn, "get statement type") < 0)
+        return DPI_FAILURE;
+
+    // for queries, mark statement as having rows to fetch
+    if (stmt->statementType == OCI_STMT_SELECT)
+        stmt->hasRowsToFetch = 1;
+
+    // otherwise, check if this is a RETURNING statement
+    else {
+        status = OCIAttrGet(stmt->handle, OCI_HTYPE_STMT,
+                (dvoid*) &stmt->isReturning, 0, OCI_ATTR_STMT_IS_RETURNING,
+                error->handle);
+        if (dpiError__check(error, status, stmt->conn, "get is returning") < 0)
+            return DPI_FAILURE;
+    }
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__invalidateQueryInfo() [INTERNAL]
+//   Remove the entry for the SQL text from the query information cache, if one
+// exists. This is done when the metadata for the query is known to have
+// changed.
+//-----------------------------------------------------------------------------
+static void dpiStmt__invalidateQueryInfo(dpiStmt *stmt, const char *sql,
+        uint32_t sqlLength, dpiError *error)
+{
+    dpiQueryInfoCache *cache = stmt->conn->queryInfoCache;
+    dpiQueryInfoCacheEntry removedEntry;
+    int found = 0;
+    uint32_t i;
+
+    if (dpiEnv__acquireMutex(stmt->env, error) < 0)
+        return;
+    for (i = 0; i < cache->numEntries; i++) {
+        if (cache->entries[i].sqlLength == sqlLength &&
+                memcmp(cache->entries[i].sql, sql, sqlLength) == 0) {
+            removedEntry = cache->entries[i];
+            cache->numEntries--;
+            memmove(&cache->entries[i], &cache->entries[i + 1],
+                    (cache->numEntries - i) * sizeof(dpiQueryInfoCacheEntry));
+            found = 1;
+            break;
+        }
+    }
+    dpiEnv__releaseMutex(stmt->env, error);
+    if (found) {
+        dpiUtils__freeMemory(stmt->env, removedEntry.queryInfo);
+        dpiUtils__freeMemory(stmt->env, removedEntry.sql);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__isCacheable() [INTERNAL]
+//   Return a boolean indicating if the statement can be returned to the
+// statement cache when it is closed. Statements that were not prepared by the
+// connection or that are bound to variables that cannot be retained by the
+// cache are released as usual.
+//-----------------------------------------------------------------------------
+static int dpiStmt__isCacheable(dpiStmt *stmt)
+{
+    uint32_t i;
+
+    if (!stmt->sql || !stmt->handle || stmt->isOwned ||
+            stmt->deleteFromCache || !stmt->conn || !stmt->conn->handle)
+        return 0;
+    for (i = 0; i < stmt->numBindVars; i++) {
+        if (!stmt->bindVars[i].var ||
+                !dpiStmt__canCacheVar(stmt, stmt->bindVars[i].var))
+            return 0;
+    }
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__lookupQueryInfo() [INTERNAL]
+//   Search the query information cache for an entry matching the SQL text and
+// number of columns. If one is found, a copy of its query information is made
+// for the statement and the entry is marked as the most recently used;
+// otherwise, the statement is left untouched and the columns are described as
+// usual.
+//-----------------------------------------------------------------------------
+static int dpiStmt__lookupQueryInfo(dpiStmt *stmt, const char *sql,
+        uint32_t sqlLength, uint32_t numQueryVars, dpiError *error)
+{
+    dpiQueryInfoCache *cache = stmt->conn->queryInfoCache;
+    dpiQueryInfoCacheEntry *entry, foundEntry;
+    dpiQueryInfo *queryInfo = NULL;
+    uint32_t i, j;
+
+    if (dpiEnv__acquireMutex(stmt->env, error) < 0)
+        return DPI_FAILURE;
+    for (i = cache->numEntries; i > 0; i--) {
+        entry = &cache->entries[i - 1];
+        if (entry->sqlLength != sqlLength ||
+                entry->numQueryVars != numQueryVars ||
+                memcmp(entry->sql, sql, sqlLength) != 0)
+            continue;
+
+        // copy the query information and adjust the names to point to the
+        // copy; if memory cannot be allocated the columns are simply
+        // described as usual
+        queryInfo = dpiUtils__allocateMemory(stmt->env, 1,
+                entry->queryInfoSize, 0);
+        if (queryInfo) {
+            memcpy(queryInfo, entry->queryInfo, entry->queryInfoSize);
+            for (j = 0; j < numQueryVars; j++)
+                queryInfo[j].name = (const char*) queryInfo +
+                        (queryInfo[j].name - (const char*) entry->queryInfo);
+        }
+
+        // move the entry to the end of the cache as most recently used
+        foundEntry = *entry;
+        memmove(entry, entry + 1,
+                (cache->numEntries - i) * sizeof(dpiQueryInfoCacheEntry));
+        cache->entries[cache->numEntries - 1] = foundEntry;
+        break;
+    }
+    if (dpiEnv__releaseMutex(stmt->env, error) < 0) {
+        if (queryInfo)
+            dpiUtils__freeMemory(stmt->env, queryInfo);
+        return DPI_FAILURE;
     }
 
+    stmt->queryInfo = queryInfo;
     return DPI_SUCCESS;
 }
 
 
 //-----------------------------------------------------------------------------
-// dpiStmt__init() [INTERNAL]
-//   Initialize the statement for use. This is needed when preparing a
-// statement for use and when returning a REF cursor.
+// dpiStmt__postExecute() [INTERNAL]
+//   Performs the work that needs to be done once the call to OCI executing a
+// statement has completed with the given status.
 //-----------------------------------------------------------------------------
-int dpiStmt__init(dpiStmt *stmt, dpiError *error)
+static int dpiStmt__postExecute(dpiStmt *stmt, uint32_t numIters,
+        uint32_t mode, int reExecute, sword status, dpiError *error)
 {
-    sword status;
+    uint32_t prefetchSize, i, j;
+    dpiVar *var;
 
-    // get statement type
-    status = OCIAttrGet(stmt->handle, OCI_HTYPE_STMT,
-            (dvoid*) &stmt->statementType, 0, OCI_ATTR_STMT_TYPE,
-            error->handle);
-    if (dpiError__check(error, status, stmt->conn, "get statement type") < 0)
+    // re-execute statement for ORA-01007: variable not in select list
+    // drop statement from cache for all but ORA-00001: unique key violated
+    if (dpiError__check(error, status, stmt->conn, "execute") < 0) {
+        OCIAttrGet(stmt->handle, OCI_HTYPE_STMT, &error->buffer->offset, 0,
+                OCI_ATTR_PARSE_ERROR_OFFSET, error->handle);
+        if (reExecute && error->buffer->code == 1007)
+            return dpiStmt__reExecute(stmt, numIters, mode, error);
+        else if (error->buffer->code != 1)
+            stmt->deleteFromCache = 1;
         return DPI_FAILURE;
+    }
 
-    // for queries, mark statement as having rows to fetch
-    if (stmt->statementType == OCI_STMT_SELECT)
-        stmt->hasRowsToFetch = 1;
+    // for all bound variables, transfer data from Oracle buffer structures to
+    // dpiData structures; OCI doesn't provide a way of knowing if a variable
+    // is an out variable so do this for all of them when this is a possibility
+    if (stmt->isReturning || stmt->statementType == OCI_STMT_BEGIN ||
+            stmt->statementType == OCI_STMT_DECLARE ||
+            stmt->statementType == OCI_STMT_CALL) {
+        for (i = 0; i < stmt->numBindVars; i++) {
+            var = stmt->bindVars[i].var;
+            for (j = 0; j < var->maxArraySize; j++) {
+                if (dpiVar__getValue(var, j, &var->externalData[j],
+                        error) < 0)
+                    return DPI_FAILURE;
+            }
+            var->error = NULL;
+        }
+    }
 
-    // otherwise, check if this is a RETURNING statement
-    else {
-        status = OCIAttrGet(stmt->handle, OCI_HTYPE_STMT,
-                (dvoid*) &stmt->isReturning, 0, OCI_ATTR_STMT_IS_RETURNING,
+    // determine number of query columns (for queries)
+    // reset prefetch rows to 0 as subsequent fetches can fetch directly into
+    // the defined fetch areas
+    if (stmt->statementType == OCI_STMT_SELECT) {
+        if (dpiStmt__createQueryVars(stmt, error) < 0)
+            return DPI_FAILURE;
+        prefetchSize = 0;
+        status = OCIAttrSet(stmt->handle, OCI_HTYPE_STMT, &prefetchSize,
+                sizeof(prefetchSize), OCI_ATTR_PREFETCH_ROWS,
                 error->handle);
-        if (dpiError__check(error, status, stmt->conn, "get is returning") < 0)
+        if (dpiError__check(error, status, stmt->conn,
+                "reset prefetch rows") < 0)
             return DPI_FAILURE;
     }
 
@@ -919,6 +1373,22 @@ static int dpiStmt__postFetch(dpiStmt *stmt, dpiError *error)
 
     for (i = 0; i < stmt->numQueryVars; i++) {
         var = stmt->queryVars[i];
+
+        // LOBs fetched as bytes are read for all rows in one round trip
+        if (var->nativeTypeNum == DPI_NATIVE_TYPE_BYTES &&
+                (var->type->oracleType == SQLT_CLOB ||
+                var->type->oracleType == SQLT_BLOB ||
+                var->type->oracleType == SQLT_BFILE)) {
+            if (stmt->bufferRowCount > 0) {
+                if (dpiVar__setBytesFromLobs(var, stmt->bufferRowCount,
+                        error) < 0)
+                    return DPI_FAILURE;
+                var->requiresPreFetch = 1;
+            }
+            var->error = NULL;
+            continue;
+        }
+
         for (j = 0; j < stmt->bufferRowCount; j++) {
             if (dpiVar__getValue(var, j, &var->externalData[j], error) < 0)
                 return DPI_FAILURE;
@@ -932,6 +1402,48 @@ static int dpiStmt__postFetch(dpiStmt *stmt, dpiError *error)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__preExecute() [INTERNAL]
+//   Performs the work that needs to be done before a statement is executed:
+// bound values are transferred to Oracle buffers and the prefetch rows are
+// set for queries.
+//-----------------------------------------------------------------------------
+static int dpiStmt__preExecute(dpiStmt *stmt, dpiError *error)
+{
+    uint32_t i, j;
+    sword status;
+    dpiVar *var;
+
+    // for all bound variables, transfer data from dpiData structure to Oracle
+    // buffer structures
+    for (i = 0; i < stmt->numBindVars; i++) {
+        var = stmt->bindVars[i].var;
+        for (j = 0; j < var->maxArraySize; j++) {
+            if (dpiVar__setValue(var, j, &var->externalData[j], error) < 0)
+                return DPI_FAILURE;
+        }
+        if (stmt->isReturning || var->isDynamic)
+            var->error = error;
+    }
+
+    // for queries, set the prefetch rows to the fetch array size in order to
+    // avoid the network round trip for the first fetch
+    if (stmt->statementType == OCI_STMT_SELECT) {
+        status = OCIAttrSet(stmt->handle, OCI_HTYPE_STMT,
+                &stmt->fetchArraySize, sizeof(stmt->fetchArraySize),
+                OCI_ATTR_PREFETCH_ROWS, error->handle);
+        if (dpiError__check(error, status, stmt->conn,
+                "set prefetch rows") < 0)
+            return DPI_FAILURE;
+    }
+
+    // clear batch errors from any previous execution
+    dpiStmt__clearBatchErrors(stmt, error);
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__preFetch() [INTERNAL]
 //   Performs work that needs to be done prior to fetch for each variable. In
@@ -948,6 +1460,7 @@ static int dpiStmt__preFetch(dpiStmt *stmt, dpiError *error)
 
     if (!stmt->queryInfo && dpiStmt__createQueryVars(stmt, error) < 0)
         return DPI_FAILURE;
+    stmt->queryVarsFromCache = 0;
     for (i = 0; i < stmt->numQueryVars; i++) {
         var = stmt->queryVars[i];
         if (!var) {
@@ -996,6 +1509,99 @@ int dpiStmt__prepare(dpiStmt *stmt, const char *sql, uint32_t sqlLength,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__prepareFromCache() [INTERNAL]
+//   Prepare a statement for execution, using a statement from the connection's
+// statement cache if one matching the SQL text, tag and scrollability is
+// available. The bind and query variables retained by the cache are restored
+// so the statement is ready to execute. The SQL text and tag are retained on
+// the statement so that it can be returned to the cache when it is closed.
+//-----------------------------------------------------------------------------
+int dpiStmt__prepareFromCache(dpiStmt *stmt, const char *sql,
+        uint32_t sqlLength, const char *tag, uint32_t tagLength,
+        dpiError *error)
+{
+    dpiStmtCacheEntry *entry, cachedEntry;
+    dpiConn *conn = stmt->conn;
+    int found = 0;
+    uint32_t i;
+
+    // if the cache is disabled, prepare the statement normally
+    if (conn->stmtCacheCapacity == 0 || !sql || sqlLength == 0)
+        return dpiStmt__prepare(stmt, sql, sqlLength, tag, tagLength, error);
+    if (!tag)
+        tagLength = 0;
+
+    // search the cache, starting with the most recently used entry, and
+    // remove the matching entry from the cache if one is found
+    if (dpiEnv__acquireMutex(conn->env, error) < 0)
+        return DPI_FAILURE;
+    for (i = conn->numStmtCacheEntries; i > 0; i--) {
+        entry = &conn->stmtCache[i - 1];
+        if (entry->sqlLength != sqlLength || entry->tagLength != tagLength ||
+                entry->scrollable != stmt->scrollable ||
+                memcmp(entry->sql, sql, sqlLength) != 0 ||
+                (tagLength > 0 && memcmp(entry->tag, tag, tagLength) != 0))
+            continue;
+        cachedEntry = *entry;
+        memmove(entry, entry + 1,
+                (conn->numStmtCacheEntries - i) * sizeof(dpiStmtCacheEntry));
+        conn->numStmtCacheEntries--;
+        found = 1;
+        break;
+    }
+    if (dpiEnv__releaseMutex(conn->env, error) < 0)
+        return DPI_FAILURE;
+
+    // if no entry was found, retain a copy of the SQL text and tag and
+    // prepare the statement normally
+    if (!found) {
+        stmt->sql = dpiUtils__allocateMemory(stmt->env, 1, sqlLength, 0);
+        if (!stmt->sql)
+            return dpiError__set(error, "allocate SQL", DPI_ERR_NO_MEMORY);
+        memcpy(stmt->sql, sql, sqlLength);
+        stmt->sqlLength = sqlLength;
+        if (tagLength > 0) {
+            stmt->tag = dpiUtils__allocateMemory(stmt->env, 1, tagLength, 0);
+            if (!stmt->tag)
+                return dpiError__set(error, "allocate tag",
+                        DPI_ERR_NO_MEMORY);
+            memcpy(stmt->tag, tag, tagLength);
+            stmt->tagLength = tagLength;
+        }
+        return dpiStmt__prepare(stmt, sql, sqlLength, tag, tagLength, error);
+    }
+
+    // restore the statement from the cache entry
+    stmt->sql = cachedEntry.sql;
+    stmt->sqlLength = cachedEntry.sqlLength;
+    stmt->tag = cachedEntry.tag;
+    stmt->tagLength = cachedEntry.tagLength;
+    stmt->handle = cachedEntry.handle;
+    stmt->statementType = cachedEntry.statementType;
+    stmt->isReturning = cachedEntry.isReturning;
+    stmt->hasRowsToFetch = (stmt->statementType == OCI_STMT_SELECT);
+    stmt->numQueryVars = cachedEntry.numQueryVars;
+    stmt->queryVars = cachedEntry.queryVars;
+    stmt->queryInfo = cachedEntry.queryInfo;
+    stmt->queryVarsFromCache = (stmt->numQueryVars > 0);
+    stmt->allocatedBindVars = cachedEntry.allocatedBindVars;
+    stmt->numBindVars = cachedEntry.numBindVars;
+    stmt->bindVars = cachedEntry.bindVars;
+
+    // the variables retained by the cache reacquire their reference to the
+    // connection
+    for (i = 0; i < stmt->numBindVars; i++)
+        dpiGen__setRefCount(conn, error, 1);
+    for (i = 0; i < stmt->numQueryVars; i++) {
+        if (stmt->queryVars[i])
+            dpiGen__setRefCount(conn, error, 1);
+    }
+
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt__reExecute() [INTERNAL]
 //   Re-execute the statement after receiving the error ORA-01007: variable not
@@ -1021,6 +1627,10 @@ static int dpiStmt__reExecute(dpiStmt *stmt, uint32_t numIters,
     if (status != OCI_SUCCESS)
         return DPI_FAILURE;
 
+    // the cached query information for the statement is no longer valid
+    if (stmt->conn->queryInfoCache)
+        dpiStmt__invalidateQueryInfo(stmt, sql, sqlLength, error);
+
     // prepare statement a second time before releasing the original statement;
     // release the original statement and delete it from the statement cache
     // so that it does not return with the invalid metadata; again, if this
@@ -1053,6 +1663,192 @@ static int dpiStmt__reExecute(dpiStmt *stmt, uint32_t numIters,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt__releaseCacheEntry() [INTERNAL]
+//   Release the resources held by an entry in the statement cache. This is
+// called when the entry is evicted from the cache and when the cache is
+// cleared as the connection is closed.
+//-----------------------------------------------------------------------------
+void dpiStmt__releaseCacheEntry(dpiEnv *env, dpiStmtCacheEntry *entry,
+        dpiError *error)
+{
+    uint32_t i;
+
+    // the variables retained by the cache no longer hold a reference to the
+    // connection so that reference must not be released when they are freed
+    if (entry->bindVars) {
+        for (i = 0; i < entry->numBindVars; i++) {
+            entry->bindVars[i].var->conn = NULL;
+            dpiGen__setRefCount(entry->bindVars[i].var, error, -1);
+            if (entry->bindVars[i].name)
+                dpiUtils__freeMemory(env, (void*) entry->bindVars[i].name);
+        }
+        dpiUtils__freeMemory(env, entry->bindVars);
+        entry->bindVars = NULL;
+    }
+    if (entry->queryVars) {
+        for (i = 0; i < entry->numQueryVars; i++) {
+            if (entry->queryVars[i]) {
+                entry->queryVars[i]->conn = NULL;
+                dpiGen__setRefCount(entry->queryVars[i], error, -1);
+            }
+        }
+        dpiUtils__freeMemory(env, entry->queryVars);
+        entry->queryVars = NULL;
+    }
+    if (entry->queryInfo) {
+        dpiUtils__freeMemory(env, entry->queryInfo);
+        entry->queryInfo = NULL;
+    }
+
+    // release the statement back to the OCI statement cache
+    if (entry->handle) {
+        OCIStmtRelease(entry->handle, error->handle, (text*) entry->tag,
+                entry->tagLength, OCI_DEFAULT);
+        entry->handle = NULL;
+    }
+    if (entry->sql) {
+        dpiUtils__freeMemory(env, entry->sql);
+        entry->sql = NULL;
+    }
+    if (entry->tag) {
+        dpiUtils__freeMemory(env, entry->tag);
+        entry->tag = NULL;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__returnToCache() [INTERNAL]
+//   Return the statement to the connection's statement cache, retaining its
+// bind variables and, where possible, its query variables. If the cache is
+// full, the least recently used entry is evicted. If the statement cannot be
+// returned to the cache it is left untouched and is closed normally.
+//-----------------------------------------------------------------------------
+static int dpiStmt__returnToCache(dpiStmt *stmt, const char *tag,
+        uint32_t tagLength, dpiError *error)
+{
+    dpiStmtCacheEntry *entry, evictedEntry;
+    dpiConn *conn = stmt->conn;
+    int evicted = 0;
+    char *tempTag;
+    uint32_t i;
+
+    // the tag specified when closing the statement takes precedence over the
+    // tag specified when the statement was prepared
+    if (tag && tagLength > 0) {
+        tempTag = dpiUtils__allocateMemory(stmt->env, 1, tagLength, 0);
+        if (!tempTag)
+            return dpiError__set(error, "allocate tag", DPI_ERR_NO_MEMORY);
+        memcpy(tempTag, tag, tagLength);
+        if (stmt->tag)
+            dpiUtils__freeMemory(stmt->env, stmt->tag);
+        stmt->tag = tempTag;
+        stmt->tagLength = tagLength;
+    }
+
+    // query variables are only retained if all of them can be retained;
+    // otherwise they are cleared and will be created again when needed
+    for (i = 0; i < stmt->numQueryVars; i++) {
+        if (stmt->queryInfo[i].objectType || (stmt->queryVars[i] &&
+                !dpiStmt__canCacheVar(stmt, stmt->queryVars[i]))) {
+            dpiStmt__clearQueryVars(stmt, error);
+            break;
+        }
+    }
+
+    // add an entry to the cache, evicting the least recently used entry if
+    // the cache is full
+    if (dpiEnv__acquireMutex(conn->env, error) < 0)
+        return DPI_FAILURE;
+    if (!conn->stmtCache) {
+        conn->stmtCache = dpiUtils__allocateMemory(conn->env,
+                conn->stmtCacheCapacity, sizeof(dpiStmtCacheEntry), 1);
+        if (!conn->stmtCache) {
+            dpiEnv__releaseMutex(conn->env, error);
+            return dpiError__set(error, "allocate statement cache",
+                    DPI_ERR_NO_MEMORY);
+        }
+    }
+    if (conn->numStmtCacheEntries == conn->stmtCacheCapacity) {
+        evictedEntry = conn->stmtCache[0];
+        conn->numStmtCacheEntries--;
+        memmove(conn->stmtCache, conn->stmtCache + 1,
+                conn->numStmtCacheEntries * sizeof(dpiStmtCacheEntry));
+        evicted = 1;
+    }
+    entry = &conn->stmtCache[conn->numStmtCacheEntries++];
+    entry->sql = stmt->sql;
+    entry->sqlLength = stmt->sqlLength;
+    entry->tag = stmt->tag;
+    entry->tagLength = stmt->tagLength;
+    entry->scrollable = stmt->scrollable;
+    entry->handle = stmt->handle;
+    entry->statementType = stmt->statementType;
+    entry->isReturning = stmt->isReturning;
+    entry->numQueryVars = stmt->numQueryVars;
+    entry->queryVars = stmt->queryVars;
+    entry->queryInfo = stmt->queryInfo;
+    entry->allocatedBindVars = stmt->allocatedBindVars;
+    entry->numBindVars = stmt->numBindVars;
+    entry->bindVars = stmt->bindVars;
+    dpiEnv__releaseMutex(conn->env, error);
+
+    // the variables retained by the cache give up their reference to the
+    // connection; this avoids a reference cycle between the connection and
+    // the variables held by its cache
+    for (i = 0; i < stmt->numBindVars; i++)
+        dpiGen__setRefCount(conn, error, -1);
+    for (i = 0; i < stmt->numQueryVars; i++) {
+        if (stmt->queryVars[i])
+            dpiGen__setRefCount(conn, error, -1);
+    }
+
+    // the statement no longer owns any of the transferred resources
+    stmt->sql = NULL;
+    stmt->sqlLength = 0;
+    stmt->tag = NULL;
+    stmt->tagLength = 0;
+    stmt->handle = NULL;
+    stmt->numQueryVars = 0;
+    stmt->queryVars = NULL;
+    stmt->queryInfo = NULL;
+    stmt->allocatedBindVars = 0;
+    stmt->numBindVars = 0;
+    stmt->bindVars = NULL;
+
+    // release the evicted entry, if applicable
+    if (evicted)
+        dpiStmt__releaseCacheEntry(conn->env, &evictedEntry, error);
+
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt__startAsync() [INTERNAL]
+//   Make sure the statement is open and determine whether the asynchronous
+// operation is being started or a pending one is being continued. Only the
+// operation that is pending on the connection may be continued.
+//-----------------------------------------------------------------------------
+static int dpiStmt__startAsync(dpiStmt *stmt, dpiAsyncOpType op,
+        const char *fnName, int *isPending, dpiError *error)
+{
+    if (dpiGen__startPublicFn(stmt, DPI_HTYPE_STMT, fnName, error) < 0)
+        return DPI_FAILURE;
+    if (!stmt->handle)
+        return dpiError__set(error, "check closed", DPI_ERR_STMT_CLOSED);
+    if (!stmt->conn->handle)
+        return dpiError__set(error, "check connection", DPI_ERR_NOT_CONNECTED);
+    if (dpiConn__startAsync(stmt->conn, op, stmt, isPending, error) < 0)
+        return DPI_FAILURE;
+    if (!*isPending && stmt->statementType == 0 &&
+            dpiStmt__init(stmt, error) < 0)
+        return DPI_FAILURE;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt_addRef() [PUBLIC]
 //   Add a reference to the statement.
@@ -1099,15 +1895,12 @@ int dpiStmt_bindByPos(dpiStmt *stmt, uint32_t pos, dpiVar *var)
 int dpiStmt_bindValueByName(dpiStmt *stmt, const char *name,
         uint32_t nameLength, dpiNativeTypeNum nativeTypeNum, dpiData *data)
 {
-    dpiVar *var = NULL;
     dpiError error;
 
     if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
         return DPI_FAILURE;
-    if (dpiStmt__createBindVar(stmt, nativeTypeNum, data, &var, 0, name,
-            nameLength, &error) < 0)
-        return DPI_FAILURE;
-    return dpiStmt_bindByName(stmt, name, nameLength, var);
+    return dpiStmt__bindValue(stmt, 0, name, nameLength, nativeTypeNum, data,
+            &error);
 }
 
 
@@ -1118,15 +1911,12 @@ int dpiStmt_bindValueByName(dpiStmt *stmt, const char *name,
 int dpiStmt_bindValueByPos(dpiStmt *stmt, uint32_t pos,
         dpiNativeTypeNum nativeTypeNum, dpiData *data)
 {
-    dpiVar *var = NULL;
     dpiError error;
 
     if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
         return DPI_FAILURE;
-    if (dpiStmt__createBindVar(stmt, nativeTypeNum, data, &var, pos, NULL, 0,
-            &error) < 0)
-        return DPI_FAILURE;
-    return dpiStmt_bindByPos(stmt, pos, var);
+    return dpiStmt__bindValue(stmt, pos, NULL, 0, nativeTypeNum, data,
+            &error);
 }
 
 
@@ -1190,6 +1980,49 @@ int dpiStmt_execute(dpiStmt *stmt, dpiExecMode mode, uint32_t *numQueryColumns)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiStmt_executeAsync() [PUBLIC]
+//   Execute a statement using the non-blocking mode of OCI. If the execution
+// has not completed when OCI returns control, the function must be called
+// again with the same arguments until it has; no other calls may be made on
+// the connection in the meantime.
+//-----------------------------------------------------------------------------
+int dpiStmt_executeAsync(dpiStmt *stmt, dpiExecMode mode,
+        uint32_t *numQueryColumns, int *isComplete)
+{
+    uint32_t numIters;
+    dpiError error;
+    int isPending;
+    sword status;
+
+    if (dpiStmt__startAsync(stmt, DPI_ASYNC_OP_EXECUTE, __func__, &isPending,
+            &error) < 0)
+        return DPI_FAILURE;
+    if (!isComplete)
+        return dpiError__set(&error, "check is complete pointer",
+                DPI_ERR_NULL_POINTER_PARAMETER, "isComplete");
+    numIters = (stmt->statementType == OCI_STMT_SELECT) ? 0 : 1;
+    if (stmt->scrollable)
+        mode |= OCI_STMT_SCROLLABLE_READONLY;
+    if (!isPending) {
+        if (dpiStmt__preExecute(stmt, &error) < 0)
+            return DPI_FAILURE;
+        if (dpiConn__setNonBlocking(stmt->conn, 1, &error) < 0)
+            return DPI_FAILURE;
+    }
+    status = OCIStmtExecute(stmt->conn->handle, stmt->handle, error.handle,
+            numIters, 0, 0, 0, mode);
+    dpiConn__finishAsync(stmt->conn, DPI_ASYNC_OP_EXECUTE, stmt, status,
+            isComplete, &error);
+    if (!*isComplete)
+        return DPI_SUCCESS;
+    if (dpiStmt__postExecute(stmt, numIters, mode, 1, status, &error) < 0)
+        return DPI_FAILURE;
+    *numQueryColumns = stmt->numQueryVars;
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiStmt_executeMany() [PUBLIC]
 //   Execute a statement multiple times. Queries are not supported. The bind
@@ -1273,25 +2106,60 @@ int dpiStmt_fetchRows(dpiStmt *stmt, uint32_t maxRows,
 
     if (dpiStmt__checkOpen(stmt, __func__, &error) < 0)
         return DPI_FAILURE;
-    if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
-        if (stmt->hasRowsToFetch && dpiStmt__fetch(stmt, &error) < 0)
-            return DPI_FAILURE;
-        if (stmt->bufferRowIndex >= stmt->bufferRowCount) {
-            *moreRows = 0;
-            *bufferRowIndex = 0;
-            *numRowsFetched = 0;
+    if (stmt->bufferRowIndex >= stmt->bufferRowCount &&
+            stmt->hasRowsToFetch && dpiStmt__fetch(stmt, &error) < 0)
+        return DPI_FAILURE;
+    dpiStmt__getBufferedRows(stmt, maxRows, bufferRowIndex, numRowsFetched,
+            moreRows);
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiStmt_fetchRowsAsync() [PUBLIC]
+//   Fetch rows into buffers using the non-blocking mode of OCI. Rows still
+// available in the buffers are returned immediately. Otherwise, if the fetch
+// has not completed when OCI returns control, the function must be called
+// again with the same arguments until it has; no other calls may be made on
+// the connection in the meantime.
+//-----------------------------------------------------------------------------
+int dpiStmt_fetchRowsAsync(dpiStmt *stmt, uint32_t maxRows,
+        uint32_t *bufferRowIndex, uint32_t *numRowsFetched, int *moreRows,
+        int *isComplete)
+{
+    dpiError error;
+    int isPending;
+    sword status;
+
+    if (dpiStmt__startAsync(stmt, DPI_ASYNC_OP_FETCH, __func__, &isPending,
+            &error) < 0)
+        return DPI_FAILURE;
+    if (!isComplete)
+        return dpiError__set(&error, "check is complete pointer",
+                DPI_ERR_NULL_POINTER_PARAMETER, "isComplete");
+    if (!isPending) {
+        if (stmt->bufferRowIndex < stmt->bufferRowCount ||
+                !stmt->hasRowsToFetch) {
+            *isComplete = 1;
+            dpiStmt__getBufferedRows(stmt, maxRows, bufferRowIndex,
+                    numRowsFetched, moreRows);
             return DPI_SUCCESS;
         }
+        if (dpiStmt__preFetch(stmt, &error) < 0)
+            return DPI_FAILURE;
+        if (dpiConn__setNonBlocking(stmt->conn, 1, &error) < 0)
+            return DPI_FAILURE;
     }
-    *bufferRowIndex = stmt->bufferRowIndex;
-    *numRowsFetched = stmt->bufferRowCount - stmt->bufferRowIndex;
-    *moreRows = stmt->hasRowsToFetch;
-    if (*numRowsFetched > maxRows) {
-        *numRowsFetched = maxRows;
-        *moreRows = 1;
-    }
-    stmt->bufferRowIndex += *numRowsFetched;
-    stmt->rowCount += *numRowsFetched;
+    status = OCIStmtFetch2(stmt->handle, error.handle, stmt->fetchArraySize,
+            OCI_FETCH_NEXT, 0, OCI_DEFAULT);
+    dpiConn__finishAsync(stmt->conn, DPI_ASYNC_OP_FETCH, stmt, status,
+            isComplete, &error);
+    if (!*isComplete)
+        return DPI_SUCCESS;
+    if (dpiStmt__completeFetch(stmt, status, &error) < 0)
+        return DPI_FAILURE;
+    dpiStmt__getBufferedRows(stmt, maxRows, bufferRowIndex, numRowsFetched,
+            moreRows);
     return DPI_SUCCESS;
 }
 
@@ -1764,9 +2632,19 @@ int dpiStmt_setFetchArraySize(dpiStmt *stmt, uint32_t arraySize)
         arraySize = DPI_DEFAULT_FETCH_ARRAY_SIZE;
     for (i = 0; i < stmt->numQueryVars; i++) {
         var = stmt->queryVars[i];
-        if (var && var->maxArraySize < arraySize)
+        if (var && var->maxArraySize < arraySize) {
+
+            // variables restored from the statement cache that have not been
+            // used for fetching yet are simply replaced when next needed
+            if (stmt->queryVarsFromCache && var->refCount == 1) {
+                dpiGen__setRefCount(var, &error, -1);
+                stmt->queryVars[i] = NULL;
+                continue;
+            }
+
             return dpiError__set(&error, "check array size",
                     DPI_ERR_ARRAY_SIZE_TOO_BIG, arraySize);
+        }
     }
     stmt->fetchArraySize = arraySize;
     return DPI_SUCCESS;
@@ -203,6 +203,7 @@ int dpiSubscr__create(dpiSubscr *subscr, dpiConn *conn,
 //-----------------------------------------------------------------------------
 void dpiSubscr__free(dpiSubscr *subscr, dpiError *error)
 {
+    dpiGen__updateMemoryStats(subscr, -1);
     if (subscr->handle) {
         OCISubscriptionUnRegister(subscr->conn->handle, subscr->handle,
                 error->handle, OCI_DEFAULT);
@@ -212,7 +213,7 @@ void dpiSubscr__free(dpiSubscr *subscr, dpiError *error)
         dpiGen__setRefCount(subscr->conn, error, -1);
         subscr->conn = NULL;
     }
-    free(subscr);
+    dpiGen__free(subscr, error);
 }
 
 
@@ -230,9 +231,9 @@ static void dpiSubscr__freeMessage(dpiSubscr *subscr,
     if (message->numTables > 0) {
         for (i = 0; i < message->numTables; i++) {
             if (message->tables[i].numRows > 0)
-                free(message->tables[i].rows);
+                dpiUtils__freeMemory(subscr->env, message->tables[i].rows);
         }
-        free(message->tables);
+        dpiUtils__freeMemory(subscr->env, message->tables);
     }
 
     // free the queries for the message
@@ -242,12 +243,13 @@ static void dpiSubscr__freeMessage(dpiSubscr *subscr,
             if (query->numTables > 0) {
                 for (j = 0; j < query->numTables; j++) {
                     if (query->tables[i].numRows > 0)
-                        free(query->tables[i].rows);
+                        dpiUtils__freeMemory(subscr->env,
+                                query->tables[i].rows);
                 }
-                free(query->tables);
+                dpiUtils__freeMemory(subscr->env, query->tables);
             }
         }
-        free(message->queries);
+        dpiUtils__freeMemory(subscr->env, message->queries);
     }
 }
 
@@ -281,7 +283,8 @@ static int dpiSubscr__populateObjectChangeMessage(dpiSubscr *subscr,
         return DPI_FAILURE;
 
     // allocate memory for table entries
-    message->tables = calloc(numTables, sizeof(dpiSubscrMessageTable));
+    message->tables = dpiUtils__allocateMemory(subscr->env, numTables,
+            sizeof(dpiSubscrMessageTable), 1);
     if (!message->tables)
         return dpiError__set(error, "allocate msg tables", DPI_ERR_NO_MEMORY);
     message->numTables = numTables;
@@ -380,7 +383,8 @@ static int dpiSubscr__populateMessageQuery(dpiSubscr *subscr,
         return DPI_FAILURE;
 
     // allocate memory for table entries
-    query->tables = calloc(numTables, sizeof(dpiSubscrMessageTable));
+    query->tables = dpiUtils__allocateMemory(subscr->env, numTables,
+            sizeof(dpiSubscrMessageTable), 1);
     if (!query->tables)
         return dpiError__set(error, "allocate query tables",
                 DPI_ERR_NO_MEMORY);
@@ -470,7 +474,8 @@ static int dpiSubscr__populateMessageTable(dpiSubscr *subscr,
         return DPI_FAILURE;
 
     // allocate memory for row entries
-    table->rows = calloc(numRows, sizeof(dpiSubscrMessageRow));
+    table->rows = dpiUtils__allocateMemory(subscr->env, numRows,
+            sizeof(dpiSubscrMessageRow), 1);
     if (!table->rows)
         return dpiError__set(error, "allocate rows", DPI_ERR_NO_MEMORY);
     table->numRows = numRows;
@@ -519,7 +524,8 @@ static int dpiSubscr__populateQueryChangeMessage(dpiSubscr *subscr,
         return DPI_FAILURE;
 
     // allocate memory for query entries
-    message->queries = calloc(numQueries, sizeof(dpiSubscrMessageQuery));
+    message->queries = dpiUtils__allocateMemory(subscr->env, numQueries,
+            sizeof(dpiSubscrMessageQuery), 1);
     if (!message->queries)
         return dpiError__set(error, "allocate queries", DPI_ERR_NO_MEMORY);
     message->numQueries = numQueries;
@@ -0,0 +1,279 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2016, 2017 Oracle and/or its affiliates.  All rights reserved.
+// This program is free software: you can modify it and/or redistribute it
+// under the terms of:
+//
+// (i)  the Universal Permissive License v 1.0 or at your option, any
+//      later version (http://oss.oracle.com/licenses/upl); and/or
+//
+// (ii) the Apache License v 2.0. (http://www.apache.org/licenses/LICENSE-2.0)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// dpiThread.c
+//   Thin wrappers over the native threads, mutexes and condition variables of
+// the platform. These are used where the OCI thread package is insufficient.
+//-----------------------------------------------------------------------------
+
+#include "dpiImpl.h"
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+// structure used for passing the procedure and its argument to a new thread
+typedef struct {
+    dpiEnv *env;
+    dpiThreadProc proc;
+    void *arg;
+} dpiThreadStartInfo;
+
+// forward declarations of internal functions only used in this file
+#ifdef _WIN32
+static unsigned __stdcall dpiThread__start(void *arg);
+#else
+static void *dpiThread__start(void *arg);
+#endif
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__acquireMutex() [INTERNAL]
+//   Acquire the mutex.
+//-----------------------------------------------------------------------------
+void dpiThread__acquireMutex(dpiMutexType *mutex)
+{
+#ifdef _WIN32
+    EnterCriticalSection(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__broadcastCondition() [INTERNAL]
+//   Wake all threads waiting on the condition.
+//-----------------------------------------------------------------------------
+void dpiThread__broadcastCondition(dpiConditionType *condition)
+{
+#ifdef _WIN32
+    WakeAllConditionVariable(condition);
+#else
+    pthread_cond_broadcast(condition);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__create() [INTERNAL]
+//   Create a new thread which calls the given procedure with the given
+// argument. The information passed to the thread is allocated from the
+// environment so that any allocator supplied by the application is used. A
+// negative value is returned if the thread cannot be created.
+//-----------------------------------------------------------------------------
+int dpiThread__create(dpiEnv *env, dpiThreadHandle *thread,
+        dpiThreadProc proc, void *arg)
+{
+    dpiThreadStartInfo *info;
+
+    info = dpiUtils__allocateMemory(env, 1, sizeof(dpiThreadStartInfo), 0);
+    if (!info)
+        return DPI_FAILURE;
+    info->env = env;
+    info->proc = proc;
+    info->arg = arg;
+#ifdef _WIN32
+    *thread = (HANDLE) _beginthreadex(NULL, 0, dpiThread__start, info, 0,
+            NULL);
+    if (!*thread) {
+        dpiUtils__freeMemory(env, info);
+        return DPI_FAILURE;
+    }
+#else
+    if (pthread_create(thread, NULL, dpiThread__start, info) != 0) {
+        dpiUtils__freeMemory(env, info);
+        return DPI_FAILURE;
+    }
+#endif
+    return DPI_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__destroyCondition() [INTERNAL]
+//   Destroy the condition variable.
+//-----------------------------------------------------------------------------
+void dpiThread__destroyCondition(dpiConditionType *condition)
+{
+#ifndef _WIN32
+    pthread_cond_destroy(condition);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__destroyMutex() [INTERNAL]
+//   Destroy the mutex.
+//-----------------------------------------------------------------------------
+void dpiThread__destroyMutex(dpiMutexType *mutex)
+{
+#ifdef _WIN32
+    DeleteCriticalSection(mutex);
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__getMonotonicTime() [INTERNAL]
+//   Return the value of a clock that is not affected by changes to the system
+// time, in microseconds. The value is only useful for measuring intervals.
+//-----------------------------------------------------------------------------
+uint64_t dpiThread__getMonotonicTime(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t) (counter.QuadPart / frequency.QuadPart) * 1000000 +
+            (uint64_t) (counter.QuadPart % frequency.QuadPart) * 1000000 /
+            frequency.QuadPart;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__initCondition() [INTERNAL]
+//   Initialize the condition variable.
+//-----------------------------------------------------------------------------
+void dpiThread__initCondition(dpiConditionType *condition)
+{
+#ifdef _WIN32
+    InitializeConditionVariable(condition);
+#else
+    pthread_cond_init(condition, NULL);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__initMutex() [INTERNAL]
+//   Initialize the mutex.
+//-----------------------------------------------------------------------------
+void dpiThread__initMutex(dpiMutexType *mutex)
+{
+#ifdef _WIN32
+    InitializeCriticalSection(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__join() [INTERNAL]
+//   Wait for the thread to terminate and release its resources.
+//-----------------------------------------------------------------------------
+void dpiThread__join(dpiThreadHandle thread)
+{
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__releaseMutex() [INTERNAL]
+//   Release the mutex.
+//-----------------------------------------------------------------------------
+void dpiThread__releaseMutex(dpiMutexType *mutex)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__signalCondition() [INTERNAL]
+//   Wake one of the threads waiting on the condition.
+//-----------------------------------------------------------------------------
+void dpiThread__signalCondition(dpiConditionType *condition)
+{
+#ifdef _WIN32
+    WakeConditionVariable(condition);
+#else
+    pthread_cond_signal(condition);
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__start() [INTERNAL]
+//   Entry point of all threads created by dpiThread__create().
+//-----------------------------------------------------------------------------
+#ifdef _WIN32
+static unsigned __stdcall dpiThread__start(void *arg)
+#else
+static void *dpiThread__start(void *arg)
+#endif
+{
+    dpiThreadStartInfo info = *((dpiThreadStartInfo*) arg);
+
+    dpiUtils__freeMemory(info.env, arg);
+    (*info.proc)(info.arg);
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiThread__waitCondition() [INTERNAL]
+//   Wait for the condition to be signalled. The mutex must be held by the
+// caller; it is released while waiting and acquired again before returning.
+// The timeout is in milliseconds; a value of 0 means wait indefinitely. As
+// with the underlying primitives, the caller must check its own state when
+// this function returns since wakeups can be spurious.
+//-----------------------------------------------------------------------------
+void dpiThread__waitCondition(dpiConditionType *condition,
+        dpiMutexType *mutex, uint32_t timeout)
+{
+#ifdef _WIN32
+    SleepConditionVariableCS(condition, mutex,
+            (timeout == 0) ? INFINITE : timeout);
+#else
+    struct timespec deadline;
+    struct timeval now;
+
+    if (timeout == 0) {
+        pthread_cond_wait(condition, mutex);
+        return;
+    }
+    gettimeofday(&now, NULL);
+    deadline.tv_sec = now.tv_sec + timeout / 1000;
+    deadline.tv_nsec = (long) now.tv_usec * 1000 +
+            (long) (timeout % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(condition, mutex, &deadline);
+#endif
+}
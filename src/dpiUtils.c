@@ -16,6 +16,29 @@
 
 #include "dpiImpl.h"
 
+//-----------------------------------------------------------------------------
+// dpiUtils__allocateMemory() [INTERNAL]
+//   Allocate memory for the specified number of members of the specified
+// size, using the allocator supplied when the environment was created, if one
+// was supplied. The memory is cleared if requested. NULL is returned if the
+// memory cannot be allocated.
+//-----------------------------------------------------------------------------
+void *dpiUtils__allocateMemory(dpiEnv *env, size_t numMembers,
+        size_t memberSize, int clearMemory)
+{
+    void *ptr;
+
+    if (!env || !env->allocator.allocate)
+        return (clearMemory) ? calloc(numMembers, memberSize) :
+                malloc(numMembers * memberSize);
+    ptr = (*env->allocator.allocate)(env->allocator.context,
+            numMembers * memberSize);
+    if (ptr && clearMemory)
+        memset(ptr, 0, numMembers * memberSize);
+    return ptr;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiUtils__clearMemory() [INTERNAL]
 //   Method for clearing memory that will not be optimised away by the
@@ -32,13 +55,29 @@ void dpiUtils__clearMemory(void *ptr, size_t length)
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiUtils__freeMemory() [INTERNAL]
+//   Free memory allocated by dpiUtils__allocateMemory() for the same
+// environment. NULL pointers are ignored.
+//-----------------------------------------------------------------------------
+void dpiUtils__freeMemory(dpiEnv *env, void *ptr)
+{
+    if (!ptr)
+        return;
+    if (!env || !env->allocator.free)
+        free(ptr);
+    else (*env->allocator.free)(env->allocator.context, ptr);
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiUtils__getAttrStringWithDup() [INTERNAL]
-//   Get the string attribute from the OCI and duplicate its contents.
+//   Get the string attribute from the OCI and duplicate its contents, using
+// memory allocated for the specified environment.
 //-----------------------------------------------------------------------------
-int dpiUtils__getAttrStringWithDup(dpiError *error, const char *context,
-        const void *ociHandle, uint32_t ociHandleType, uint32_t ociAttribute,
-        const char **value, uint32_t *valueLength)
+int dpiUtils__getAttrStringWithDup(dpiEnv *env, dpiError *error,
+        const char *context, const void *ociHandle, uint32_t ociHandleType,
+        uint32_t ociAttribute, const char **value, uint32_t *valueLength)
 {
     char *source, *temp;
     sword status;
@@ -47,7 +86,7 @@ int dpiUtils__getAttrStringWithDup(dpiError *error, const char *context,
             valueLength, ociAttribute, error->handle);
     if (dpiError__check(error, status, NULL, context) < 0)
         return DPI_FAILURE;
-    temp = malloc(*valueLength);
+    temp = dpiUtils__allocateMemory(env, 1, *valueLength, 0);
     if (!temp)
         return dpiError__set(error, context, DPI_ERR_NO_MEMORY);
     *value = memcpy(temp, source, *valueLength);
@@ -55,6 +94,44 @@ int dpiUtils__getAttrStringWithDup(dpiError *error, const char *context,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiUtils__getMemoryStats() [INTERNAL]
+//   Populate the memory statistics structure from the set of counters
+// maintained by an environment or context. The counters are read without
+// synchronization so a counter that is being adjusted concurrently may be
+// transiently negative; such counters are reported as zero.
+//-----------------------------------------------------------------------------
+void dpiUtils__getMemoryStats(const int64_t *counters, dpiMemoryStats *stats)
+{
+    uint64_t values[DPI_MEMORY_COUNTER_MAX];
+    int i;
+
+    for (i = 0; i < DPI_MEMORY_COUNTER_MAX; i++)
+        values[i] = (counters[i] < 0) ? 0 : (uint64_t) counters[i];
+    stats->numConns = values[DPI_HTYPE_CONN - DPI_HTYPE_NONE - 1];
+    stats->numPools = values[DPI_HTYPE_POOL - DPI_HTYPE_NONE - 1];
+    stats->numStmts = values[DPI_HTYPE_STMT - DPI_HTYPE_NONE - 1];
+    stats->numVars = values[DPI_HTYPE_VAR - DPI_HTYPE_NONE - 1];
+    stats->numLobs = values[DPI_HTYPE_LOB - DPI_HTYPE_NONE - 1];
+    stats->numObjects = values[DPI_HTYPE_OBJECT - DPI_HTYPE_NONE - 1];
+    stats->numObjectTypes = values[DPI_HTYPE_OBJECT_TYPE - DPI_HTYPE_NONE - 1];
+    stats->numObjectAttrs = values[DPI_HTYPE_OBJECT_ATTR - DPI_HTYPE_NONE - 1];
+    stats->numSubscrs = values[DPI_HTYPE_SUBSCR - DPI_HTYPE_NONE - 1];
+    stats->numDeqOptions = values[DPI_HTYPE_DEQ_OPTIONS - DPI_HTYPE_NONE - 1];
+    stats->numEnqOptions = values[DPI_HTYPE_ENQ_OPTIONS - DPI_HTYPE_NONE - 1];
+    stats->numMsgProps = values[DPI_HTYPE_MSG_PROPS - DPI_HTYPE_NONE - 1];
+    stats->numRowids = values[DPI_HTYPE_ROWID - DPI_HTYPE_NONE - 1];
+    stats->numExecutors = values[DPI_HTYPE_EXECUTOR - DPI_HTYPE_NONE - 1];
+    stats->numLobReaders = values[DPI_HTYPE_LOB_READER - DPI_HTYPE_NONE - 1];
+    stats->numLobWriters = values[DPI_HTYPE_LOB_WRITER - DPI_HTYPE_NONE - 1];
+    stats->handleBytes = values[DPI_MEMORY_COUNTER_HANDLE_BYTES];
+    stats->varBufferBytes = values[DPI_MEMORY_COUNTER_VAR_BUFFER_BYTES];
+    stats->dynamicBytes = values[DPI_MEMORY_COUNTER_DYNAMIC_BYTES];
+    stats->lobBufferBytes = values[DPI_MEMORY_COUNTER_LOB_BUFFER_BYTES];
+    stats->errorBufferBytes = dpiGlobal__getErrorBufferBytes();
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiUtils__parseNumberString() [INTERNAL]
 //   Parse the contents of a string that is supposed to contain a number. The
@@ -18,6 +18,7 @@
 
 // forward declarations of internal functions only used in this file
 static int dpiVar__initBuffers(dpiVar *var, dpiError *error);
+static size_t dpiVar__reserveBufferSpace(size_t *bufferSize, size_t size);
 static int dpiVar__setBytesFromDynamicBytes(dpiVar *var, dpiBytes *bytes,
         dpiDynamicBytes *dynBytes, dpiError *error);
 static int dpiVar__setBytesFromLob(dpiVar *var, dpiBytes *bytes,
@@ -81,6 +82,7 @@ int dpiVar__allocate(dpiConn *conn, dpiOracleTypeNum oracleTypeNum,
     if (dpiGen__allocate(DPI_HTYPE_VAR, conn->env, (void**) &tempVar,
             error) < 0)
         return DPI_FAILURE;
+    dpiGen__setMemoryOwner(tempVar, conn->memoryCounters);
 
     // basic initialization
     tempVar->maxArraySize = maxArraySize;
@@ -123,88 +125,154 @@ int dpiVar__allocate(dpiConn *conn, dpiOracleTypeNum oracleTypeNum,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiVar__allocateBlock() [INTERNAL]
+//   Allocate the block of memory from which the buffers of the variable are
+// carved. If the block is at least as large as the huge page threshold of the
+// connection, it is mapped directly and the kernel is advised to back it with
+// huge pages, which reduces TLB misses when large arrays are scanned. If
+// requested, the pages are also touched by the calling thread so that they are
+// placed on its NUMA node by the default first-touch policy. If the memory
+// cannot be mapped, it is allocated normally instead.
+//-----------------------------------------------------------------------------
+static int dpiVar__allocateBlock(dpiVar *var, size_t size, dpiError *error)
+{
+#ifdef DPI_USE_HUGE_PAGES
+    char *ptr;
+    size_t i;
+
+    if (var->conn && var->conn->hugePageThreshold > 0 &&
+            size >= var->conn->hugePageThreshold) {
+        ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr != MAP_FAILED) {
+            madvise(ptr, size, MADV_HUGEPAGE);
+            if (var->conn->prefaultHugePages) {
+                for (i = 0; i < size; i += DPI_PREFAULT_PAGE_SIZE)
+                    ptr[i] = 0;
+            }
+            var->buffer = ptr;
+            var->bufferSize = size;
+            var->isBufferMapped = 1;
+            dpiGen__updateMemoryCounter(var,
+                    DPI_MEMORY_COUNTER_VAR_BUFFER_BYTES, (int64_t) size);
+            return DPI_SUCCESS;
+        }
+    }
+#endif
+
+    var->buffer = dpiUtils__allocateMemory(var->env, 1, size, 0);
+    if (!var->buffer)
+        return dpiError__set(error, "allocate buffer", DPI_ERR_NO_MEMORY);
+    var->bufferSize = size;
+    var->isBufferMapped = 0;
+    dpiGen__updateMemoryCounter(var, DPI_MEMORY_COUNTER_VAR_BUFFER_BYTES,
+            (int64_t) size);
+    return DPI_SUCCESS;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiVar__allocateBuffers() [INTERNAL]
-//   Allocate buffers used for passing data to/from Oracle.
+//   Allocate buffers used for passing data to/from Oracle. The data buffer and
+// all of the other arrays sized by the maximum array size are carved from a
+// single block of memory so that only one allocation is required and the
+// arrays for each column are close together in memory. If the block has
+// already been allocated (the variable is being resized), only a new data
+// buffer is allocated; the arrays in the block are retained.
 //-----------------------------------------------------------------------------
 static int dpiVar__allocateBuffers(dpiVar *var, dpiError *error)
 {
+    size_t indicatorOffset, actualLengthOffset = 0, returnCodeOffset = 0;
+    size_t tempBufferOffset = 0, externalDataOffset, bufferSize = 0;
     uint32_t i, tempBufferSize = 0;
     unsigned long long dataLength;
     dpiBytes *bytes;
+    char *buffer;
 
-    // initialize dynamic buffers for dynamic variables
-    if (var->isDynamic) {
-        var->dynamicBytes = calloc(var->maxArraySize, sizeof(dpiDynamicBytes));
-        if (!var->dynamicBytes)
-            return dpiError__set(error, "allocate dynamic bytes",
-                    DPI_ERR_NO_MEMORY);
+    // validate length of data buffer for all but dynamic variables
+    dataLength = (var->isDynamic) ? 0 : (unsigned long long)
+            var->maxArraySize * (unsigned long long) var->sizeInBytes;
+    if (dataLength > INT_MAX)
+        return dpiError__set(error, "check max array size",
+                DPI_ERR_ARRAY_SIZE_TOO_BIG, var->maxArraySize);
 
-    // for all other variables, validate length and allocate buffers
-    } else {
-        dataLength = (unsigned long long) var->maxArraySize *
-                (unsigned long long) var->sizeInBytes;
-        if (dataLength > INT_MAX)
-            return dpiError__set(error, "check max array size",
-                    DPI_ERR_ARRAY_SIZE_TOO_BIG, var->maxArraySize);
-        var->data.asRaw = malloc((size_t) dataLength);
+    // for numbers transferred to/from Oracle as bytes, an additional set of
+    // buffers is required
+    if (var->type->oracleTypeNum == DPI_ORACLE_TYPE_NUMBER &&
+            var->nativeTypeNum == DPI_NATIVE_TYPE_BYTES) {
+        tempBufferSize = DPI_NUMBER_AS_TEXT_CHARS;
+        if (var->env->charsetId == DPI_CHARSET_ID_UTF16)
+            tempBufferSize *= 2;
+    }
+
+    // if the block has already been allocated, only the data buffer needs to
+    // be allocated; it is allocated separately from the block
+    if (var->buffer) {
+        var->data.asRaw = dpiUtils__allocateMemory(var->env, 1,
+                (size_t) dataLength, 0);
         if (!var->data.asRaw)
             return dpiError__set(error, "allocate buffer", DPI_ERR_NO_MEMORY);
-    }
+        dpiGen__updateMemoryCounter(var,
+                DPI_MEMORY_COUNTER_VAR_BUFFER_BYTES, (int64_t) dataLength);
 
-    // allocate the indicator for the variable
-    // ensure all values start out as null
-    if (!var->indicator) {
-        var->indicator = malloc(var->maxArraySize * sizeof(int16_t));
-        if (!var->indicator)
-            return dpiError__set(error, "allocate indicator",
-                    DPI_ERR_NO_MEMORY);
-        for (i = 0; i < var->maxArraySize; i++)
-            var->indicator[i] = OCI_IND_NULL;
-    }
+    // otherwise, determine the layout of the block and allocate it; the data
+    // buffer (or the dynamic bytes array for dynamic variables) always starts
+    // the block
+    } else {
+        if (var->isDynamic)
+            dpiVar__reserveBufferSpace(&bufferSize,
+                    var->maxArraySize * sizeof(dpiDynamicBytes));
+        else dpiVar__reserveBufferSpace(&bufferSize, (size_t) dataLength);
+        indicatorOffset = dpiVar__reserveBufferSpace(&bufferSize,
+                var->maxArraySize * sizeof(int16_t));
+        if (!var->isDynamic)
+            actualLengthOffset = dpiVar__reserveBufferSpace(&bufferSize,
+                    var->maxArraySize * sizeof(DPI_ACTUAL_LENGTH_TYPE));
+        if (var->type->defaultNativeTypeNum == DPI_NATIVE_TYPE_BYTES &&
+                !var->isDynamic)
+            returnCodeOffset = dpiVar__reserveBufferSpace(&bufferSize,
+                    var->maxArraySize * sizeof(uint16_t));
+        if (tempBufferSize > 0)
+            tempBufferOffset = dpiVar__reserveBufferSpace(&bufferSize,
+                    var->maxArraySize * tempBufferSize);
+        externalDataOffset = dpiVar__reserveBufferSpace(&bufferSize,
+                var->maxArraySize * sizeof(dpiData));
+        if (dpiVar__allocateBlock(var, bufferSize, error) < 0)
+            return DPI_FAILURE;
+        buffer = var->buffer;
 
-    // allocate the actual length buffers for all but dynamic bytes which are
-    // handled differently; ensure actual length starts out as maximum value
-    if (!var->isDynamic && !var->actualLength) {
-        var->actualLength = (DPI_ACTUAL_LENGTH_TYPE *)
-                malloc(var->maxArraySize * sizeof(DPI_ACTUAL_LENGTH_TYPE));
-        if (!var->actualLength)
-            return dpiError__set(error, "allocate actual length",
-                    DPI_ERR_NO_MEMORY);
-        for (i = 0; i < var->maxArraySize; i++)
-            var->actualLength[i] = var->sizeInBytes;
-    }
+        // initialize dynamic buffers for dynamic variables
+        if (var->isDynamic) {
+            var->dynamicBytes = (dpiDynamicBytes*) buffer;
+            memset(var->dynamicBytes, 0,
+                    var->maxArraySize * sizeof(dpiDynamicBytes));
+        } else var->data.asRaw = buffer;
 
-    // for variable length data, also allocate the return code array
-    if (var->type->defaultNativeTypeNum == DPI_NATIVE_TYPE_BYTES &&
-            !var->isDynamic && !var->returnCode) {
-        var->returnCode = malloc(var->maxArraySize * sizeof(uint16_t));
-        if (!var->returnCode)
-            return dpiError__set(error, "allocate return code",
-                    DPI_ERR_NO_MEMORY);
-    }
+        // ensure all values start out as null
+        var->indicator = (int16_t*) (buffer + indicatorOffset);
+        for (i = 0; i < var->maxArraySize; i++)
+            var->indicator[i] = OCI_IND_NULL;
 
-    // for numbers transferred to/from Oracle as bytes, allocate an additional
-    // set of buffers
-    if (var->type->oracleTypeNum == DPI_ORACLE_TYPE_NUMBER &&
-            var->nativeTypeNum == DPI_NATIVE_TYPE_BYTES) {
-        tempBufferSize = DPI_NUMBER_AS_TEXT_CHARS;
-        if (var->env->charsetId == DPI_CHARSET_ID_UTF16)
-            tempBufferSize *= 2;
-        if (!var->tempBuffer) {
-            var->tempBuffer = malloc(tempBufferSize * var->maxArraySize);
-            if (!var->tempBuffer)
-                return dpiError__set(error, "allocate temp buffer",
-                        DPI_ERR_NO_MEMORY);
+        // the actual length buffers are used for all but dynamic bytes which
+        // are handled differently; ensure actual length starts out as maximum
+        // value
+        if (actualLengthOffset > 0) {
+            var->actualLength =
+                    (DPI_ACTUAL_LENGTH_TYPE*) (buffer + actualLengthOffset);
+            for (i = 0; i < var->maxArraySize; i++)
+                var->actualLength[i] = var->sizeInBytes;
         }
-    }
 
-    // allocate the external data array, if needed
-    if (!var->externalData) {
-        var->externalData = calloc(var->maxArraySize, sizeof(dpiData));
-        if (!var->externalData)
-            return dpiError__set(error, "allocate external data",
-                    DPI_ERR_NO_MEMORY);
+        // for variable length data, the return code array is also used
+        if (returnCodeOffset > 0)
+            var->returnCode = (uint16_t*) (buffer + returnCodeOffset);
+        if (tempBufferOffset > 0)
+            var->tempBuffer = buffer + tempBufferOffset;
+
+        // the external data array starts out with all values null
+        var->externalData = (dpiData*) (buffer + externalDataOffset);
+        memset(var->externalData, 0, var->maxArraySize * sizeof(dpiData));
         for (i = 0; i < var->maxArraySize; i++)
             var->externalData[i].isNull = 1;
     }
@@ -231,19 +299,21 @@ static int dpiVar__allocateBuffers(dpiVar *var, dpiError *error)
 // dpiVar__allocateChunks() [INTERNAL]
 //   Allocate more chunks for handling dynamic bytes.
 //-----------------------------------------------------------------------------
-static int dpiVar__allocateChunks(dpiDynamicBytes *dynBytes, dpiError *error)
+static int dpiVar__allocateChunks(dpiVar *var, dpiDynamicBytes *dynBytes,
+        dpiError *error)
 {
     dpiDynamicBytesChunk *chunks;
     uint32_t allocatedChunks;
 
     allocatedChunks = dynBytes->allocatedChunks + 8;
-    chunks = calloc(allocatedChunks, sizeof(dpiDynamicBytesChunk));
+    chunks = dpiUtils__allocateMemory(var->env, allocatedChunks,
+            sizeof(dpiDynamicBytesChunk), 1);
     if (!chunks)
         return dpiError__set(error, "allocate chunks", DPI_ERR_NO_MEMORY);
     if (dynBytes->chunks) {
         memcpy(chunks, dynBytes->chunks,
                 dynBytes->numChunks * sizeof(dpiDynamicBytesChunk));
-        free(dynBytes->chunks);
+        dpiUtils__freeMemory(var->env, dynBytes->chunks);
     }
     dynBytes->chunks = chunks;
     dynBytes->allocatedChunks = allocatedChunks;
@@ -257,29 +327,36 @@ static int dpiVar__allocateChunks(dpiDynamicBytes *dynBytes, dpiError *error)
 // bytes. When complete, there will be exactly one allocated chunk of the
 // specified size or greater in the dynamic bytes structure.
 //-----------------------------------------------------------------------------
-static int dpiVar__allocateDynamicBytes(dpiDynamicBytes *dynBytes,
-        uint32_t size, dpiError *error)
+static int dpiVar__allocateDynamicBytes(dpiVar *var,
+        dpiDynamicBytes *dynBytes, uint32_t size, dpiError *error)
 {
     // if an error occurs, none of the original space is valid
     dynBytes->numChunks = 0;
 
     // if there are no chunks at all, make sure some exist
     if (dynBytes->allocatedChunks == 0 &&
-            dpiVar__allocateChunks(dynBytes, error) < 0)
+            dpiVar__allocateChunks(var, dynBytes, error) < 0)
         return DPI_FAILURE;
 
     // at this point there should be 0 or 1 chunks as any retrieval that
     // resulted in multiple chunks would have been consolidated already
     // make sure that chunk has enough space in it
     if (size > dynBytes->chunks->allocatedLength) {
-        if (dynBytes->chunks->ptr)
-            free(dynBytes->chunks->ptr);
+        if (dynBytes->chunks->ptr) {
+            dpiUtils__freeMemory(var->env, dynBytes->chunks->ptr);
+            dpiGen__updateMemoryCounter(var,
+                    DPI_MEMORY_COUNTER_DYNAMIC_BYTES,
+                    -(int64_t) dynBytes->chunks->allocatedLength);
+        }
         dynBytes->chunks->allocatedLength =
                 (size + DPI_DYNAMIC_BYTES_CHUNK_SIZE - 1) &
                         ~(DPI_DYNAMIC_BYTES_CHUNK_SIZE - 1);
-        dynBytes->chunks->ptr = malloc(dynBytes->chunks->allocatedLength);
+        dynBytes->chunks->ptr = dpiUtils__allocateMemory(var->env, 1,
+                dynBytes->chunks->allocatedLength, 0);
         if (!dynBytes->chunks->ptr)
             return dpiError__set(error, "allocate chunk", DPI_ERR_NO_MEMORY);
+        dpiGen__updateMemoryCounter(var, DPI_MEMORY_COUNTER_DYNAMIC_BYTES,
+                dynBytes->chunks->allocatedLength);
     }
 
     return DPI_SUCCESS;
@@ -363,13 +440,14 @@ int dpiVar__convertToLob(dpiVar *var, dpiError *error)
     if (dpiVar__initBuffers(var, error) < 0)
         return DPI_FAILURE;
 
-    // copy any values already set
+    // copy any values already set; the temporary LOBs were just allocated
+    // and are known to be empty so they do not need to be trimmed first
     for (i = 0; i < var->maxArraySize; i++) {
         dynBytes = &var->dynamicBytes[i];
         lob = var->references[i].asLOB;
-        if (dynBytes->numChunks == 0)
+        if (dynBytes->numChunks == 0 || dynBytes->chunks->length == 0)
             continue;
-        if (dpiLob__setFromBytes(lob, dynBytes->chunks->ptr,
+        if (dpiLob__writeBytes(lob, 1, dynBytes->chunks->ptr,
                 dynBytes->chunks->length, error) < 0)
             return DPI_FAILURE;
     }
@@ -437,18 +515,21 @@ int32_t dpiVar__defineCallback(dpiVar *var, OCIDefine *defnp, uint32_t iter,
     // allocate more chunks, if necessary
     bytes = &var->dynamicBytes[iter];
     if (bytes->numChunks == bytes->allocatedChunks &&
-            dpiVar__allocateChunks(bytes, var->error) < 0)
+            dpiVar__allocateChunks(var, bytes, var->error) < 0)
         return DPI_FAILURE;
 
     // allocate memory for the chunk, if needed
     chunk = &bytes->chunks[bytes->numChunks];
     if (!chunk->ptr) {
         chunk->allocatedLength = DPI_DYNAMIC_BYTES_CHUNK_SIZE;
-        chunk->ptr = malloc(chunk->allocatedLength);
+        chunk->ptr = dpiUtils__allocateMemory(var->env, 1,
+                chunk->allocatedLength, 0);
         if (!chunk->ptr) {
             dpiError__set(var->error, "allocate buffer", DPI_ERR_NO_MEMORY);
             return OCI_ERROR;
         }
+        dpiGen__updateMemoryCounter(var, DPI_MEMORY_COUNTER_DYNAMIC_BYTES,
+                chunk->allocatedLength);
     }
 
     // return chunk to OCI
@@ -472,8 +553,8 @@ static int dpiVar__extendedInitialize(dpiVar *var, dpiError *error)
 
     // create array of references, if applicable
     if (var->type->requiresPreFetch && !var->isDynamic) {
-        var->references = calloc(var->maxArraySize,
-                sizeof(dpiReferenceBuffer));
+        var->references = dpiUtils__allocateMemory(var->env,
+                var->maxArraySize, sizeof(dpiReferenceBuffer), 1);
         if (!var->references)
             return dpiError__set(error, "allocate references",
                     DPI_ERR_NO_MEMORY);
@@ -517,7 +598,8 @@ static int dpiVar__extendedInitialize(dpiVar *var, dpiError *error)
             if (!var->objectType)
                 return dpiError__set(error, "check object type",
                         DPI_ERR_NO_OBJECT_TYPE);
-            var->objectIndicator = malloc(var->maxArraySize * sizeof(void*));
+            var->objectIndicator = dpiUtils__allocateMemory(var->env,
+                    var->maxArraySize, sizeof(void*), 0);
             if (!var->objectIndicator)
                 return dpiError__set(error, "allocate object indicator",
                         DPI_ERR_NO_MEMORY);
@@ -583,14 +665,16 @@ int dpiVar__extendedPreFetch(dpiVar *var, dpiError *error)
                 }
                 var->data.asLobLocator[i] = NULL;
                 data->value.asLOB = NULL;
-                if (dpiLob__allocate(var->conn, var->type, &lob, error) < 0)
+                if (var->dynamicBytes) {
+                    if (dpiLob__allocateTemporary(var->conn, var->type, &lob,
+                            error) < 0)
+                        return DPI_FAILURE;
+                } else if (dpiLob__allocate(var->conn, var->type, &lob,
+                        error) < 0)
                     return DPI_FAILURE;
                 var->references[i].asLOB = lob;
                 var->data.asLobLocator[i] = lob->locator;
                 data->value.asLOB = lob;
-                if (var->dynamicBytes &&
-                        dpiLob__createTemporary(lob, error) < 0)
-                    return DPI_FAILURE;
             }
             break;
         case DPI_ORACLE_TYPE_ROWID:
@@ -636,6 +720,7 @@ int dpiVar__extendedPreFetch(dpiVar *var, dpiError *error)
 //-----------------------------------------------------------------------------
 static void dpiVar__finalizeBuffers(dpiVar *var, dpiError *error)
 {
+    dpiDynamicBytesChunk *chunk;
     dpiDynamicBytes *dynBytes;
     uint32_t i, j;
 
@@ -677,7 +762,7 @@ static void dpiVar__finalizeBuffers(dpiVar *var, dpiError *error)
                 var->references[i].asHandle = NULL;
             }
         }
-        free(var->references);
+        dpiUtils__freeMemory(var->env, var->references);
         var->references = NULL;
     }
 
@@ -687,55 +772,65 @@ static void dpiVar__finalizeBuffers(dpiVar *var, dpiError *error)
             dynBytes = &var->dynamicBytes[i];
             if (dynBytes->allocatedChunks > 0) {
                 for (j = 0; j < dynBytes->allocatedChunks; j++) {
-                    if (dynBytes->chunks[j].ptr) {
-                        free(dynBytes->chunks[j].ptr);
-                        dynBytes->chunks[j].ptr = NULL;
+                    chunk = &dynBytes->chunks[j];
+                    if (chunk->ptr) {
+                        dpiUtils__freeMemory(var->env, chunk->ptr);
+                        dpiGen__updateMemoryCounter(var,
+                                DPI_MEMORY_COUNTER_DYNAMIC_BYTES,
+                                -(int64_t) chunk->allocatedLength);
+                        chunk->ptr = NULL;
                     }
                 }
-                free(dynBytes->chunks);
+                dpiUtils__freeMemory(var->env, dynBytes->chunks);
                 dynBytes->allocatedChunks = 0;
                 dynBytes->chunks = NULL;
             }
         }
-        free(var->dynamicBytes);
         var->dynamicBytes = NULL;
     }
 
-    // free other memory allocated
-    if (var->indicator) {
-        free(var->indicator);
-        var->indicator = NULL;
-    }
-    if (var->returnCode) {
-        free(var->returnCode);
-        var->returnCode = NULL;
-    }
-    if (var->actualLength) {
-        free(var->actualLength);
-        var->actualLength = NULL;
-    }
+    // free other memory allocated; the data buffer is only freed separately
+    // if it was allocated separately from the block when the variable was
+    // resized
 #if DPI_ORACLE_CLIENT_VERSION_HEX < DPI_ORACLE_CLIENT_VERSION(12,1)
     if (var->dynamicActualLength) {
-        free(var->dynamicActualLength);
+        dpiUtils__freeMemory(var->env, var->dynamicActualLength);
         var->dynamicActualLength = NULL;
     }
 #endif
-    if (var->externalData) {
-        free(var->externalData);
-        var->externalData = NULL;
-    }
-    if (var->data.asRaw) {
-        free(var->data.asRaw);
-        var->data.asRaw = NULL;
-    }
     if (var->objectIndicator) {
-        free(var->objectIndicator);
+        dpiUtils__freeMemory(var->env, var->objectIndicator);
         var->objectIndicator = NULL;
     }
-    if (var->tempBuffer) {
-        free(var->tempBuffer);
-        var->tempBuffer = NULL;
+    if (var->data.asRaw && var->data.asRaw != var->buffer) {
+        dpiUtils__freeMemory(var->env, var->data.asRaw);
+        dpiGen__updateMemoryCounter(var,
+                DPI_MEMORY_COUNTER_VAR_BUFFER_BYTES,
+                -(int64_t) var->maxArraySize * var->sizeInBytes);
     }
+    var->data.asRaw = NULL;
+
+    // free the block from which all of the other arrays were carved
+    if (var->buffer) {
+#ifdef DPI_USE_HUGE_PAGES
+        if (var->isBufferMapped)
+            munmap(var->buffer, var->bufferSize);
+        else dpiUtils__freeMemory(var->env, var->buffer);
+#else
+        dpiUtils__freeMemory(var->env, var->buffer);
+#endif
+        dpiGen__updateMemoryCounter(var,
+                DPI_MEMORY_COUNTER_VAR_BUFFER_BYTES,
+                -(int64_t) var->bufferSize);
+        var->buffer = NULL;
+        var->bufferSize = 0;
+        var->isBufferMapped = 0;
+    }
+    var->indicator = NULL;
+    var->returnCode = NULL;
+    var->actualLength = NULL;
+    var->tempBuffer = NULL;
+    var->externalData = NULL;
 }
 
 
@@ -745,6 +840,7 @@ static void dpiVar__finalizeBuffers(dpiVar *var, dpiError *error)
 //-----------------------------------------------------------------------------
 void dpiVar__free(dpiVar *var, dpiError *error)
 {
+    dpiGen__updateMemoryStats(var, -1);
     dpiVar__finalizeBuffers(var, error);
     if (var->objectType) {
         dpiGen__setRefCount(var->objectType, error, -1);
@@ -754,7 +850,7 @@ void dpiVar__free(dpiVar *var, dpiError *error)
         dpiGen__setRefCount(var->conn, error, -1);
         var->conn = NULL;
     }
-    free(var);
+    dpiGen__free(var, error);
 }
 
 
@@ -986,8 +1082,8 @@ int32_t dpiVar__outBindCallback(dpiVar *var, OCIBind *bindp, uint32_t iter,
     if (var->actualLength) {
 #if DPI_ORACLE_CLIENT_VERSION_HEX < DPI_ORACLE_CLIENT_VERSION(12,1)
         if (!var->dynamicActualLength) {
-            var->dynamicActualLength = calloc(var->maxArraySize,
-                    sizeof(uint32_t));
+            var->dynamicActualLength = dpiUtils__allocateMemory(var->env,
+                    var->maxArraySize, sizeof(uint32_t), 1);
             if (!var->dynamicActualLength) {
                 dpiError__set(var->error, "allocate lengths for 11g",
                         DPI_ERR_NO_MEMORY);
@@ -1010,6 +1106,22 @@ int32_t dpiVar__outBindCallback(dpiVar *var, OCIBind *bindp, uint32_t iter,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiVar__reserveBufferSpace() [INTERNAL]
+//   Reserve space of the given size in the block of memory being laid out by
+// dpiVar__allocateBuffers() and return the offset of that space within the
+// block. The space is rounded up to preserve the alignment of the next array.
+//-----------------------------------------------------------------------------
+static size_t dpiVar__reserveBufferSpace(size_t *bufferSize, size_t size)
+{
+    size_t offset = *bufferSize;
+
+    *bufferSize += (size + DPI_BUFFER_ALIGNMENT - 1) &
+            ~((size_t) DPI_BUFFER_ALIGNMENT - 1);
+    return offset;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiVar__setBytesFromDynamicBytes() [PRIVATE]
 //   Set the pointer and length in the dpiBytes structure to the values
@@ -1034,7 +1146,8 @@ static int dpiVar__setBytesFromDynamicBytes(dpiVar *var, dpiBytes *bytes,
         totalAllocatedLength += dynBytes->chunks[i].allocatedLength;
 
     // allocate new memory consolidating all of the chunks
-    bytes->ptr = malloc(totalAllocatedLength);
+    bytes->ptr = dpiUtils__allocateMemory(var->env, 1, totalAllocatedLength,
+            0);
     if (!bytes->ptr)
         return dpiError__set(error, "allocate chunk", DPI_ERR_NO_MEMORY);
 
@@ -1044,7 +1157,7 @@ static int dpiVar__setBytesFromDynamicBytes(dpiVar *var, dpiBytes *bytes,
         memcpy(bytes->ptr + bytes->length, dynBytes->chunks[i].ptr,
                 dynBytes->chunks[i].length);
         bytes->length += dynBytes->chunks[i].length;
-        free(dynBytes->chunks[i].ptr);
+        dpiUtils__freeMemory(var->env, dynBytes->chunks[i].ptr);
         dynBytes->chunks[i].ptr = NULL;
         dynBytes->chunks[i].length = 0;
         dynBytes->chunks[i].allocatedLength = 0;
@@ -1085,8 +1198,8 @@ static int dpiVar__setBytesFromLob(dpiVar *var, dpiBytes *bytes,
     // ensure there is enough space to store the entire LOB value
     if (lengthInBytes > UB4MAXVAL)
         return dpiError__set(error, "check max length", DPI_ERR_NOT_SUPPORTED);
-    if (dpiVar__allocateDynamicBytes(dynBytes, (uint32_t) lengthInBytes,
-            error) < 0)
+    if (dpiVar__allocateDynamicBytes(var, dynBytes,
+            (uint32_t) lengthInBytes, error) < 0)
         return DPI_FAILURE;
 
     // read data from the LOB
@@ -1102,6 +1215,150 @@ static int dpiVar__setBytesFromLob(dpiVar *var, dpiBytes *bytes,
 }
 
 
+//-----------------------------------------------------------------------------
+// dpiVar__setBytesFromLobs() [INTERNAL]
+//   Populate the values of a LOB variable fetched as bytes for the given
+// number of rows. The lengths of the LOBs are prefetched along with the
+// locators (see dpiStmt__define()) so determining them does not require a
+// round trip; the contents of all of the LOBs are then read in a single round
+// trip instead of one for each row.
+//-----------------------------------------------------------------------------
+int dpiVar__setBytesFromLobs(dpiVar *var, uint32_t numRows, dpiError *error)
+{
+    uint64_t length, lengthInBytes, *amounts, *valueLengths;
+    dpiDynamicBytes *dynBytes;
+    uint32_t i, numLobs = 0;
+    dpiLob **lobs;
+    char **values;
+    dpiData *data;
+    sword status;
+    dpiLob *lob;
+    int result;
+
+    // allocate the arrays used for reading from all of the LOBs at once
+    amounts = dpiUtils__allocateMemory(var->env, numRows,
+            2 * sizeof(uint64_t) + sizeof(dpiLob*) + sizeof(char*), 0);
+    if (!amounts)
+        return dpiError__set(error, "allocate arrays", DPI_ERR_NO_MEMORY);
+    valueLengths = amounts + numRows;
+    lobs = (dpiLob**) (valueLengths + numRows);
+    values = (char**) (lobs + numRows);
+
+    // allocate space for the entire value of each LOB; the bytes structure
+    // temporarily holds the size of the space allocated
+    for (i = 0; i < numRows; i++) {
+        data = &var->externalData[i];
+        data->isNull = (var->indicator[i] == OCI_IND_NULL);
+        if (data->isNull)
+            continue;
+        lob = var->references[i].asLOB;
+        dynBytes = &var->dynamicBytes[i];
+        status = OCILobGetLength2(lob->conn->handle, error->handle,
+                lob->locator, (ub8*) &length);
+        if (dpiError__check(error, status, lob->conn,
+                "get LOB length") < 0) {
+            dpiUtils__freeMemory(var->env, amounts);
+            return DPI_FAILURE;
+        }
+        if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_CLOB)
+            lengthInBytes = length * lob->env->maxBytesPerCharacter;
+        else if (lob->type->oracleTypeNum == DPI_ORACLE_TYPE_NCLOB)
+            lengthInBytes = length * lob->env->nmaxBytesPerCharacter;
+        else lengthInBytes = length;
+        if (lengthInBytes > UB4MAXVAL) {
+            dpiUtils__freeMemory(var->env, amounts);
+            return dpiError__set(error, "check max length",
+                    DPI_ERR_NOT_SUPPORTED);
+        }
+        if (dpiVar__allocateDynamicBytes(var, dynBytes,
+                (uint32_t) lengthInBytes, error) < 0) {
+            dpiUtils__freeMemory(var->env, amounts);
+            return DPI_FAILURE;
+        }
+        dynBytes->chunks->length = 0;
+        data->value.asBytes.ptr = dynBytes->chunks->ptr;
+        data->value.asBytes.length = (uint32_t) lengthInBytes;
+        if (length > 0) {
+            lobs[numLobs] = lob;
+            amounts[numLobs] = length;
+            values[numLobs] = dynBytes->chunks->ptr;
+            valueLengths[numLobs++] = lengthInBytes;
+        }
+    }
+
+    // read from all of the LOBs that are not empty
+    result = DPI_SUCCESS;
+    if (numLobs > 0)
+        result = dpiLob__readMany(lobs, numLobs, 1, amounts, values,
+                valueLengths, error);
+
+    // populate the bytes structures with the lengths actually read
+    if (result == DPI_SUCCESS) {
+        numLobs = 0;
+        for (i = 0; i < numRows; i++) {
+            data = &var->externalData[i];
+            if (data->isNull || data->value.asBytes.length == 0)
+                continue;
+            dynBytes = &var->dynamicBytes[i];
+            dynBytes->chunks->length = (uint32_t) valueLengths[numLobs++];
+            data->value.asBytes.length = dynBytes->chunks->length;
+        }
+    }
+
+    dpiUtils__freeMemory(var->env, amounts);
+    return result;
+}
+
+
+//-----------------------------------------------------------------------------
+// dpiVar__setConnection() [INTERNAL]
+//   Associate a variable retained by a statement cache with another
+// connection (or with none), moving the memory used by the variable to the
+// memory counters of that connection. This is done when the statement cache
+// of a session of a pool managed by ODPI-C is handed from one connection to
+// the next. No reference to the connection is acquired or released here.
+//-----------------------------------------------------------------------------
+void dpiVar__setConnection(dpiVar *var, dpiConn *conn)
+{
+    int64_t bufferBytes, dynamicBytes = 0, *memoryCounters;
+    dpiDynamicBytes *dynBytes;
+    uint32_t i, j;
+
+    // determine the memory used by the buffers of the variable
+    bufferBytes = (int64_t) var->bufferSize;
+    if (var->data.asRaw && var->data.asRaw != var->buffer)
+        bufferBytes += (int64_t) var->maxArraySize * var->sizeInBytes;
+    if (var->dynamicBytes) {
+        for (i = 0; i < var->maxArraySize; i++) {
+            dynBytes = &var->dynamicBytes[i];
+            for (j = 0; j < dynBytes->allocatedChunks; j++) {
+                if (dynBytes->chunks[j].ptr)
+                    dynamicBytes += dynBytes->chunks[j].allocatedLength;
+            }
+        }
+    }
+
+    // move the memory from the previous owner to the new one
+    memoryCounters = (conn) ? conn->memoryCounters : NULL;
+    if (var->ownerMemoryCounters) {
+        DPI_ATOMIC_ADD_64(
+                &var->ownerMemoryCounters[DPI_MEMORY_COUNTER_VAR_BUFFER_BYTES],
+                -bufferBytes);
+        DPI_ATOMIC_ADD_64(
+                &var->ownerMemoryCounters[DPI_MEMORY_COUNTER_DYNAMIC_BYTES],
+                -dynamicBytes);
+    }
+    dpiGen__setMemoryOwner(var, memoryCounters);
+    if (memoryCounters) {
+        DPI_ATOMIC_ADD_64(&memoryCounters[DPI_MEMORY_COUNTER_VAR_BUFFER_BYTES],
+                bufferBytes);
+        DPI_ATOMIC_ADD_64(&memoryCounters[DPI_MEMORY_COUNTER_DYNAMIC_BYTES],
+                dynamicBytes);
+    }
+    var->conn = conn;
+}
+
+
 //-----------------------------------------------------------------------------
 // dpiVar__setFromBytes() [PRIVATE]
 //   Set the value of the variable at the given array position from a byte
@@ -1138,7 +1395,8 @@ static int dpiVar__setFromBytes(dpiVar *var, uint32_t pos, const char *value,
     bytes = &data->value.asBytes;
     if (var->dynamicBytes) {
         dynBytes = &var->dynamicBytes[pos];
-        if (dpiVar__allocateDynamicBytes(dynBytes, valueLength, error) < 0)
+        if (dpiVar__allocateDynamicBytes(var, dynBytes, valueLength,
+                error) < 0)
             return DPI_FAILURE;
         memcpy(dynBytes->chunks->ptr, value, valueLength);
         dynBytes->numChunks = 1;
@@ -1563,7 +1821,12 @@ int dpiVar_resize(dpiVar *var, uint32_t sizeInBytes)
         return dpiError__set(&error, "resize", DPI_ERR_NOT_SUPPORTED);
     if (var->dynamicBytes)
         return DPI_SUCCESS;
-    free(var->data.asRaw);
+    if (var->data.asRaw != var->buffer) {
+        dpiUtils__freeMemory(var->env, var->data.asRaw);
+        dpiGen__updateMemoryCounter(var,
+                DPI_MEMORY_COUNTER_VAR_BUFFER_BYTES,
+                -(int64_t) var->maxArraySize * var->sizeInBytes);
+    }
     var->data.asRaw = NULL;
     var->sizeInBytes = sizeInBytes;
     return dpiVar__allocateBuffers(var, &error);